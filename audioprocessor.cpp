@@ -107,3 +107,21 @@ double AudioProcessor::processAudio2(double input1, double input2, jack_nframes_
     processAudio(inputs.data(), outputs.data(), time);
     return outputs[0];
 }
+
+void AudioProcessor::processAudio(const jack_default_audio_sample_t * const *inputBuffers, jack_default_audio_sample_t * const *outputBuffers, jack_nframes_t start, jack_nframes_t end)
+{
+    for (jack_nframes_t currentFrame = start; currentFrame < end; currentFrame++) {
+        for (int i = 0; i < inputs.size(); i++) {
+            inputs[i] = inputBuffers[i][currentFrame];
+        }
+        processAudio(inputs.data(), outputs.data(), currentFrame);
+        for (int i = 0; i < outputs.size(); i++) {
+            outputBuffers[i][currentFrame] = outputs[i];
+        }
+    }
+}
+
+jack_nframes_t AudioProcessor::getSilenceTail() const
+{
+    return JACK_MAX_FRAMES;
+}
@@ -47,6 +47,42 @@ public:
     double processAudio2(double input1, double input2, jack_nframes_t time);
 
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time) = 0;
+    /**
+      Processes a block of audio frames given as planar channel buffers,
+      i.e. one buffer per audio input and output, such as the Jack port buffers.
+      Only the frames from start (inclusive) to end (exclusive) are processed.
+
+      This default implementation calls processAudio(const double*, double*, jack_nframes_t)
+      for every frame in the given range, using the frame index as time.
+      Reimplement this method to process whole blocks at once (which allows the
+      compiler to vectorize the inner loops). If you reimplement it, make sure it
+      behaves the same way as the per-frame version.
+
+      Note: subclasses reimplementing only the per-frame version of a class
+      which reimplements this method have to reimplement this method as well,
+      e.g. by calling AudioProcessor::processAudio(inputs, outputs, start, end).
+
+      @param inputs an array of input buffers, one for each audio input
+      @param outputs an array of output buffers, one for each audio output
+      @param start the index of the first frame in the buffers which should be processed
+      @param end the index after the last frame in the buffers which should be processed
+      */
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+
+    /**
+      Reimplement this to let the processing be skipped while the inputs and
+      outputs are silent (see JackClient::setSilenceTail()).
+
+      The default implementation returns JACK_MAX_FRAMES, which means the
+      processor always has to be called, e.g. because it generates sound
+      without any input.
+
+      @return the number of frames the outputs may still become non-silent
+        after all inputs became silent. The outputs are only considered idle
+        once they are silent as well, so a decaying output does not need to be
+        covered by the tail.
+      */
+    virtual jack_nframes_t getSilenceTail() const;
 
 private:
     double sampleRate, sampleDuration;
@@ -71,9 +71,17 @@ bool AudioProcessorClient::init()
     if (audioProcessor) {
         audioProcessor->setSampleRate(getSampleRate());
     }
+    if (ok) {
+        setSilenceTail(getSilenceTail());
+    }
     return ok;
 }
 
+jack_nframes_t AudioProcessorClient::getSilenceTail()
+{
+    return (audioProcessor ? audioProcessor->getSilenceTail() : JACK_MAX_FRAMES);
+}
+
 bool AudioProcessorClient::process(jack_nframes_t nframes)
 {
     getAudioPortBuffers(nframes);
@@ -83,7 +91,10 @@ bool AudioProcessorClient::process(jack_nframes_t nframes)
 
 void AudioProcessorClient::processAudio(jack_nframes_t start, jack_nframes_t end)
 {
-    if (inputs.size() || outputs.size()) {
+    if (audioProcessor) {
+        // let the AudioProcessor process the whole range at once:
+        audioProcessor->processAudio(audioInputBuffers.data(), audioOutputBuffers.data(), start, end);
+    } else if (inputs.size() || outputs.size()) {
         for (jack_nframes_t currentFrame = start; currentFrame < end; currentFrame++) {
             for (int i = 0; i < inputs.size(); i++) {
                 inputs[i] = audioInputBuffers[i][currentFrame];
@@ -121,6 +132,6 @@ jack_default_audio_sample_t * AudioProcessorClient::getInputBuffer(int index)
 
 jack_default_audio_sample_t * AudioProcessorClient::getOutputBuffer(int index)
 {
-    Q_ASSERT((index >= 0) && (index < audioInputBuffers.size()));
+    Q_ASSERT((index >= 0) && (index < audioOutputBuffers.size()));
     return audioOutputBuffers[index];
 }
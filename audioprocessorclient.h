@@ -90,11 +90,19 @@ protected:
       in the constructor.
 
       It also sets the sample rate of the contained AudioProcessor (if there is any)
-      to the Jack sample rate.
+      to the Jack sample rate, and then lets the client be skipped while it is idle
+      according to getSilenceTail().
 
       @return true, if all ports could be created, false otherwise
       */
     virtual bool init();
+    /**
+      This is called by init() after the sample rate has been set. This implementation
+      returns the tail of the contained AudioProcessor (see AudioProcessor::getSilenceTail()),
+      or JACK_MAX_FRAMES if there is none, such that the client is always processed.
+      Subclasses doing their own processing may reimplement this.
+      */
+    virtual jack_nframes_t getSilenceTail();
     /**
       This is called regularly when the client is running. It runs in a separate
       thread, the Jack process thread. This implementation gets the audio
@@ -114,11 +122,14 @@ protected:
     virtual bool process(jack_nframes_t nframes);
     /**
       Processes a given range of audio frames.
-      This implementation just calls processAudio(const double*, double*) for
+      If there is an AudioProcessor instance, this implementation hands the
+      whole range to its block processing method
+      AudioProcessor::processAudio(const jack_default_audio_sample_t * const *, jack_default_audio_sample_t * const *, jack_nframes_t, jack_nframes_t).
+      Otherwise it calls processAudio(const double*, double*, jack_nframes_t) for
       every audio frame in the given range.
 
-      Reimplementing this method is currently not advised, because the necessary
-      input and output ports are not accessible in subclasses yet.
+      If you reimplement this method, use getInputBuffer() and getOutputBuffer()
+      to access the audio buffers.
 
       @param start the index of the first frame in the audio buffer which should be processed
       @param end the index after the last frame in the audio buffer which should be processed
@@ -0,0 +1,441 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+  Drives each of the DSP processors outside of Jack with synthetic input
+  signals (deterministic noise, a slow sine or silence) at several sample rates and
+  buffer sizes, through the same block processing method the audio clients
+  use.
+
+  Prints the time per sample in nanoseconds and in processor cycles (where
+  the time stamp counter is available) and the worst time a single period
+  took, compared to the time the period lasts in real time. The results can
+  also be written to a CSV file with --output, so runs can be compared.
+
+  Every run processes the same input, so the printed output checksums
+  only change when the processing itself changes.
+  */
+
+#include "oscillator.h"
+#include "polynomialoscillator.h"
+#include "wavetableoscillator.h"
+#include "iirmoogfilter.h"
+#include "iirmoogfilterbank.h"
+#include "iirbutterworthfilter.h"
+#include "chamberlinfilter.h"
+#include "zplanefilter.h"
+#include "envelope.h"
+#include "linearwaveshapingclient.h"
+#include "logarithmicwaveshaper.h"
+#include "cubicsplinewaveshapingclient.h"
+#include "sincfilter.h"
+#include "zitareverbclient.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QFile>
+#include <QTextStream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+static AudioProcessor * createOscillator(double sampleRate)
+{
+    Oscillator *oscillator = new Oscillator();
+    oscillator->setSampleRate(sampleRate);
+    // the oscillators' MIDI input 0 receives parameter changes, the notes go to input 1:
+    oscillator->processNoteOn(1, 0, 57, 100, 0);
+    return oscillator;
+}
+
+static AudioProcessor * createPolynomialOscillator(double sampleRate, int nrOfIntegrations)
+{
+    PolynomialOscillator *oscillator = new PolynomialOscillator(nrOfIntegrations);
+    oscillator->setSampleRate(sampleRate);
+    oscillator->processNoteOn(1, 0, 57, 100, 0);
+    return oscillator;
+}
+
+static AudioProcessor * createPolynomialOscillator1(double sampleRate)
+{
+    return createPolynomialOscillator(sampleRate, 1);
+}
+
+static AudioProcessor * createPolynomialOscillator2(double sampleRate)
+{
+    return createPolynomialOscillator(sampleRate, 2);
+}
+
+static AudioProcessor * createPolynomialOscillator3(double sampleRate)
+{
+    return createPolynomialOscillator(sampleRate, 3);
+}
+
+static AudioProcessor * createPolynomialOscillator4(double sampleRate)
+{
+    return createPolynomialOscillator(sampleRate, 4);
+}
+
+static AudioProcessor * createWavetableOscillator(double sampleRate)
+{
+    WavetableOscillator *oscillator = new WavetableOscillator();
+    oscillator->setSampleRate(sampleRate);
+    oscillator->processNoteOn(1, 0, 57, 100, 0);
+    return oscillator;
+}
+
+static AudioProcessor * createIirMoogFilter(double sampleRate, int controlRate)
+{
+    IirMoogFilter *filter = new IirMoogFilter(1);
+    filter->setSampleRate(sampleRate);
+    filter->setControlRate(controlRate);
+    // a resonant setting, with the cutoff frequency modulated by up to an octave:
+    filter->setParameterValue(1, 2000, 0, 0.5 * sampleRate, 0);
+    filter->setParameterValue(2, 0.6, 0, 1, 0);
+    return filter;
+}
+
+static AudioProcessor * createIirMoogFilterPerFrame(double sampleRate)
+{
+    return createIirMoogFilter(sampleRate, 1);
+}
+
+static AudioProcessor * createIirMoogFilter16(double sampleRate)
+{
+    return createIirMoogFilter(sampleRate, 16);
+}
+
+static AudioProcessor * createIirMoogFilter32(double sampleRate)
+{
+    return createIirMoogFilter(sampleRate, 32);
+}
+
+static AudioProcessor * createIirMoogFilterBank(double sampleRate)
+{
+    IirMoogFilterBank *filter = new IirMoogFilterBank(8);
+    filter->setSampleRate(sampleRate);
+    // the same resonance as the single filter, with the voices' cutoff frequencies spread over three octaves:
+    filter->setParameterValue(1, 0.6, 0, 1, 0);
+    for (int voice = 0; voice < filter->getNrOfVoices(); voice++) {
+        filter->setParameterValue(2 + voice, 500 * pow(2.0, voice * 3.0 / filter->getNrOfVoices()), 0, 0.5 * sampleRate, 0);
+    }
+    return filter;
+}
+
+static AudioProcessor * createIirButterworthFilter(double sampleRate)
+{
+    IirButterworthFilter *filter = new IirButterworthFilter();
+    filter->setSampleRate(sampleRate);
+    return filter;
+}
+
+static AudioProcessor * createChamberlinFilter(double sampleRate)
+{
+    ChamberlinFilter *filter = new ChamberlinFilter();
+    filter->setSampleRate(sampleRate);
+    return filter;
+}
+
+static AudioProcessor * createZPlaneFilter(double sampleRate)
+{
+    ZPlaneFilter *filter = new ZPlaneFilter();
+    filter->setSampleRate(sampleRate);
+    // two resonant pole pairs and a pair of zeros at the Nyquist frequency:
+    filter->addPole(std::polar(0.95, 0.1));
+    filter->addPole(std::polar(0.95, -0.1));
+    filter->addPole(std::polar(0.9, 0.4));
+    filter->addPole(std::polar(0.9, -0.4));
+    filter->addZero(std::complex<double>(-1, 0));
+    filter->addZero(std::complex<double>(-1, 0));
+    filter->computeCoefficients();
+    return filter;
+}
+
+static AudioProcessor * createEnvelope(double sampleRate)
+{
+    Envelope *envelope = new Envelope();
+    envelope->setSampleRate(sampleRate);
+    envelope->processNoteOn(0, 0, 57, 100, 0);
+    return envelope;
+}
+
+static AudioProcessor * createLinearWaveShaper(double sampleRate)
+{
+    LinearWaveShaper *waveShaper = new LinearWaveShaper();
+    waveShaper->setSampleRate(sampleRate);
+    return waveShaper;
+}
+
+static AudioProcessor * createLogarithmicWaveShaper(double sampleRate)
+{
+    LogarithmicWaveShaper *waveShaper = new LogarithmicWaveShaper();
+    waveShaper->setSampleRate(sampleRate);
+    return waveShaper;
+}
+
+static AudioProcessor * createCubicSplineWaveShaper(double sampleRate)
+{
+    QVector<double> xx, yy;
+    xx.append(-1);
+    yy.append(-1);
+    xx.append(1);
+    yy.append(1);
+    CubicSplineWaveShaper *waveShaper = new CubicSplineWaveShaper(xx, yy);
+    waveShaper->setSampleRate(sampleRate);
+    return waveShaper;
+}
+
+static AudioProcessor * createSincFilter(double sampleRate)
+{
+    SincFilter *filter = new SincFilter(16, 10000);
+    filter->setSampleRate(sampleRate);
+    return filter;
+}
+
+static AudioProcessor * createZitaReverb(double sampleRate)
+{
+    ZitaReverbProcessor *reverb = new ZitaReverbProcessor();
+    reverb->setSampleRate(sampleRate);
+    return reverb;
+}
+
+enum InputSignal {
+    NOISE,
+    SINE,
+    SILENCE
+};
+
+struct Benchmark {
+    const char *name;
+    AudioProcessor * (*create)(double sampleRate);
+    // the signal for the first audio input and for all other inputs (e.g. modulation inputs, which should change slowly):
+    InputSignal input, otherInputs;
+};
+
+static const Benchmark benchmarks[] = {
+    { "Oscillator", createOscillator, SINE, SINE },
+    // with modulated pitch, and with constant pitch for 1 to 4 integrations:
+    { "PolynomialOscillator", createPolynomialOscillator3, SINE, SINE },
+    { "PolynomialOscillator/1", createPolynomialOscillator1, SILENCE, SILENCE },
+    { "PolynomialOscillator/2", createPolynomialOscillator2, SILENCE, SILENCE },
+    { "PolynomialOscillator/3", createPolynomialOscillator3, SILENCE, SILENCE },
+    { "PolynomialOscillator/4", createPolynomialOscillator4, SILENCE, SILENCE },
+    { "WavetableOscillator", createWavetableOscillator, SINE, SINE },
+    // the Moog filter with exact coefficients for every frame and with coefficients updated at control rate:
+    { "IirMoogFilter/1", createIirMoogFilterPerFrame, NOISE, SINE },
+    { "IirMoogFilter/16", createIirMoogFilter16, NOISE, SINE },
+    { "IirMoogFilter/32", createIirMoogFilter32, NOISE, SINE },
+    // eight voices per frame, compare with eight times the time of IirMoogFilter:
+    { "IirMoogFilterBank/8", createIirMoogFilterBank, NOISE, NOISE },
+    { "IirButterworthFilter", createIirButterworthFilter, NOISE, SINE },
+    { "ChamberlinFilter", createChamberlinFilter, NOISE, SINE },
+    { "ZPlaneFilter", createZPlaneFilter, NOISE, SINE },
+    { "Envelope", createEnvelope, SINE, SINE },
+    { "LinearWaveShaper", createLinearWaveShaper, NOISE, SINE },
+    { "LogarithmicWaveShaper", createLogarithmicWaveShaper, NOISE, SINE },
+    { "CubicSplineWaveShaper", createCubicSplineWaveShaper, NOISE, SINE },
+    { "SincFilter", createSincFilter, NOISE, SINE },
+    { "ZitaReverb", createZitaReverb, NOISE, NOISE }
+};
+
+/**
+  Generates the input signals. Noise comes from a linear congruential
+  generator with a fixed seed instead of rand(), so that every run (and
+  every platform) sees exactly the same samples.
+  */
+class SignalGenerator
+{
+public:
+    SignalGenerator(InputSignal signal_, double sampleRate) :
+        signal(signal_),
+        state(12345),
+        phase(0),
+        phaseIncrement(2 * M_PI * 0.5 / sampleRate)
+    {
+    }
+    void generate(jack_default_audio_sample_t *buffer, jack_nframes_t nframes)
+    {
+        if (signal == NOISE) {
+            for (jack_nframes_t i = 0; i < nframes; i++) {
+                state = state * 1664525u + 1013904223u;
+                buffer[i] = (jack_default_audio_sample_t)((double)state / 4294967296.0 * 2.0 - 1.0);
+            }
+        } else if (signal == SILENCE) {
+            for (jack_nframes_t i = 0; i < nframes; i++) {
+                buffer[i] = 0;
+            }
+        } else {
+            for (jack_nframes_t i = 0; i < nframes; i++) {
+                buffer[i] = (jack_default_audio_sample_t)sin(phase);
+                phase += phaseIncrement;
+            }
+            phase = fmod(phase, 2 * M_PI);
+        }
+    }
+private:
+    InputSignal signal;
+    quint32 state;
+    double phase, phaseIncrement;
+};
+
+static quint64 readCycleCounter()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static bool hasCycleCounter()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return true;
+#else
+    return false;
+#endif
+}
+
+struct Result {
+    jack_nframes_t frames;
+    double nanosecondsPerSample, cyclesPerSample, worstPeriodMicroseconds, periodBudgetMicroseconds, checksum;
+};
+
+static Result run(const Benchmark &benchmark, double sampleRate, jack_nframes_t bufferSize, jack_nframes_t frames)
+{
+    AudioProcessor *processor = benchmark.create(sampleRate);
+    int inputCount = processor->getNrOfAudioInputs();
+    int outputCount = processor->getNrOfAudioOutputs();
+    QVector<QVector<jack_default_audio_sample_t> > inputMemory(inputCount), outputMemory(outputCount);
+    QVector<const jack_default_audio_sample_t*> inputs(inputCount);
+    QVector<jack_default_audio_sample_t*> outputs(outputCount);
+    for (int i = 0; i < inputCount; i++) {
+        inputMemory[i].resize(bufferSize);
+        inputs[i] = inputMemory[i].data();
+    }
+    for (int i = 0; i < outputCount; i++) {
+        outputMemory[i].resize(bufferSize);
+        outputs[i] = outputMemory[i].data();
+    }
+    QVector<SignalGenerator> generators(inputCount, SignalGenerator(benchmark.otherInputs, sampleRate));
+    if (inputCount) {
+        generators[0] = SignalGenerator(benchmark.input, sampleRate);
+    }
+    jack_nframes_t periods = std::max(frames / bufferSize, (jack_nframes_t)1);
+    // warm up caches and branch predictors with a tenth of the periods, which are not timed:
+    jack_nframes_t warmUpPeriods = std::max(periods / 10, (jack_nframes_t)1);
+    qint64 nanoseconds = 0, worstNanoseconds = 0;
+    quint64 cycles = 0;
+    double checksum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (jack_nframes_t period = 0; period < warmUpPeriods + periods; period++) {
+        for (int i = 0; i < inputCount; i++) {
+            generators[i].generate(inputMemory[i].data(), bufferSize);
+        }
+        qint64 startTime = timer.nsecsElapsed();
+        quint64 startCycles = readCycleCounter();
+        processor->processAudio(inputs.data(), outputs.data(), 0, bufferSize);
+        quint64 endCycles = readCycleCounter();
+        qint64 periodTime = timer.nsecsElapsed() - startTime;
+        if (period >= warmUpPeriods) {
+            nanoseconds += periodTime;
+            cycles += endCycles - startCycles;
+            worstNanoseconds = std::max(worstNanoseconds, periodTime);
+            for (int i = 0; i < outputCount; i++) {
+                for (jack_nframes_t j = 0; j < bufferSize; j++) {
+                    checksum += fabs(outputs[i][j]);
+                }
+            }
+        }
+    }
+    delete processor;
+    double samples = (double)periods * bufferSize;
+    Result result;
+    result.frames = periods * bufferSize;
+    result.nanosecondsPerSample = nanoseconds / samples;
+    result.cyclesPerSample = cycles / samples;
+    result.worstPeriodMicroseconds = worstNanoseconds * 0.001;
+    result.periodBudgetMicroseconds = bufferSize * 1e6 / sampleRate;
+    result.checksum = checksum;
+    return result;
+}
+
+static void printUsage()
+{
+    printf("Usage: dspbenchmark [--frames N] [--output FILE]\n");
+    printf("  --frames N     process about N frames per measurement (default: 262144)\n");
+    printf("  --output FILE  also write the results to FILE as comma-separated values\n");
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QStringList arguments = a.arguments();
+    jack_nframes_t frames = 262144;
+    QString outputFileName;
+    for (int i = 1; i < arguments.size(); i++) {
+        bool ok = true;
+        if ((arguments[i] == "--frames") && (i + 1 < arguments.size())) {
+            frames = arguments[++i].toUInt(&ok);
+            ok = ok && frames;
+        } else if ((arguments[i] == "--output") && (i + 1 < arguments.size())) {
+            outputFileName = arguments[++i];
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printUsage();
+            return 1;
+        }
+    }
+    QFile outputFile(outputFileName);
+    QTextStream output(&outputFile);
+    if (!outputFileName.isEmpty()) {
+        if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            fprintf(stderr, "Could not open %s for writing.\n", outputFileName.toLocal8Bit().constData());
+            return 1;
+        }
+        output << "processor,sample_rate,buffer_size,frames,ns_per_sample,cycles_per_sample,worst_period_us,period_budget_us,checksum\n";
+    }
+    const double sampleRates[] = { 44100, 48000, 96000, 192000 };
+    const jack_nframes_t bufferSizes[] = { 64, 256, 1024 };
+
+    printf("%-22s %8s %8s %12s %12s %12s %12s %16s\n", "processor", "rate", "frames", "ns/sample", "cycles/smp", "worst [us]", "budget [us]", "checksum");
+    for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+        for (size_t r = 0; r < sizeof(sampleRates) / sizeof(sampleRates[0]); r++) {
+            for (size_t s = 0; s < sizeof(bufferSizes) / sizeof(bufferSizes[0]); s++) {
+                Result result = run(benchmarks[b], sampleRates[r], bufferSizes[s], frames);
+                printf("%-22s %8.0f %8lu %12.3f", benchmarks[b].name, sampleRates[r], (unsigned long)bufferSizes[s], result.nanosecondsPerSample);
+                if (hasCycleCounter()) {
+                    printf(" %12.2f", result.cyclesPerSample);
+                } else {
+                    printf(" %12s", "n/a");
+                }
+                printf(" %12.2f %12.2f %16.6f\n", result.worstPeriodMicroseconds, result.periodBudgetMicroseconds, result.checksum);
+                if (!outputFileName.isEmpty()) {
+                    output << benchmarks[b].name << "," << sampleRates[r] << "," << bufferSizes[s] << "," << result.frames << ","
+                           << result.nanosecondsPerSample << "," << (hasCycleCounter() ? QString::number(result.cyclesPerSample) : QString()) << ","
+                           << result.worstPeriodMicroseconds << "," << result.periodBudgetMicroseconds << "," << QString::number(result.checksum, 'f', 6) << "\n";
+                }
+            }
+        }
+    }
+    return 0;
+}
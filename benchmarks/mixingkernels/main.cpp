@@ -0,0 +1,112 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+  Compares the mixing kernels used by MetaJackPortProcess::mergeConnectedBuffers()
+  with the plain loop they replaced (clearing the input buffer and adding each
+  connected output buffer sample by sample), for 1 to 16 connected outputs.
+
+  Prints the time per mixed frame in nanoseconds for each kernel implementation
+  supported by the processor.
+  */
+
+#include "mixingkernels.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstdio>
+#include <cstdlib>
+#include <memory.h>
+
+static void mixReference(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes)
+{
+    memset(dest, 0, nframes * sizeof(jack_default_audio_sample_t));
+    for (size_t i = 0; i < sourceCount; i++) {
+        const jack_default_audio_sample_t *source = sources[i];
+        for (size_t j = 0; j < nframes; j++) {
+            dest[j] += source[j];
+        }
+    }
+}
+
+static jack_default_audio_sample_t * allocateAlignedBuffer(QVector<char> &memory, size_t nframes)
+{
+    memory.resize(nframes * sizeof(jack_default_audio_sample_t) + MixingKernels::ALIGNMENT - 1);
+    char *data = memory.data();
+    return (jack_default_audio_sample_t*)(data + (MixingKernels::ALIGNMENT - (size_t)data % MixingKernels::ALIGNMENT) % MixingKernels::ALIGNMENT);
+}
+
+int main(int, char **)
+{
+    const size_t bufferSizes[] = { 64, 256, 1024 };
+    const size_t maxSources = MixingKernels::MAX_SUM_SOURCES;
+    // mix about this many frames per measurement:
+    const size_t framesPerMeasurement = 1 << 24;
+    const MixingKernels::Implementation implementations[] = { MixingKernels::SCALAR, MixingKernels::SSE2, MixingKernels::AVX };
+    const size_t implementationCount = sizeof(implementations) / sizeof(implementations[0]);
+
+    double checksum = 0;
+    printf("# ns per mixed frame\n");
+    printf("%8s %8s %12s", "frames", "sources", "reference");
+    for (size_t k = 0; k < implementationCount; k++) {
+        if (MixingKernels::isSupported(implementations[k])) {
+            printf(" %12s", MixingKernels::getImplementationName(implementations[k]));
+        }
+    }
+    printf("\n");
+    for (size_t b = 0; b < sizeof(bufferSizes) / sizeof(bufferSizes[0]); b++) {
+        size_t nframes = bufferSizes[b];
+        size_t iterations = framesPerMeasurement / nframes;
+        // allocate aligned buffers filled with noise:
+        QVector<QVector<char> > memory(maxSources + 1);
+        const jack_default_audio_sample_t *sources[maxSources];
+        for (size_t i = 0; i < maxSources; i++) {
+            jack_default_audio_sample_t *source = allocateAlignedBuffer(memory[i], nframes);
+            for (size_t j = 0; j < nframes; j++) {
+                source[j] = (jack_default_audio_sample_t)rand() / RAND_MAX - 0.5f;
+            }
+            sources[i] = source;
+        }
+        jack_default_audio_sample_t *dest = allocateAlignedBuffer(memory[maxSources], nframes);
+        for (size_t sourceCount = 1; sourceCount <= maxSources; sourceCount++) {
+            QElapsedTimer timer;
+            timer.start();
+            for (size_t i = 0; i < iterations; i++) {
+                mixReference(dest, sources, sourceCount, nframes);
+            }
+            qint64 nanoseconds = timer.nsecsElapsed();
+            checksum += dest[0];
+            printf("%8lu %8lu %12.3f", (unsigned long)nframes, (unsigned long)sourceCount, (double)nanoseconds / (iterations * nframes));
+            for (size_t k = 0; k < implementationCount; k++) {
+                if (MixingKernels::setImplementation(implementations[k])) {
+                    timer.start();
+                    for (size_t i = 0; i < iterations; i++) {
+                        MixingKernels::sum(dest, sources, sourceCount, nframes);
+                    }
+                    nanoseconds = timer.nsecsElapsed();
+                    checksum += dest[0];
+                    printf(" %12.3f", (double)nanoseconds / (iterations * nframes));
+                }
+            }
+            printf("\n");
+        }
+    }
+    // print the checksum to keep the compiler from optimizing the mixing away:
+    printf("# checksum: %f\n", checksum);
+    return 0;
+}
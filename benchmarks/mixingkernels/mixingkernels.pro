@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Micro-benchmark of the MetaJack mixing kernels
+#
+#-------------------------------------------------
+
+QT      += core
+QT      -= gui
+
+TARGET = mixingkernelsbenchmark
+CONFIG  += console
+CONFIG  -= app_bundle
+TEMPLATE = app
+
+INCLUDEPATH += ../../metajack
+
+SOURCES += main.cpp \
+    ../../metajack/mixingkernels.cpp
+
+HEADERS += ../../metajack/mixingkernels.h
+
+win32:INCLUDEPATH += "$$(JACK_PATH)\\includes"
@@ -0,0 +1,349 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "biquadcascade.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+BiquadCascade::BiquadCascade() :
+    sectionCount(0)
+{
+    reset();
+}
+
+bool BiquadCascade::setTransferFunction(const Polynomial<std::complex<double> > &numerator, const Polynomial<std::complex<double> > &denominator)
+{
+    Factor zeros[MAX_SECTIONS], poles[MAX_SECTIONS];
+    double numeratorGain, denominatorGain;
+    int zeroCount = factorize(numerator, zeros, numeratorGain);
+    int poleCount = factorize(denominator, poles, denominatorGain);
+    bool realizable = (zeroCount >= 0) && (poleCount >= 0) && (denominatorGain != 0.0);
+    for (int i = 0; realizable && (i < poleCount); i++) {
+        // the denominator must not have a root at zero:
+        realizable = (poles[i].c0 != 0.0);
+    }
+    if (!realizable) {
+        sectionCount = 0;
+        return false;
+    }
+    // a constant transfer function still needs one section for its gain:
+    int count = std::max(std::max(zeroCount, poleCount), 1);
+    setSectionCount(count);
+    // sort the poles by their distance to the unit circle, farthest first,
+    // such that the sections with the highest resonance come last:
+    for (int i = 1; i < poleCount; i++) {
+        for (int j = i; (j > 0) && (std::abs(poles[j].root) < std::abs(poles[j - 1].root)); j--) {
+            std::swap(poles[j], poles[j - 1]);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        Section &section = sections[i];
+        if (i < poleCount) {
+            section.a1 = poles[i].c1 / poles[i].c0;
+            section.a2 = poles[i].c2 / poles[i].c0;
+        } else {
+            section.a1 = section.a2 = 0.0;
+        }
+        section.b0 = 1.0;
+        section.b1 = section.b2 = 0.0;
+    }
+    // assign each pole the closest remaining zero, beginning with the poles
+    // closest to the unit circle:
+    bool used[MAX_SECTIONS] = {false};
+    for (int i = poleCount - 1; i >= 0; i--) {
+        int closest = -1;
+        for (int j = 0; j < zeroCount; j++) {
+            if (!used[j] && ((closest == -1) || (std::abs(zeros[j].root - poles[i].root) < std::abs(zeros[closest].root - poles[i].root)))) {
+                closest = j;
+            }
+        }
+        if (closest != -1) {
+            used[closest] = true;
+            sections[i].b0 = zeros[closest].c0;
+            sections[i].b1 = zeros[closest].c1;
+            sections[i].b2 = zeros[closest].c2;
+        }
+    }
+    // the remaining zeros get sections without poles:
+    for (int i = poleCount, j = 0; j < zeroCount; j++) {
+        if (!used[j]) {
+            sections[i].b0 = zeros[j].c0;
+            sections[i].b1 = zeros[j].c1;
+            sections[i].b2 = zeros[j].c2;
+            i++;
+        }
+    }
+    // the first section applies the overall gain:
+    double gain = numeratorGain / denominatorGain;
+    sections[0].b0 *= gain;
+    sections[0].b1 *= gain;
+    sections[0].b2 *= gain;
+    return true;
+}
+
+bool BiquadCascade::setCoefficients(const double *b, int bCount, const double *a, int aCount)
+{
+    if ((bCount > 3) || (aCount > 4)) {
+        sectionCount = 0;
+        return false;
+    }
+    double a1[2] = {(aCount > 0 ? a[0] : 0.0), 0.0}, a2[2] = {(aCount > 1 ? a[1] : 0.0), 0.0};
+    if (aCount > 2) {
+        // split the denominator into two second order factors:
+        double coefficients[4] = {a[0], a[1], a[2], (aCount > 3 ? a[3] : 0.0)};
+        factorizeQuartic(coefficients, a1, a2);
+        // like in setTransferFunction(), the section whose poles are closest to the unit circle comes last:
+        if (std::abs(a2[0]) > std::abs(a2[1])) {
+            std::swap(a1[0], a1[1]);
+            std::swap(a2[0], a2[1]);
+        }
+        setSectionCount(2);
+    } else {
+        setSectionCount(1);
+    }
+    for (int i = 0; i < sectionCount; i++) {
+        Section &section = sections[i];
+        section.b0 = (i ? 1.0 : bCount > 0 ? b[0] : 0.0);
+        section.b1 = (i ? 0.0 : bCount > 1 ? b[1] : 0.0);
+        section.b2 = (i ? 0.0 : bCount > 2 ? b[2] : 0.0);
+        section.a1 = a1[i];
+        section.a2 = a2[i];
+    }
+    return true;
+}
+
+bool BiquadCascade::setCascade(const BiquadCascade &first, const BiquadCascade &second)
+{
+    if (first.sectionCount + second.sectionCount > MAX_SECTIONS) {
+        sectionCount = 0;
+        return false;
+    }
+    setSectionCount(first.sectionCount + second.sectionCount);
+    for (int i = 0; i < sectionCount; i++) {
+        const Section &source = (i < first.sectionCount ? first.sections[i] : second.sections[i - first.sectionCount]);
+        // copy the coefficients only, the state is our own:
+        Section &section = sections[i];
+        section.b0 = source.b0;
+        section.b1 = source.b1;
+        section.b2 = source.b2;
+        section.a1 = source.a1;
+        section.a2 = source.a2;
+    }
+    return true;
+}
+
+void BiquadCascade::invert()
+{
+    for (int i = 0; i < sectionCount; i++) {
+        sections[i].b1 = -sections[i].b1;
+        sections[i].a1 = -sections[i].a1;
+    }
+}
+
+int BiquadCascade::getSectionCount() const
+{
+    return sectionCount;
+}
+
+const BiquadCascade::Section & BiquadCascade::getSection(int index) const
+{
+    return sections[index];
+}
+
+void BiquadCascade::reset()
+{
+    for (int i = 0; i < MAX_SECTIONS; i++) {
+        sections[i].s1 = sections[i].s2 = 0.0;
+    }
+}
+
+void BiquadCascade::setSectionCount(int count)
+{
+    // the state of other sections would not fit the new ones:
+    if (count != sectionCount) {
+        sectionCount = count;
+        reset();
+    }
+}
+
+void BiquadCascade::process(const jack_default_audio_sample_t *input, jack_default_audio_sample_t *output, jack_nframes_t start, jack_nframes_t end)
+{
+    double buffer[CHUNK_SIZE];
+    for (jack_nframes_t chunkStart = start; chunkStart < end; chunkStart += CHUNK_SIZE) {
+        int frames = std::min<jack_nframes_t>(end - chunkStart, CHUNK_SIZE);
+        for (int i = 0; i < frames; i++) {
+            buffer[i] = input[chunkStart + i];
+        }
+        // run the whole chunk through one section after the other, with the
+        // section's coefficients and state held in local variables:
+        for (int j = 0; j < sectionCount; j++) {
+            Section &section = sections[j];
+            double b0 = section.b0, b1 = section.b1, b2 = section.b2, a1 = section.a1, a2 = section.a2;
+            double s1 = section.s1, s2 = section.s2;
+            for (int i = 0; i < frames; i++) {
+                double in = buffer[i];
+                double out = b0 * in + s1;
+                s1 = b1 * in - a1 * out + s2;
+                s2 = b2 * in - a2 * out;
+                buffer[i] = out;
+            }
+            section.s1 = s1;
+            section.s2 = s2;
+        }
+        for (int i = 0; i < frames; i++) {
+            output[chunkStart + i] = buffer[i];
+        }
+    }
+}
+
+int BiquadCascade::factorize(const Polynomial<std::complex<double> > &polynomial, Factor *factors, double &gain)
+{
+    std::vector<std::complex<double> > roots = findRoots(polynomial);
+    if (roots.size() > 2 * MAX_SECTIONS) {
+        return -1;
+    }
+    gain = polynomial.at(roots.size()).real();
+    // separate the complex conjugate pairs from the real roots:
+    std::vector<double> realRoots;
+    int count = 0, conjugates = 0;
+    for (size_t i = 0; i < roots.size(); i++) {
+        std::complex<double> root = roots[i];
+        if (std::abs(root.imag()) <= 1e-9 * std::max(std::abs(root), 1.0)) {
+            realRoots.push_back(root.real());
+        } else if (root.imag() > 0.0) {
+            if (count == MAX_SECTIONS) {
+                return -1;
+            }
+            // (x - r)(x - r*) = |r|^2 (1 - 2 Re(r) / |r|^2 x + x^2 / |r|^2):
+            double norm = std::norm(root);
+            Factor &factor = factors[count++];
+            factor.c0 = 1.0;
+            factor.c1 = -2.0 * root.real() / norm;
+            factor.c2 = 1.0 / norm;
+            factor.root = 1.0 / root;
+            gain *= norm;
+        } else {
+            conjugates++;
+        }
+    }
+    if (conjugates != count) {
+        // the polynomial's coefficients are not real:
+        return -1;
+    }
+    // combine neighbouring real roots (ordered by their distance to the origin in z^-1):
+    for (size_t i = 1; i < realRoots.size(); i++) {
+        for (size_t j = i; (j > 0) && (std::abs(realRoots[j]) < std::abs(realRoots[j - 1])); j--) {
+            std::swap(realRoots[j], realRoots[j - 1]);
+        }
+    }
+    for (size_t i = 0; i < realRoots.size(); i += 2) {
+        if (count == MAX_SECTIONS) {
+            return -1;
+        }
+        double p0, p1, q0 = 1.0, q1 = 0.0;
+        computeLinearFactor(realRoots[i], p0, p1, gain);
+        if (i + 1 < realRoots.size()) {
+            computeLinearFactor(realRoots[i + 1], q0, q1, gain);
+        }
+        Factor &factor = factors[count++];
+        factor.c0 = p0 * q0;
+        factor.c1 = p0 * q1 + p1 * q0;
+        factor.c2 = p1 * q1;
+        factor.root = (p0 == 0.0 ? 1e30 : 1.0 / realRoots[i]);
+    }
+    return count;
+}
+
+void BiquadCascade::computeLinearFactor(double root, double &c0, double &c1, double &gain)
+{
+    if (std::abs(root) <= 1e-12) {
+        // a root at zero is a pure delay:
+        c0 = 0.0;
+        c1 = 1.0;
+    } else {
+        // x - r = -r (1 - x / r):
+        c0 = 1.0;
+        c1 = -1.0 / root;
+        gain *= -root;
+    }
+}
+
+void BiquadCascade::factorizeQuartic(const double *c, double *p, double *q)
+{
+    // Ferrari's method: substituting z = y - h gives the depressed quartic y^4 + dp y^2 + dq y + dr...
+    double h = 0.25 * c[0], h2 = h * h;
+    double dp = c[1] - 6.0 * h2;
+    double dq = c[2] - 2.0 * c[1] * h + 8.0 * h2 * h;
+    double dr = c[3] - c[2] * h + c[1] * h2 - 3.0 * h2 * h2;
+    // ...which equals (y^2 + s y + t)(y^2 - s y + u) if s^2 is a root of the resolvent cubic
+    // (as its value is -dq^2 at zero, the largest root is never negative):
+    double s2 = std::max(0.0, computeLargestCubicRoot(2.0 * dp, dp * dp - 4.0 * dr, -dq * dq));
+    double s, t, u;
+    if (s2 > 0.0) {
+        s = std::sqrt(s2);
+        t = 0.5 * (dp + s2 - dq / s);
+        u = 0.5 * (dp + s2 + dq / s);
+    } else {
+        // dq is zero, thus the quartic is quadratic in y^2:
+        double root = std::sqrt(std::max(0.0, dp * dp - 4.0 * dr));
+        s = 0.0;
+        t = 0.5 * (dp - root);
+        u = 0.5 * (dp + root);
+    }
+    // substitute back y = z + h:
+    p[0] = 2.0 * h + s;
+    q[0] = h2 + s * h + t;
+    p[1] = 2.0 * h - s;
+    q[1] = h2 - s * h + u;
+}
+
+double BiquadCascade::computeLargestCubicRoot(double a, double b, double c)
+{
+    // substituting x = t - a/3 gives the depressed cubic t^3 + p t + q:
+    double p = b - a * a / 3.0;
+    double q = 2.0 * a * a * a / 27.0 - a * b / 3.0 + c;
+    double discriminant = 0.25 * q * q + p * p * p / 27.0;
+    double t = 0.0;
+    if (discriminant > 0.0) {
+        // one real root (Cardano's formula):
+        double root = std::sqrt(discriminant);
+        t = computeCubeRoot(-0.5 * q + root) + computeCubeRoot(-0.5 * q - root);
+    } else if (p < 0.0) {
+        // three real roots, the largest one in trigonometric form:
+        double m = 2.0 * std::sqrt(-p / 3.0);
+        t = m * std::cos(std::acos(std::max(-1.0, std::min(1.0, 3.0 * q / (p * m)))) / 3.0);
+    }
+    double x = t - a / 3.0;
+    // polish the root with one Newton step, unless that makes it worse (e.g. close to a multiple root):
+    double f = ((x + a) * x + b) * x + c;
+    double derivative = (3.0 * x + 2.0 * a) * x + b;
+    if (derivative != 0.0) {
+        double polished = x - f / derivative;
+        if (std::abs(((polished + a) * polished + b) * polished + c) < std::abs(f)) {
+            x = polished;
+        }
+    }
+    return x;
+}
+
+double BiquadCascade::computeCubeRoot(double x)
+{
+    return (x < 0.0 ? -std::pow(-x, 1.0 / 3.0) : std::pow(x, 1.0 / 3.0));
+}
@@ -0,0 +1,154 @@
+#ifndef BIQUADCASCADE_H
+#define BIQUADCASCADE_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <complex>
+#include <jack/types.h>
+#include "polynomial.h"
+
+/**
+  Realizes a rational transfer function as a cascade of second order
+  sections in transposed direct form II.
+
+  Compared to the direct form of a higher order filter, the cascade is
+  less sensitive to coefficient rounding and needs fewer operations per
+  sample. The sections are computed from the roots of the numerator and
+  denominator polynomials, complex conjugate roots are combined into one
+  section, as are pairs of real roots.
+
+  The sections are held in a fixed-size array, thus setting new
+  coefficients does not allocate memory for the sections themselves.
+  */
+class BiquadCascade
+{
+public:
+    enum {
+        MAX_SECTIONS = 8
+    };
+
+    /**
+      One second order section, computing
+      (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2),
+      together with its two state variables.
+      */
+    struct Section {
+        double b0, b1, b2, a1, a2;
+        double s1, s2;
+    };
+
+    BiquadCascade();
+
+    /**
+      Computes the sections from the given numerator and denominator
+      polynomials in z^-1. The denominator's constant coefficient has to
+      be one.
+
+      The state of the sections is kept if the number of sections does not
+      change, otherwise it is reset.
+
+      @return false if the transfer function cannot be realized by at most
+        MAX_SECTIONS sections, in which case the cascade is empty
+      */
+    bool setTransferFunction(const Polynomial<std::complex<double> > &numerator, const Polynomial<std::complex<double> > &denominator);
+    /**
+      Sets the sections from the coefficients of a filter with a numerator
+      of at most second and a denominator of at most fourth order, i.e.
+      (b[0] + b[1] z^-1 + b[2] z^-2) / (1 + a[0] z^-1 + ... + a[3] z^-4)
+      with missing coefficients being zero. Up to second order this gives
+      a single section, otherwise the denominator is split into two
+      sections in closed form (by Ferrari's method). Unlike
+      setTransferFunction(), this neither has to iterate to find roots nor
+      allocates memory, so it may be called from the process thread.
+
+      The state of the sections is kept if the number of sections does not
+      change, otherwise it is reset.
+
+      @return false if the filter is of higher order, in which case the
+        cascade is empty
+      */
+    bool setCoefficients(const double *b, int bCount, const double *a, int aCount);
+    /**
+      Sets the sections to those of the first cascade followed by those of
+      the second one, which realizes the product of their transfer functions.
+      This does not allocate memory either.
+
+      The state of the sections is kept if the number of sections does not
+      change, otherwise it is reset.
+
+      @return false if both cascades together have more than MAX_SECTIONS
+        sections, in which case the cascade is empty
+      */
+    bool setCascade(const BiquadCascade &first, const BiquadCascade &second);
+
+    /**
+      Substitutes -z for z in all sections, which mirrors the frequency
+      response at a quarter of the sample rate (see IirFilter::invert()).
+      */
+    void invert();
+
+    int getSectionCount() const;
+    const Section & getSection(int index) const;
+
+    void reset();
+
+    double process(double input)
+    {
+        for (int i = 0; i < sectionCount; i++) {
+            Section &section = sections[i];
+            double output = section.b0 * input + section.s1;
+            section.s1 = section.b1 * input - section.a1 * output + section.s2;
+            section.s2 = section.b2 * input - section.a2 * output;
+            input = output;
+        }
+        return input;
+    }
+    void process(const jack_default_audio_sample_t *input, jack_default_audio_sample_t *output, jack_nframes_t start, jack_nframes_t end);
+private:
+    enum {
+        CHUNK_SIZE = 64
+    };
+
+    /**
+      A factor c0 + c1 x + c2 x^2 of a polynomial, together with the
+      location of its root in the z plane (i.e., z = 1/x) which is
+      closest to the unit circle.
+      */
+    struct Factor {
+        double c0, c1, c2;
+        std::complex<double> root;
+    };
+
+    Section sections[MAX_SECTIONS];
+    int sectionCount;
+
+    void setSectionCount(int count);
+    static int factorize(const Polynomial<std::complex<double> > &polynomial, Factor *factors, double &gain);
+    static void computeLinearFactor(double root, double &c0, double &c1, double &gain);
+    /**
+      Splits z^4 + c[0] z^3 + c[1] z^2 + c[2] z + c[3] into the real factors
+      (z^2 + p[0] z + q[0]) (z^2 + p[1] z + q[1]).
+      */
+    static void factorizeQuartic(const double *c, double *p, double *q);
+    static double computeLargestCubicRoot(double a, double b, double c);
+    static double computeCubeRoot(double x);
+};
+
+#endif // BIQUADCASCADE_H
@@ -57,6 +57,12 @@ void ChamberlinFilter::processAudio(const double *inputs, double *outputs, jack_
     outputs[3] = notch;
 }
 
+jack_nframes_t ChamberlinFilter::getSilenceTail() const
+{
+    // the state variables decay with silent input (see IirFilter::getSilenceTail()):
+    return 0;
+}
+
 ChamberlinFilterClient::ChamberlinFilterClient(const QString &clientName, ChamberlinFilter *processFilter_, ChamberlinFilter *guiFilter_, size_t ringBufferSize) :
     ParameterClient(clientName, processFilter_, processFilter_, 0, processFilter_, guiFilter_, ringBufferSize),
     processFilter(processFilter_),
@@ -32,6 +32,7 @@ public:
     // Reimplemented from AudioProcessor:
     virtual void setSampleRate(double sampleRate);
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual jack_nframes_t getSilenceTail() const;
 
 private:
     double f, low, high, band, notch, scale;
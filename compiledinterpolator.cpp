@@ -0,0 +1,180 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "compiledinterpolator.h"
+#include <cmath>
+#include <limits>
+
+CompiledInterpolator::ChangeEvent::ChangeEvent(const CompiledInterpolator &compiledInterpolator_) :
+    compiledInterpolator(new CompiledInterpolator(compiledInterpolator_))
+{
+}
+
+CompiledInterpolator::ChangeEvent::~ChangeEvent()
+{
+    delete compiledInterpolator;
+}
+
+void CompiledInterpolator::ChangeEvent::swap(CompiledInterpolator *&compiledInterpolator_) const
+{
+    std::swap(compiledInterpolator, compiledInterpolator_);
+}
+
+CompiledInterpolator::CompiledInterpolator() :
+    starts(2, 0),
+    coefficients(4, 0),
+    cellPolynomials(1, 0),
+    scale(0),
+    lastCell(0)
+{
+    starts[1] = std::numeric_limits<double>::infinity();
+}
+
+void CompiledInterpolator::compile(Interpolator &interpolator)
+{
+    const QVector<double> &xx = interpolator.getX();
+    starts.resize(0);
+    coefficients.resize(0);
+    double end = 0;
+    for (int i = 0; i + 1 < xx.size(); i++) {
+        // segments without width are never evaluated by the interpolator:
+        if (xx[i] < xx[i + 1]) {
+            fitSegment(interpolator, i, xx[i], xx[i + 1], 0);
+            end = xx[i + 1];
+        }
+    }
+    if (starts.isEmpty()) {
+        // no segment with a width, represent the interpolator by a constant:
+        starts.append(xx.isEmpty() ? 0 : xx[0]);
+        coefficients.fill(0, 4);
+        if (xx.size() >= 2) {
+            coefficients[0] = interpolator.interpolate(0, xx[0]);
+        } else if (xx.size() == 1) {
+            coefficients[0] = interpolator.getY()[0];
+        }
+        end = starts[0];
+    }
+    starts.append(std::numeric_limits<double>::infinity());
+    computeCells(end);
+}
+
+int CompiledInterpolator::getNrOfPolynomials() const
+{
+    return starts.size() - 1;
+}
+
+int CompiledInterpolator::getNrOfCells() const
+{
+    return cellPolynomials.size();
+}
+
+void CompiledInterpolator::evaluate(const double *x, double *y, int n) const
+{
+    evaluateBlock(x, y, n);
+}
+
+void CompiledInterpolator::evaluate(const jack_default_audio_sample_t *x, jack_default_audio_sample_t *y, int n) const
+{
+    evaluateBlock(x, y, n);
+}
+
+template<class T> void CompiledInterpolator::evaluateBlock(const T *x, T *y, int n) const
+{
+    // copy everything to local variables, so the compiler does not have to reload it after each store to y:
+    const double *starts_ = starts.constData();
+    const double *coefficients_ = coefficients.constData();
+    const int *cellPolynomials_ = cellPolynomials.constData();
+    double start = starts_[0], scale_ = scale, lastCell_ = lastCell;
+    for (int i = 0; i < n; i++) {
+        double xi = x[i];
+        int polynomial = cellPolynomials_[(int)std::min(std::max(0.0, (xi - start) * scale_), lastCell_)];
+        polynomial += (xi >= starts_[polynomial + 1]);
+        const double *c = coefficients_ + 4 * polynomial;
+        double t = xi - starts_[polynomial];
+        y[i] = (T)(c[0] + t * (c[1] + t * (c[2] + t * c[3])));
+    }
+}
+
+void CompiledInterpolator::fitSegment(Interpolator &interpolator, int segment, double x1, double x2, int subdivisions)
+{
+    // interpolate the segment at four equidistant points (relative to x1):
+    double h = x2 - x1;
+    double t1 = h / 3.0, t2 = 2.0 * h / 3.0, t3 = h;
+    double y0 = interpolator.interpolate(segment, x1);
+    double y1 = interpolator.interpolate(segment, x1 + t1);
+    double y2 = interpolator.interpolate(segment, x1 + t2);
+    double y3 = interpolator.interpolate(segment, x2);
+    // compute the divided differences of the Newton form:
+    double d01 = (y1 - y0) / t1;
+    double d12 = (y2 - y1) / (t2 - t1);
+    double d23 = (y3 - y2) / (t3 - t2);
+    double d012 = (d12 - d01) / t2;
+    double d123 = (d23 - d12) / (t3 - t1);
+    double d0123 = (d123 - d012) / t3;
+    // convert to the monomial basis:
+    double c[4] = {
+        y0,
+        d01 - d012 * t1 + d0123 * t1 * t2,
+        d012 - d0123 * (t1 + t2),
+        d0123
+    };
+    if (subdivisions < MAXIMUM_SUBDIVISIONS) {
+        // compare with the interpolator between the sample points:
+        for (int i = 1; i < 6; i += 2) {
+            double t = h * i / 6.0;
+            double expected = interpolator.interpolate(segment, x1 + t);
+            double actual = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+            if (!(std::fabs(actual - expected) <= 1e-7 * (1.0 + std::fabs(expected)))) {
+                // not close enough, split the segment in halves:
+                double x = x1 + 0.5 * h;
+                fitSegment(interpolator, segment, x1, x, subdivisions + 1);
+                fitSegment(interpolator, segment, x, x2, subdivisions + 1);
+                return;
+            }
+        }
+    }
+    starts.append(x1);
+    for (int i = 0; i < 4; i++) {
+        coefficients.append(c[i]);
+    }
+}
+
+void CompiledInterpolator::computeCells(double end)
+{
+    int polynomials = getNrOfPolynomials();
+    int cells = MINIMUM_CELLS;
+    for (;; cells *= 2) {
+        scale = (end > starts[0] ? cells / (end - starts[0]) : 0);
+        lastCell = cells - 1;
+        // check that each cell contains the start of at most one polynomial (besides the first one):
+        bool separated = true;
+        for (int i = 2; separated && (i < polynomials); i++) {
+            separated = (getCell(starts[i]) != getCell(starts[i - 1]));
+        }
+        if (separated || (cells >= MAXIMUM_CELLS) || (scale == 0)) {
+            // at the maximum resolution, polynomials narrower than a cell may be skipped
+            break;
+        }
+    }
+    cellPolynomials.resize(cells);
+    for (int i = 0, polynomial = 0; i < cells; i++) {
+        // find the last polynomial starting in a previous cell:
+        for (; (polynomial + 1 < polynomials) && (getCell(starts[polynomial + 1]) < i); polynomial++);
+        cellPolynomials[i] = polynomial;
+    }
+}
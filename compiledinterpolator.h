@@ -0,0 +1,114 @@
+#ifndef COMPILEDINTERPOLATOR_H
+#define COMPILEDINTERPOLATOR_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "interpolator.h"
+#include <jack/types.h>
+#include <QVector>
+#include <algorithm>
+
+/**
+  A read-only form of an Interpolator that can be evaluated without
+  searching the control points and without virtual calls.
+
+  Each segment between two control points is approximated by one or more
+  cubic polynomials (adaptively subdivided until they match the
+  interpolator to within about 1e-7; linear and cubic segments are
+  represented exactly). A uniform grid over the control points' x range
+  gives the polynomial for each input in constant time: the grid is made
+  fine enough for every cell to contain at most one polynomial boundary,
+  so finding the polynomial takes one table lookup and one comparison.
+
+  Outside of the control points' x range the first and the last
+  polynomial are extrapolated.
+  */
+class CompiledInterpolator
+{
+public:
+    /**
+      Carries a compiled interpolator from the GUI thread to the process
+      thread. The receiver swaps it with its own one, so that the previous
+      compiled interpolator is deleted along with the event in the GUI
+      thread.
+      */
+    class ChangeEvent : public RingBufferEvent
+    {
+    public:
+        ChangeEvent(const CompiledInterpolator &compiledInterpolator);
+        virtual ~ChangeEvent();
+        void swap(CompiledInterpolator *&compiledInterpolator) const;
+    private:
+        mutable CompiledInterpolator *compiledInterpolator;
+    };
+
+    /**
+      Creates a compiled interpolator that evaluates to zero everywhere.
+      */
+    CompiledInterpolator();
+
+    /**
+      Approximates the given interpolator. This allocates memory, so do
+      not call it from the process thread.
+      */
+    void compile(Interpolator &interpolator);
+
+    int getNrOfPolynomials() const;
+    int getNrOfCells() const;
+
+    double evaluate(double x) const
+    {
+        int polynomial = cellPolynomials[getCell(x)];
+        // the cell contains at most one more polynomial:
+        polynomial += (x >= starts[polynomial + 1]);
+        const double *coefficients_ = coefficients.constData() + 4 * polynomial;
+        double t = x - starts[polynomial];
+        return coefficients_[0] + t * (coefficients_[1] + t * (coefficients_[2] + t * coefficients_[3]));
+    }
+    /**
+      Evaluates the n values in x and writes the results to y (which may be x).
+      */
+    void evaluate(const double *x, double *y, int n) const;
+    void evaluate(const jack_default_audio_sample_t *x, jack_default_audio_sample_t *y, int n) const;
+private:
+    enum {
+        MINIMUM_CELLS = 16,
+        MAXIMUM_CELLS = 1 << 16,
+        MAXIMUM_SUBDIVISIONS = 8
+    };
+    // the start of each polynomial, followed by infinity:
+    QVector<double> starts;
+    // four coefficients per polynomial, in ascending order and relative to the polynomial's start:
+    QVector<double> coefficients;
+    // the first polynomial intersecting each cell of the grid:
+    QVector<int> cellPolynomials;
+    double scale, lastCell;
+
+    int getCell(double x) const
+    {
+        // comparing with zero first maps NaN to the first cell:
+        return (int)std::min(std::max(0.0, (x - starts[0]) * scale), lastCell);
+    }
+    template<class T> void evaluateBlock(const T *x, T *y, int n) const;
+    void fitSegment(Interpolator &interpolator, int segment, double x1, double x2, int subdivisions);
+    void computeCells(double end);
+};
+
+#endif // COMPILEDINTERPOLATOR_H
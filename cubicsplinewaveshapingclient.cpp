@@ -23,8 +23,56 @@
 #include "cisi.h"
 #include <QPen>
 
-CubicSplineWaveShapingClient::CubicSplineWaveShapingClient(const QString &clientName, CubicSplineInterpolator *processWaveShaper_, CubicSplineInterpolator *guiWaveShaper_, size_t ringBufferSize) :
-    EventProcessorClient(clientName, QStringList("Audio in"), QStringList("Audio out"), QStringList(), QStringList(), ringBufferSize),
+CubicSplineWaveShaper::CubicSplineWaveShaper(const QVector<double> &xx, const QVector<double> &yy) :
+    AudioProcessor(QStringList("Audio in"), QStringList("Audio out")),
+    CubicSplineInterpolator(xx, yy),
+    compiledInterpolator(new CompiledInterpolator())
+{
+    compile();
+}
+
+CubicSplineWaveShaper::~CubicSplineWaveShaper()
+{
+    delete compiledInterpolator;
+}
+
+void CubicSplineWaveShaper::compile()
+{
+    compiledInterpolator->compile(*this);
+}
+
+void CubicSplineWaveShaper::processAudio(const double *inputs, double *outputs, jack_nframes_t)
+{
+    outputs[0] = std::max(std::min(compiledInterpolator->evaluate(inputs[0]), 1.0), -1.0);
+}
+
+void CubicSplineWaveShaper::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    const jack_default_audio_sample_t *input = inputs[0];
+    jack_default_audio_sample_t *output = outputs[0];
+    compiledInterpolator->evaluate(input + start, output + start, end - start);
+    for (jack_nframes_t i = start; i < end; i++) {
+        output[i] = std::max(std::min(output[i], 1.0f), -1.0f);
+    }
+}
+
+bool CubicSplineWaveShaper::processEvent(const RingBufferEvent *event, jack_nframes_t)
+{
+    if (const Interpolator::InterpolatorEvent *event_ = dynamic_cast<const Interpolator::InterpolatorEvent*>(event)) {
+        processInterpolatorEvent(event_);
+        compile();
+        return true;
+    } else if (const CompiledInterpolator::ChangeEvent *event_ = dynamic_cast<const CompiledInterpolator::ChangeEvent*>(event)) {
+        // swap in the curve compiled in the GUI thread, the previous one is deleted with the event:
+        event_->swap(compiledInterpolator);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+CubicSplineWaveShapingClient::CubicSplineWaveShapingClient(const QString &clientName, CubicSplineWaveShaper *processWaveShaper_, CubicSplineWaveShaper *guiWaveShaper_, size_t ringBufferSize) :
+    EventProcessorClient(clientName, processWaveShaper_, 0, processWaveShaper_, ringBufferSize),
     processWaveShaper(processWaveShaper_),
     guiWaveShaper(guiWaveShaper_)
 {
@@ -48,6 +96,7 @@ void CubicSplineWaveShapingClient::loadState(QDataStream &stream)
     EventProcessorClient::loadState(stream);
     guiWaveShaper->load(stream);
     processWaveShaper->changeControlPoints(guiWaveShaper->getX(), guiWaveShaper->getY());
+    processWaveShaper->compile();
 }
 
 QGraphicsItem * CubicSplineWaveShapingClient::createGraphicsItem()
@@ -73,22 +122,19 @@ QPointF CubicSplineWaveShapingClient::getControlPoint(int index)
 void CubicSplineWaveShapingClient::changeControlPoint(int index, double x, double y)
 {
     guiWaveShaper->changeControlPoint(index, x, y);
-    Interpolator::ChangeControlPointEvent *event = new Interpolator::ChangeControlPointEvent(index, x, y);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 void CubicSplineWaveShapingClient::addControlPoint(double x, double y)
 {
     guiWaveShaper->addControlPoint(x, y);
-    Interpolator::AddControlPointEvent *event = new Interpolator::AddControlPointEvent(x, y);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 void CubicSplineWaveShapingClient::deleteControlPoint(int index)
 {
     guiWaveShaper->deleteControlPoint(index);
-    Interpolator::DeleteControlPointEvent *event = new Interpolator::DeleteControlPointEvent(index);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 QString CubicSplineWaveShapingClient::getControlPointName(int index) const
@@ -96,19 +142,12 @@ QString CubicSplineWaveShapingClient::getControlPointName(int index) const
     return guiWaveShaper->getControlPointName(index);
 }
 
-void CubicSplineWaveShapingClient::processAudio(const double *inputs, double *outputs, jack_nframes_t)
+void CubicSplineWaveShapingClient::postCompiledInterpolator()
 {
-    outputs[0] = std::max(std::min(processWaveShaper->evaluate(inputs[0]), 1.0), -1.0);
-}
-
-bool CubicSplineWaveShapingClient::processEvent(const RingBufferEvent *event, jack_nframes_t)
-{
-    if (const Interpolator::InterpolatorEvent *event_ = dynamic_cast<const Interpolator::InterpolatorEvent*>(event)) {
-        processWaveShaper->processInterpolatorEvent(event_);
-        return true;
-    } else {
-        return false;
-    }
+    // the process thread only swaps in the compiled curve, so that it does not have to recompile it:
+    CompiledInterpolator compiled;
+    compiled.compile(*guiWaveShaper);
+    postEvent(new CompiledInterpolator::ChangeEvent(compiled));
 }
 
 class CubicSplineWaveShapingClientFactory : public JackClientFactory
@@ -129,7 +168,7 @@ public:
         yy.append(-1);
         xx.append(1);
         yy.append(1);
-        return new CubicSplineWaveShapingClient(clientName, new CubicSplineInterpolator(xx, yy), new CubicSplineInterpolator(xx, yy));
+        return new CubicSplineWaveShapingClient(clientName, new CubicSplineWaveShaper(xx, yy), new CubicSplineWaveShaper(xx, yy));
     }
     static CubicSplineWaveShapingClientFactory factory;
 };
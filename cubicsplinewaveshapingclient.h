@@ -23,11 +23,31 @@
 #include "eventprocessorclient.h"
 #include "cubicsplineinterpolator.h"
 #include "graphicsinterpolatoredititem.h"
+#include "compiledinterpolator.h"
+
+class CubicSplineWaveShaper : public AudioProcessor, public EventProcessor, public CubicSplineInterpolator
+{
+public:
+    CubicSplineWaveShaper(const QVector<double> &xx, const QVector<double> &yy);
+    virtual ~CubicSplineWaveShaper();
+    /**
+      Rebuilds the compiled interpolator from the current control points.
+      */
+    void compile();
+    // reimplemented from AudioProcessor:
+    virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+    // reimplemented from EventProcessor:
+    virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
+private:
+    // the form of the spline used for processing audio:
+    CompiledInterpolator *compiledInterpolator;
+};
 
 class CubicSplineWaveShapingClient : public EventProcessorClient, public AbstractInterpolator
 {
 public:
-    CubicSplineWaveShapingClient(const QString &clientName, CubicSplineInterpolator *processWaveShaper, CubicSplineInterpolator *guiWaveShaper, size_t ringBufferSize = 1024);
+    CubicSplineWaveShapingClient(const QString &clientName, CubicSplineWaveShaper *processWaveShaper, CubicSplineWaveShaper *guiWaveShaper, size_t ringBufferSize = 1024);
     virtual ~CubicSplineWaveShapingClient();
 
     virtual JackClientFactory * getFactory();
@@ -43,12 +63,11 @@ public:
     virtual void addControlPoint(double x, double y);
     virtual void deleteControlPoint(int index);
     virtual QString getControlPointName(int index) const;
-protected:
-    virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
-    virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
 
 private:
-    CubicSplineInterpolator *processWaveShaper, *guiWaveShaper;
+    CubicSplineWaveShaper *processWaveShaper, *guiWaveShaper;
+
+    void postCompiledInterpolator();
 };
 
 #endif // SPLINEWAVESHAPINGCLIENT_H
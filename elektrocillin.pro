@@ -74,6 +74,14 @@ SOURCES += main.cpp\
     graphicsclientitem.cpp \
     graphicsportitem.cpp \
     metajack/sincfilter.cpp \
+    metajack/metajackschedule.cpp \
+    metajack/metajackthreadpool.cpp \
+    metajack/metajacksemaphore.cpp \
+    metajack/mixingkernels.cpp \
+    metajack/polyphaseresampler.cpp \
+    metajack/offlinejackcontext.cpp \
+    metajack/metajackclientload.cpp \
+    metajack/metajacknametable.cpp \
     polynomialinterpolator.cpp \
     logarithmicinterpolator.cpp \
     graphicslabelitem.cpp \
@@ -94,7 +102,20 @@ SOURCES += main.cpp\
     pareq.cc \
     midiparameterprocessor.cpp \
     logarithmicwaveshaper.cpp \
-    chamberlinfilter.cpp
+    chamberlinfilter.cpp \
+    standardmidifile.cpp \
+    offlinerenderer.cpp \
+    biquadcascade.cpp \
+    iirfilterbank.cpp \
+    iirmoogfilterbank.cpp \
+    wavetable.cpp \
+    wavetableoscillator.cpp \
+    wavetableoscillatorclient.cpp \
+    compiledinterpolator.cpp \
+    parametersnapshot.cpp \
+    parametersmoother.cpp \
+    parameterautomation.cpp \
+    polyphonicprocessor.cpp
 
 HEADERS  += mainwindow.h \
     midi2audioclient.h \
@@ -163,6 +184,14 @@ HEADERS  += mainwindow.h \
     graphicsportitem.h \
     graphicsclientitem.h \
     metajack/sincfilter.h \
+    metajack/metajackschedule.h \
+    metajack/metajackthreadpool.h \
+    metajack/metajacksemaphore.h \
+    metajack/mixingkernels.h \
+    metajack/polyphaseresampler.h \
+    metajack/offlinejackcontext.h \
+    metajack/metajackclientload.h \
+    metajack/metajacknametable.h \
     polynomialinterpolator.h \
     logarithmicinterpolator.h \
     graphicslabelitem.h \
@@ -185,7 +214,20 @@ HEADERS  += mainwindow.h \
     pareq.h \
     midiparameterprocessor.h \
     logarithmicwaveshaper.h \
-    chamberlinfilter.h
+    chamberlinfilter.h \
+    standardmidifile.h \
+    offlinerenderer.h \
+    biquadcascade.h \
+    iirfilterbank.h \
+    iirmoogfilterbank.h \
+    wavetable.h \
+    wavetableoscillator.h \
+    wavetableoscillatorclient.h \
+    compiledinterpolator.h \
+    parametersnapshot.h \
+    parametersmoother.h \
+    parameterautomation.h \
+    polyphonicprocessor.h
 
 FORMS    += mainwindow.ui \
     zplanewidget.ui
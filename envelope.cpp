@@ -76,6 +76,12 @@ int Envelope::getSustainIndex() const
     return qRound(getParameter(1).value);
 }
 
+double Envelope::getDuration() const
+{
+    // the control points' x coordinates are logarithmic in time (see processAudio()):
+    return exp(LogarithmicInterpolator::getX().last()) - 1;
+}
+
 void Envelope::processNoteOn(int inputIndex, unsigned char, unsigned char noteNumber, unsigned char velocity, jack_nframes_t)
 {
     double newVelocity = velocity / 127.0;
@@ -131,6 +137,12 @@ void Envelope::processAudio(const double *, double *outputs, jack_nframes_t)
     outputs[0] = level * velocity;
 }
 
+jack_nframes_t Envelope::getSilenceTail() const
+{
+    // the envelope may still start from a silent level after a note on, until it has run through:
+    return (jack_nframes_t)(getDuration() * getSampleRate());
+}
+
 bool Envelope::processEvent(const RingBufferEvent *event, jack_nframes_t)
 {
     if (const Interpolator::InterpolatorEvent *event_ = dynamic_cast<const Interpolator::InterpolatorEvent*>(event)) {
@@ -141,6 +153,11 @@ bool Envelope::processEvent(const RingBufferEvent *event, jack_nframes_t)
     }
 }
 
+bool Envelope::processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t)
+{
+    return processInterpolatorEvent(event);
+}
+
 bool Envelope::setParameterValue(int index, double value, double min, double max, unsigned int time)
 {
     if (ParameterProcessor::setParameterValue(index, value, min, max, time)) {
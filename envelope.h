@@ -53,14 +53,22 @@ public:
     void load(QDataStream &stream);
 
     int getSustainIndex() const;
+    /**
+      @return the time in seconds from a note on until the envelope has run
+        through all its control points, which changes when the last control
+        point is moved
+      */
+    double getDuration() const;
 
     // reimplemented from MidiProcessor:
     virtual void processNoteOn(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time);
     virtual void processNoteOff(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time);
     // reimplemented from AudioProcessor:
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual jack_nframes_t getSilenceTail() const;
     // reimplemented from EventProcessor:
     virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
+    virtual bool processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t time);
     // reimpemented from ParameterProcessor:
     virtual bool setParameterValue(int index, double value, double min, double max, unsigned int time);
     // reimplemented from Interpolator:
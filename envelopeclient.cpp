@@ -45,6 +45,7 @@ void EnvelopeClient::loadState(QDataStream &stream)
     ParameterClient::loadState(stream);
     guiEnvelope->load(stream);
     *processEnvelope = *guiEnvelope;
+    updateSilenceTail();
 }
 
 QGraphicsItem * EnvelopeClient::createGraphicsItem()
@@ -90,8 +91,12 @@ void EnvelopeClient::changeControlPoint(int index, double x, double y)
 {
     guiEnvelope->changeControlPoint(index, x, y);
     // send the change to the process thread:
-    Interpolator::ChangeControlPointEvent *event = new Interpolator::ChangeControlPointEvent(index, x, y);
-    postEvent(event);
+    Interpolator::ChangeControlPoint change = { index, x, y };
+    postEvent(RingBufferInlineEvent(change));
+    if (index == guiEnvelope->getNrOfControlPoints() - 1) {
+        // the envelope's duration has changed:
+        updateSilenceTail();
+    }
 }
 
 void EnvelopeClient::addControlPoint(double x, double y)
@@ -101,8 +106,10 @@ void EnvelopeClient::addControlPoint(double x, double y)
     const ParameterProcessor::Parameter &parameter = guiEnvelope->getParameter(1);
     changedParameterValue(1, parameter.value, parameter.min, parameter.max);
     // send the change to the process thread:
-    Interpolator::AddControlPointEvent *event = new Interpolator::AddControlPointEvent(x, y);
-    postEvent(event);
+    Interpolator::AddControlPoint add = { x, y };
+    postEvent(RingBufferInlineEvent(add));
+    // this might have changed the last control point:
+    updateSilenceTail();
 }
 
 void EnvelopeClient::deleteControlPoint(int index)
@@ -112,8 +119,10 @@ void EnvelopeClient::deleteControlPoint(int index)
     const ParameterProcessor::Parameter &parameter = guiEnvelope->getParameter(1);
     changedParameterValue(1, parameter.value, parameter.min, parameter.max);
     // send the change to the process thread:
-    Interpolator::DeleteControlPointEvent *event = new Interpolator::DeleteControlPointEvent(index);
-    postEvent(event);
+    Interpolator::DeleteControlPoint deletion = { index };
+    postEvent(RingBufferInlineEvent(deletion));
+    // this might have changed the last control point:
+    updateSilenceTail();
 }
 
 QString EnvelopeClient::getControlPointName(int index) const
@@ -121,6 +130,19 @@ QString EnvelopeClient::getControlPointName(int index) const
     return guiEnvelope->getControlPointName(index);
 }
 
+jack_nframes_t EnvelopeClient::getSilenceTail()
+{
+    // the process envelope gets the same control points as the GUI envelope:
+    return (jack_nframes_t)(guiEnvelope->getDuration() * getSampleRate());
+}
+
+void EnvelopeClient::updateSilenceTail()
+{
+    if (isActive()) {
+        setSilenceTail(getSilenceTail());
+    }
+}
+
 void EnvelopeClient::onChangedParameterValue(int index, double value, double min, double max)
 {
     if (index == 2) {
@@ -59,10 +59,14 @@ public:
 signals:
     void changedYSteps(int steps);
 protected:
+    // Reimplemented from AudioProcessorClient:
+    virtual jack_nframes_t getSilenceTail();
     // Reimplemented from ParameterClient:
     virtual void onChangedParameterValue(int index, double value, double min, double max);
 private:
     Envelope *processEnvelope, *guiEnvelope;
+
+    void updateSilenceTail();
 };
 
 class EnvelopeGraphicsItem : public GraphicsInterpolatorEditItem
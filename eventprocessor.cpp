@@ -22,3 +22,8 @@
 EventProcessor::~EventProcessor()
 {
 }
+
+bool EventProcessor::processInlineEvent(const RingBufferInlineEvent &, jack_nframes_t)
+{
+    return false;
+}
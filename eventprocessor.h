@@ -27,6 +27,14 @@ class EventProcessor
 public:
     virtual ~EventProcessor();
     virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time) = 0;
+    /**
+      Reimplement this method to process events sent by value (see
+      RingBufferInlineEvent), dispatching on their tag.
+      This default implementation ignores all events.
+
+      @return true if the event has been processed, false otherwise
+      */
+    virtual bool processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t time);
 };
 
 #endif // EVENTPROCESSOR_H
@@ -40,7 +40,23 @@ bool EventProcessorClient::postEvent(RingBufferEvent *event)
 {
     if (isActive()) {
         jack_nframes_t time = getEstimatedCurrentTime();
-        return ringBuffer.sendEvent(event, time);
+        bool sent = ringBuffer.sendEvent(event, time);
+        // make sure the event is processed even while the client is idle:
+        wake();
+        return sent;
+    } else {
+        return false;
+    }
+}
+
+bool EventProcessorClient::postEvent(const RingBufferInlineEvent &event)
+{
+    if (isActive()) {
+        jack_nframes_t time = getEstimatedCurrentTime();
+        bool sent = ringBuffer.sendEvent(event, time);
+        // make sure the event is processed even while the client is idle:
+        wake();
+        return sent;
     } else {
         return false;
     }
@@ -56,6 +72,7 @@ bool EventProcessorClient::postEvents(const QVector<RingBufferEvent*> &events)
                 writtenEvents++;
             }
         }
+        wake();
         return (writtenEvents == events.size());
     } else {
         return false;
@@ -90,11 +107,15 @@ bool EventProcessorClient::processEvents(jack_nframes_t start, jack_nframes_t en
                 // process everything up to the event's time stamp:
                 processMidi(currentFrame, eventTime);
                 currentFrame = eventTime;
-                // process the event:
-                RingBufferEvent *event = ringBuffer.readEvent();
-                processEvent(event, eventTime);
-                // have the event deleted in the creator thread:
-                ringBuffer.returnEvent(event);
+                // process the event, dispatching on its tag:
+                RingBufferInlineEvent event = ringBuffer.readEvent();
+                if (event.getTag() == RING_BUFFER_EVENT_OBJECT) {
+                    processEvent(event.getObject(), eventTime);
+                    // have the event object deleted in the creator thread:
+                    ringBuffer.returnEvent(event.getObject());
+                } else {
+                    processInlineEvent(event, eventTime);
+                }
             } else {
                 processMidi(currentFrame, end);
                 currentFrame = end;
@@ -112,3 +133,9 @@ bool EventProcessorClient::processEvent(const RingBufferEvent *event, jack_nfram
     Q_ASSERT(eventProcessor);
     return getEventProcessor()->processEvent(event, time);
 }
+
+bool EventProcessorClient::processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t time)
+{
+    Q_ASSERT(eventProcessor);
+    return getEventProcessor()->processInlineEvent(event, time);
+}
@@ -33,6 +33,12 @@ public:
 
     bool postEvent(RingBufferEvent *event);
     bool postEvents(const QVector<RingBufferEvent*> &events);
+    /**
+      Sends an event by value, which does not allocate any memory.
+      Prefer this for events which are sent often, such as the changes
+      while dragging a control point.
+      */
+    bool postEvent(const RingBufferInlineEvent &event);
 
 protected:
     /**
@@ -65,6 +71,11 @@ protected:
       at construction, i.e. if you used the second constructor.
       */
     virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
+    /**
+      Reimplement this method to process events sent by value if you did
+      not provide an EventProcessor object at construction.
+      */
+    virtual bool processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t time);
 
 private:
     EventProcessor *eventProcessor;
@@ -39,6 +39,7 @@ GraphicsClientItem::GraphicsClientItem(GraphicsClientItemsClient *clientItemsCli
     midiPortStyle(midiPortStyle_),
     font(font_),
     controlsItem(0),
+    loadItem(0),
     isMacro(isMacro_)
 {
     setFlags(QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges | QGraphicsItem::ItemSendsScenePositionChanges | QGraphicsItem::ItemIsFocusable | QGraphicsItem::ItemIsSelectable);
@@ -102,6 +103,26 @@ bool GraphicsClientItem::isModuleItem() const
     return jackClient;
 }
 
+void GraphicsClientItem::setLoad(const MetaJackClientLoad::Statistics &statistics)
+{
+    if (!loadItem) {
+        QFont loadFont = font;
+        loadFont.setPointSizeF(font.pointSizeF() * 0.75);
+        loadItem = new QGraphicsSimpleTextItem(this);
+        loadItem->setFont(loadFont);
+        loadItem->setBrush(QBrush(Qt::darkGray));
+    }
+    double period = (statistics.period ? statistics.period : 1);
+    loadItem->setText(QString("%1%").arg(100.0 * statistics.average / period, 0, 'f', 1));
+    loadItem->setToolTip(QString("DSP load of %1 cycles (percent of the period):\nminimum %2%\naverage %3%\n99th percentile %4%\nmaximum %5%")
+                         .arg(statistics.cycles)
+                         .arg(100.0 * statistics.minimum / period, 0, 'f', 1)
+                         .arg(100.0 * statistics.average / period, 0, 'f', 1)
+                         .arg(100.0 * statistics.percentile99 / period, 0, 'f', 1)
+                         .arg(100.0 * statistics.maximum / period, 0, 'f', 1));
+    positionLoadItem();
+}
+
 void GraphicsClientItem::toggleControls(bool ensureVisible_)
 {
     if (controlsItem) {
@@ -160,7 +181,7 @@ void GraphicsClientItem::initItem()
     // delete all children (except the inner item):
     QList<QGraphicsItem*> children = childItems();
     for (int i = 0; i < children.size(); i++) {
-        if (children[i] != controlsItem) {
+        if ((children[i] != controlsItem) && (children[i] != loadItem)) {
             if (GraphicsPortItem *portItem = dynamic_cast<GraphicsPortItem*>(children[i])) {
                 portItem->deleteLater();
             } else {
@@ -291,4 +312,13 @@ void GraphicsClientItem::initItem()
     QPainterPath combinedPath = bodyPath;
 
     setPath(combinedPath);
+    if (loadItem) {
+        positionLoadItem();
+    }
+}
+
+void GraphicsClientItem::positionLoadItem()
+{
+    // show the load to the right of the client's body:
+    loadItem->setPos(rect.right() + loadItem->boundingRect().height() / 3, rect.center().y() - loadItem->boundingRect().height() / 2);
 }
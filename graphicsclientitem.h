@@ -21,6 +21,7 @@
  */
 
 #include "jackclient.h"
+#include "metajack/metajackclientload.h"
 #include <QGraphicsPathItem>
 #include <QGraphicsScene>
 #include <QPainterPath>
@@ -50,6 +51,12 @@ public:
 
     bool isMacroItem() const;
     bool isModuleItem() const;
+
+    /**
+      Shows the given statistics of the time the client's process callback
+      takes, relative to the period duration.
+      */
+    void setLoad(const MetaJackClientLoad::Statistics &statistics);
 public slots:
     void toggleControls(bool ensureVisible = false);
     void updatePorts();
@@ -65,9 +72,11 @@ private:
     QFont font;
     QRectF rect;
     QGraphicsItem *controlsItem;
+    QGraphicsSimpleTextItem *loadItem;
     bool isMacro;
 
     void initItem();
+    void positionLoadItem();
 };
 
 class RectanglePath : public QPainterPath
@@ -20,12 +20,14 @@
 #include "graphicsclientitemsclient.h"
 #include "jackcontextgraphicsscene.h"
 #include "metajack/recursivejackcontext.h"
+#include "metajack/metajackcontext.h"
 
 QSettings GraphicsClientItemsClient::settings("settings.ini", QSettings::IniFormat);
 
 GraphicsClientItemsClient::GraphicsClientItemsClient(QGraphicsScene *scene_) :
     JackClient("GraphicsClientItemsClient"),
     scene(scene_),
+    metaJackContext(dynamic_cast<MetaJackContext*>(RecursiveJackContext::getInstance()->getCurrentContext())),
     clientStyle(3),
     audioPortStyle(1),
     midiPortStyle(3),
@@ -47,6 +49,10 @@ GraphicsClientItemsClient::GraphicsClientItemsClient(QGraphicsScene *scene_) :
     // the same for ports:
     QObject::connect(this, SIGNAL(portRegistered(QString,QString,int)), this, SLOT(onPortRegistered(QString,QString,int)), Qt::QueuedConnection);
     QObject::connect(this, SIGNAL(portUnregistered(QString,QString,int)), this, SLOT(onPortRegistered(QString,QString,int)), Qt::QueuedConnection);
+    // the clients' load statistics are published about four times per second:
+    if (metaJackContext) {
+        startTimer(250);
+    }
 }
 
 GraphicsClientItemsClient::~GraphicsClientItemsClient()
@@ -189,6 +195,17 @@ QSettings * GraphicsClientItemsClient::getSettings()
     return &settings;
 }
 
+void GraphicsClientItemsClient::timerEvent(QTimerEvent *)
+{
+    for (QMap<QString, GraphicsClientItem*>::iterator i = clientItems.begin(); i != clientItems.end(); i++) {
+        MetaJackClient *client = (MetaJackClient*)metaJackContext->client_by_name(i.key().toAscii().data());
+        MetaJackClientLoad::Statistics statistics;
+        if (client && i.value() && metaJackContext->getClientLoad(client, statistics)) {
+            i.value()->setLoad(statistics);
+        }
+    }
+}
+
 void GraphicsClientItemsClient::onClientRegistered(const QString &clientName)
 {
     // create a client item with that name:
@@ -27,6 +27,8 @@
 #include <QMap>
 #include <QSettings>
 
+class MetaJackContext;
+
 class GraphicsClientItemsClient : public JackClient
 {
     Q_OBJECT
@@ -59,8 +61,15 @@ public slots:
     void onClientRegistered(const QString &clientName);
     void onClientUnregistered(const QString &clientName);
     void onPortRegistered(QString fullPortName, QString type, int flags);
+protected:
+    /**
+      Regularly updates the client items' load display (only inside a MetaJackContext,
+      the outermost Jack server does not measure its clients individually).
+      */
+    virtual void timerEvent(QTimerEvent *event);
 private:
     QGraphicsScene *scene;
+    MetaJackContext *metaJackContext;
     QMap<QString, GraphicsClientItem*> clientItems;
     QMap<QString, QPointF> clientItemPositionMap;
     QMap<QString, QMap<QString, GraphicsPortConnectionItem*> > portConnectionItems;
@@ -34,7 +34,8 @@ IirButterworthFilter::IirButterworthFilter() :
     registerParameter("Midi note frequency offset", 0, -36, 36, 1);
     // uneditable parameters for cutoff modulation from audio, pitch bend and controller, and for resonance modulation from audio and controller:
     registerParameter("Pitch bend", 0, 0, 0, 0);
-
+    // this also gives the band pass its own coefficient vectors, so they can be changed later without allocating memory:
+    bandpass.setProduct(lowpass, highpass);
 }
 
 void IirButterworthFilter::setSampleRate(double sampleRate)
@@ -55,6 +56,19 @@ void IirButterworthFilter::processAudio(const double *inputs, double *outputs, j
     bandpass.processAudio(inputs, outputs + 2, time);
 }
 
+void IirButterworthFilter::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    lowpass.processAudio(inputs, outputs, start, end);
+    highpass.processAudio(inputs, outputs + 1, start, end);
+    bandpass.processAudio(inputs, outputs + 2, start, end);
+}
+
+jack_nframes_t IirButterworthFilter::getSilenceTail() const
+{
+    // see IirFilter::getSilenceTail():
+    return 0;
+}
+
 void IirButterworthFilter::processNoteOn(int inputIndex, unsigned char, unsigned char noteNumber, unsigned char, jack_nframes_t time)
 {
     if (inputIndex == 1) {
@@ -102,8 +116,8 @@ void IirButterworthFilter::computeCoefficients()
     double cutoffFrequencyInHertz = getParameter(1).value * pow(2.0, (getParameter(2).value * getParameter(3).value) / 12.0);
     lowpass.setCutoffFrequency(cutoffFrequencyInHertz);
     highpass.setCutoffFrequency(cutoffFrequencyInHertz);
-    bandpass.copyCoefficients(lowpass);
-    bandpass *= highpass;
+    // the band pass is the low pass followed by the high pass (this is done without factorizing its transfer function):
+    bandpass.setProduct(lowpass, highpass);
 }
 
 IirButterworthFilter2::IirButterworthFilter2(double cutoffFrequencyInHertz, Type type_) :
@@ -55,6 +55,8 @@ public:
     // Reimplemented from AudioProcessor:
     virtual void setSampleRate(double sampleRate);
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+    virtual jack_nframes_t getSilenceTail() const;
     // Reimplemented from MidiProcessor:
     virtual void processNoteOn(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time);
     virtual void processPitchBend(int inputIndex, unsigned char channel, unsigned int value, jack_nframes_t time);
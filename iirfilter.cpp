@@ -19,13 +19,19 @@
 
 #include "iirfilter.h"
 #include <QDebug>
+#include <algorithm>
 
 IirFilter::IirFilter(int feedForwardCoefficients, int feedBackCoefficients, const QStringList &additionalInputPortNames) :
     AudioProcessor(QStringList("Audio in") + additionalInputPortNames, QStringList("Audio out")),
     feedForward(feedForwardCoefficients),
     feedBack(feedBackCoefficients),
     x(feedForwardCoefficients),
-    y(feedBackCoefficients)
+    y(feedBackCoefficients),
+    realization(BIQUAD_CASCADE),
+    // sized like the coefficients, so updateCascade() does not have to allocate memory:
+    cascadeFeedForward(feedForwardCoefficients),
+    cascadeFeedBack(feedBackCoefficients),
+    cascadeValid(false)
 {
     reset();
 }
@@ -35,19 +41,42 @@ IirFilter::IirFilter(const IirFilter &tocopy) :
     feedForward(tocopy.feedForward),
     feedBack(tocopy.feedBack),
     x(tocopy.x),
-    y(tocopy.y)
+    y(tocopy.y),
+    realization(tocopy.realization),
+    cascade(tocopy.cascade),
+    cascadeFeedForward(tocopy.cascadeFeedForward),
+    cascadeFeedBack(tocopy.cascadeFeedBack),
+    cascadeValid(tocopy.cascadeValid)
 {
+    detachVectors();
 }
 
 void IirFilter::copyCoefficients(const IirFilter &tocopy)
 {
     feedForward = tocopy.feedForward;
     feedBack = tocopy.feedBack;
+    x.resize(feedForward.size());
+    y.resize(feedBack.size());
+    cascadeFeedForward.resize(feedForward.size());
+    cascadeFeedBack.resize(feedBack.size());
+    detachVectors();
+}
+
+void IirFilter::setRealization(Realization realization)
+{
+    this->realization = realization;
+}
+
+IirFilter::Realization IirFilter::getRealization() const
+{
+    return realization;
 }
 
 void IirFilter::processAudio(const double *inputs, double *outputs, jack_nframes_t)
 {
-    if (x.size()) {
+    if (updateCascade()) {
+        outputs[0] = cascade.process(inputs[0]);
+    } else if (x.size()) {
         x[0] = inputs[0];
         double result = 0.0;
         for (int i = 0; i < x.size(); i++) {
@@ -69,6 +98,51 @@ void IirFilter::processAudio(const double *inputs, double *outputs, jack_nframes
     }
 }
 
+void IirFilter::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    const jack_default_audio_sample_t *input = inputs[0];
+    jack_default_audio_sample_t *output = outputs[0];
+    int xSize = x.size(), ySize = y.size();
+    if (updateCascade()) {
+        cascade.process(input, output, start, end);
+    } else if (xSize) {
+        // access the coefficients and the history directly to avoid QVector's checks in the inner loops:
+        const double *b = feedForward.constData(), *a = feedBack.constData();
+        double *xx = x.data(), *yy = y.data();
+        for (jack_nframes_t i = start; i < end; i++) {
+            xx[0] = input[i];
+            double result = 0.0;
+            for (int j = 0; j < xSize; j++) {
+                result += xx[j] * b[j];
+            }
+            for (int j = 0; j < ySize; j++) {
+                result -= yy[j] * a[j];
+            }
+            // remember x and y values for next frames:
+            for (int j = xSize - 1; j > 0; j--) {
+                xx[j] = xx[j - 1];
+            }
+            for (int j = ySize - 1; j > 0; j--) {
+                yy[j] = yy[j - 1];
+            }
+            if (ySize) {
+                yy[0] = result;
+            }
+            output[i] = result;
+        }
+    } else {
+        for (jack_nframes_t i = start; i < end; i++) {
+            output[i] = 0.0;
+        }
+    }
+}
+
+jack_nframes_t IirFilter::getSilenceTail() const
+{
+    // once the input is silent, the output of a stable filter decays, so waiting for it to become silent suffices:
+    return 0;
+}
+
 double IirFilter::getSquaredAmplitudeResponse(double hertz)
 {
     std::complex<double> z_inv = 1.0 / std::exp(std::complex<double>(0.0, convertHertzToRadians(hertz)));
@@ -87,6 +161,16 @@ QVector<double> & IirFilter::getFeedBackCoefficients()
     return feedBack;
 }
 
+QVector<double> & IirFilter::getInputHistory()
+{
+    return x;
+}
+
+QVector<double> & IirFilter::getOutputHistory()
+{
+    return y;
+}
+
 QString IirFilter::toString() const
 {
     return polynomialToString(getNumeratorPolynomial()) + " / " + polynomialToString(getDenominatorPolynomial());
@@ -96,10 +180,12 @@ void IirFilter::reset()
 {
     x.fill(0.0);
     y.fill(0.0);
+    cascade.reset();
 }
 
 void IirFilter::invert()
 {
+    bool invertCascade = isCascadeUpToDate();
     // negate all coefficients with odd exponent:
     for (int i = 1; i < feedForward.size(); i += 2) {
         feedForward[i] = -feedForward[i];
@@ -107,6 +193,11 @@ void IirFilter::invert()
     for (int i = 0; i < feedBack.size(); i += 2) {
         feedBack[i] = -feedBack[i];
     }
+    // the same can be done to the sections, which saves factorizing higher order filters again:
+    if (invertCascade) {
+        cascade.invert();
+        rememberCascadeCoefficients();
+    }
 }
 
 IirFilter& IirFilter::operator+=(const IirFilter &b)
@@ -137,6 +228,7 @@ IirFilter& IirFilter::operator+=(const IirFilter &b)
     for (int i = 0; i < feedBack.size(); i++) {
         feedBack[i] = denominator[i + 1].real();
     }
+    factorizeCascade();
     return *this;
 }
 
@@ -159,9 +251,53 @@ IirFilter& IirFilter::operator*=(const IirFilter &b)
     for (int i = 0; i < feedBack.size(); i++) {
         feedBack[i] = denominator[i + 1].real();
     }
+    factorizeCascade();
     return *this;
 }
 
+void IirFilter::setProduct(const IirFilter &first, const IirFilter &second)
+{
+    Q_ASSERT((&first != this) && (&second != this));
+    const double *b1 = first.feedForward.constData(), *b2 = second.feedForward.constData();
+    const double *a1 = first.feedBack.constData(), *a2 = second.feedBack.constData();
+    int b1Size = first.feedForward.size(), b2Size = second.feedForward.size();
+    int a1Size = first.feedBack.size(), a2Size = second.feedBack.size();
+    // multiply the numerators:
+    int feedForwardSize = (b1Size && b2Size ? b1Size + b2Size - 1 : 0);
+    if (feedForward.size() != feedForwardSize) {
+        feedForward.resize(feedForwardSize);
+        x.resize(feedForwardSize);
+        cascadeFeedForward.resize(feedForwardSize);
+    }
+    for (int k = 0; k < feedForwardSize; k++) {
+        double coefficient = 0.0;
+        for (int i = std::max(0, k - b2Size + 1); i <= std::min(k, b1Size - 1); i++) {
+            coefficient += b1[i] * b2[k - i];
+        }
+        feedForward[k] = coefficient;
+    }
+    // multiply the denominators (their constant coefficient is one):
+    int feedBackSize = a1Size + a2Size;
+    if (feedBack.size() != feedBackSize) {
+        feedBack.resize(feedBackSize);
+        y.resize(feedBackSize);
+        cascadeFeedBack.resize(feedBackSize);
+    }
+    for (int k = 0; k < feedBackSize; k++) {
+        double coefficient = (k < a1Size ? a1[k] : 0.0) + (k < a2Size ? a2[k] : 0.0);
+        for (int i = std::max(0, k - a2Size); i < std::min(k, a1Size); i++) {
+            coefficient += a1[i] * a2[k - 1 - i];
+        }
+        feedBack[k] = coefficient;
+    }
+    // the product's sections are those of the given filters:
+    BiquadCascade firstCascade, secondCascade;
+    if (first.getCascade(firstCascade) && second.getCascade(secondCascade) && cascade.setCascade(firstCascade, secondCascade)) {
+        rememberCascadeCoefficients();
+        cascadeValid = true;
+    }
+}
+
 int IirFilter::computeBinomialCoefficient(int n, int k)
 {
     if (k == 0) {
@@ -178,6 +314,68 @@ int IirFilter::computeBinomialCoefficient(int n, int k)
     }
 }
 
+bool IirFilter::updateCascade()
+{
+    if (realization != BIQUAD_CASCADE) {
+        return false;
+    }
+    // the coefficients might have been changed through the references returned by
+    // getFeedForwardCoefficients() and getFeedBackCoefficients(), thus compare them to
+    // the ones the cascade has been computed from:
+    if ((feedForward != cascadeFeedForward) || (feedBack != cascadeFeedBack)) {
+        rememberCascadeCoefficients();
+        // this is called from the process thread, so filters are only converted here in closed form,
+        // others are processed in direct form until their cascade is factorized (see factorizeCascade()):
+        cascadeValid = cascade.setCoefficients(feedForward.constData(), feedForward.size(), feedBack.constData(), feedBack.size());
+    }
+    return cascadeValid;
+}
+
+bool IirFilter::isCascadeUpToDate() const
+{
+    return cascadeValid && (feedForward == cascadeFeedForward) && (feedBack == cascadeFeedBack);
+}
+
+bool IirFilter::getCascade(BiquadCascade &result) const
+{
+    // filters of at most fourth order (with at most two zeros) are converted in closed form:
+    if (result.setCoefficients(feedForward.constData(), feedForward.size(), feedBack.constData(), feedBack.size())) {
+        return true;
+    }
+    // higher order filters have a cascade if it has been factorized from the current coefficients:
+    return isCascadeUpToDate() && result.setCascade(cascade, BiquadCascade());
+}
+
+void IirFilter::factorizeCascade()
+{
+    rememberCascadeCoefficients();
+    cascadeValid = cascade.setTransferFunction(getNumeratorPolynomial(), getDenominatorPolynomial());
+}
+
+void IirFilter::rememberCascadeCoefficients()
+{
+    // copy element-wise to avoid sharing the data with the coefficient vectors:
+    cascadeFeedForward.resize(feedForward.size());
+    for (int i = 0; i < feedForward.size(); i++) {
+        cascadeFeedForward[i] = feedForward[i];
+    }
+    cascadeFeedBack.resize(feedBack.size());
+    for (int i = 0; i < feedBack.size(); i++) {
+        cascadeFeedBack[i] = feedBack[i];
+    }
+}
+
+void IirFilter::detachVectors()
+{
+    // copied vectors share their data until they are written to, which would allocate memory in the process thread:
+    feedForward.detach();
+    feedBack.detach();
+    x.detach();
+    y.detach();
+    cascadeFeedForward.detach();
+    cascadeFeedBack.detach();
+}
+
 Polynomial<std::complex<double> > IirFilter::getNumeratorPolynomial() const
 {
     Polynomial<std::complex<double> > numerator(feedForward.size() ? feedForward[0] : 0);
@@ -26,17 +26,50 @@
 #include "eventprocessor.h"
 #include "frequencyresponse.h"
 #include "polynomial.h"
+#include "biquadcascade.h"
 
 class IirFilter : public AudioProcessor, public FrequencyResponse
 {
 public:
+    /**
+      DIRECT_FORM evaluates the difference equation with the feed forward and
+      feedback coefficients directly. BIQUAD_CASCADE (the default) processes
+      a cascade of second order sections.
+
+      Filters with a denominator of at most fourth order and a numerator of
+      at most second order are converted in closed form whenever the
+      coefficients change (see BiquadCascade::setCoefficients()). Other
+      filters have to be factorized, which allocates memory and thus is
+      not done by the processing methods: their cascade is computed by the
+      filter arithmetic (operator+=(), operator*=() and setProduct()).
+      If their coefficients are changed otherwise, or if the filter has too
+      high an order, the direct form is used.
+      */
+    enum Realization {
+        DIRECT_FORM,
+        BIQUAD_CASCADE
+    };
+
     IirFilter(int feedForwardCoefficients, int feedBackCoefficients, const QStringList &additionalInputPortNames = QStringList());
+    /**
+      The copy does not share any data with the given filter, so it can be
+      processed and its coefficients can be changed without allocating memory.
+      */
     IirFilter(const IirFilter &tocopy);
 
+    /**
+      Copies the given filter's coefficients. This allocates memory if the
+      number of coefficients changes, so it should be called from the GUI thread.
+      */
     void copyCoefficients(const IirFilter &tocopy);
 
+    void setRealization(Realization realization);
+    Realization getRealization() const;
+
     // reimplemented from AudioProcessor:
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+    virtual jack_nframes_t getSilenceTail() const;
     // reimplemented from FrequencyResponse:
     virtual double getSquaredAmplitudeResponse(double hertz);
 
@@ -53,13 +86,46 @@ public:
     IirFilter& operator+=(const IirFilter &b);
     // multiply with another IIRFilter (which means serial operation):
     IirFilter& operator*=(const IirFilter &b);
+    /**
+      Sets the coefficients to those of the serial operation of the given
+      filters, like operator*=(). The cascade is made of the given filters'
+      sections, so unlike operator*=() this does not factorize anything and
+      does not allocate memory if the number of coefficients does not change.
+      Thus it can be used from the process thread.
+
+      Neither of the given filters may be this filter.
+      */
+    void setProduct(const IirFilter &first, const IirFilter &second);
+    /**
+      Sets the given cascade to realize this filter's transfer function
+      without allocating memory, i.e. in closed form or from the cascade
+      factorized by the filter arithmetic.
+
+      @return false if neither is possible with the current coefficients
+      */
+    bool getCascade(BiquadCascade &result) const;
 
     static int computeBinomialCoefficient(int n, int k);
-private:
-    QVector<double> feedForward, feedBack, x, y;
 
     Polynomial<std::complex<double> > getNumeratorPolynomial() const;
     Polynomial<std::complex<double> > getDenominatorPolynomial() const;
+protected:
+    // direct access to the previous inputs and outputs for subclasses with their own processing loops:
+    QVector<double> & getInputHistory();
+    QVector<double> & getOutputHistory();
+private:
+    QVector<double> feedForward, feedBack, x, y;
+    Realization realization;
+    BiquadCascade cascade;
+    // the coefficients the cascade has been computed from:
+    QVector<double> cascadeFeedForward, cascadeFeedBack;
+    bool cascadeValid;
+
+    bool updateCascade();
+    bool isCascadeUpToDate() const;
+    void factorizeCascade();
+    void rememberCascadeCoefficients();
+    void detachVectors();
 };
 
 #endif // IIRFILTER_H
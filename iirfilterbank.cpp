@@ -0,0 +1,284 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "iirfilterbank.h"
+#include "metajack/mixingkernels.h"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define IIRFILTERBANK_X86
+#include <immintrin.h>
+#endif
+
+/*
+  Kernels processing a chunk of interleaved frames (buffer[frame * lanes + lane])
+  through all sections, one section after the other
+  */
+
+static void processSectionsScalar(double *sections, int sectionCount, int lanes, double *buffer, int frames)
+{
+    for (int section = 0; section < sectionCount; section++) {
+        double *arrays = sections + section * IirFilterBank::SECTION_ARRAYS * lanes;
+        for (int lane = 0; lane < lanes; lane++) {
+            double b0 = arrays[IirFilterBank::B0 * lanes + lane], b1 = arrays[IirFilterBank::B1 * lanes + lane], b2 = arrays[IirFilterBank::B2 * lanes + lane];
+            double a1 = arrays[IirFilterBank::A1 * lanes + lane], a2 = arrays[IirFilterBank::A2 * lanes + lane];
+            double s1 = arrays[IirFilterBank::S1 * lanes + lane], s2 = arrays[IirFilterBank::S2 * lanes + lane];
+            for (int i = 0; i < frames; i++) {
+                double in = buffer[i * lanes + lane];
+                double out = b0 * in + s1;
+                s1 = b1 * in - a1 * out + s2;
+                s2 = b2 * in - a2 * out;
+                buffer[i * lanes + lane] = out;
+            }
+            arrays[IirFilterBank::S1 * lanes + lane] = s1;
+            arrays[IirFilterBank::S2 * lanes + lane] = s2;
+        }
+    }
+}
+
+#ifdef IIRFILTERBANK_X86
+
+__attribute__((target("sse2"))) static void processSectionsSse2(double *sections, int sectionCount, int lanes, double *buffer, int frames)
+{
+    for (int section = 0; section < sectionCount; section++) {
+        double *arrays = sections + section * IirFilterBank::SECTION_ARRAYS * lanes;
+        // the number of lanes is a multiple of four, process two vectors at
+        // once to hide the latency of the recursion:
+        for (int lane = 0; lane < lanes; lane += 4) {
+            double *b0 = arrays + IirFilterBank::B0 * lanes + lane, *b1 = arrays + IirFilterBank::B1 * lanes + lane, *b2 = arrays + IirFilterBank::B2 * lanes + lane;
+            double *a1 = arrays + IirFilterBank::A1 * lanes + lane, *a2 = arrays + IirFilterBank::A2 * lanes + lane;
+            double *s1 = arrays + IirFilterBank::S1 * lanes + lane, *s2 = arrays + IirFilterBank::S2 * lanes + lane;
+            __m128d b0x = _mm_load_pd(b0), b1x = _mm_load_pd(b1), b2x = _mm_load_pd(b2), a1x = _mm_load_pd(a1), a2x = _mm_load_pd(a2);
+            __m128d b0y = _mm_load_pd(b0 + 2), b1y = _mm_load_pd(b1 + 2), b2y = _mm_load_pd(b2 + 2), a1y = _mm_load_pd(a1 + 2), a2y = _mm_load_pd(a2 + 2);
+            __m128d s1x = _mm_load_pd(s1), s2x = _mm_load_pd(s2), s1y = _mm_load_pd(s1 + 2), s2y = _mm_load_pd(s2 + 2);
+            for (int i = 0; i < frames; i++) {
+                double *frame = buffer + i * lanes + lane;
+                __m128d inx = _mm_load_pd(frame), iny = _mm_load_pd(frame + 2);
+                __m128d outx = _mm_add_pd(_mm_mul_pd(b0x, inx), s1x);
+                __m128d outy = _mm_add_pd(_mm_mul_pd(b0y, iny), s1y);
+                s1x = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1x, inx), _mm_mul_pd(a1x, outx)), s2x);
+                s1y = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1y, iny), _mm_mul_pd(a1y, outy)), s2y);
+                s2x = _mm_sub_pd(_mm_mul_pd(b2x, inx), _mm_mul_pd(a2x, outx));
+                s2y = _mm_sub_pd(_mm_mul_pd(b2y, iny), _mm_mul_pd(a2y, outy));
+                _mm_store_pd(frame, outx);
+                _mm_store_pd(frame + 2, outy);
+            }
+            _mm_store_pd(s1, s1x);
+            _mm_store_pd(s2, s2x);
+            _mm_store_pd(s1 + 2, s1y);
+            _mm_store_pd(s2 + 2, s2y);
+        }
+    }
+}
+
+__attribute__((target("avx"))) static void processSectionsAvx(double *sections, int sectionCount, int lanes, double *buffer, int frames)
+{
+    for (int section = 0; section < sectionCount; section++) {
+        double *arrays = sections + section * IirFilterBank::SECTION_ARRAYS * lanes;
+        int lane = 0;
+        // process two vectors at once to hide the latency of the recursion:
+        for (; lane + 8 <= lanes; lane += 8) {
+            double *b0 = arrays + IirFilterBank::B0 * lanes + lane, *b1 = arrays + IirFilterBank::B1 * lanes + lane, *b2 = arrays + IirFilterBank::B2 * lanes + lane;
+            double *a1 = arrays + IirFilterBank::A1 * lanes + lane, *a2 = arrays + IirFilterBank::A2 * lanes + lane;
+            double *s1 = arrays + IirFilterBank::S1 * lanes + lane, *s2 = arrays + IirFilterBank::S2 * lanes + lane;
+            __m256d b0x = _mm256_load_pd(b0), b1x = _mm256_load_pd(b1), b2x = _mm256_load_pd(b2), a1x = _mm256_load_pd(a1), a2x = _mm256_load_pd(a2);
+            __m256d b0y = _mm256_load_pd(b0 + 4), b1y = _mm256_load_pd(b1 + 4), b2y = _mm256_load_pd(b2 + 4), a1y = _mm256_load_pd(a1 + 4), a2y = _mm256_load_pd(a2 + 4);
+            __m256d s1x = _mm256_load_pd(s1), s2x = _mm256_load_pd(s2), s1y = _mm256_load_pd(s1 + 4), s2y = _mm256_load_pd(s2 + 4);
+            for (int i = 0; i < frames; i++) {
+                double *frame = buffer + i * lanes + lane;
+                __m256d inx = _mm256_load_pd(frame), iny = _mm256_load_pd(frame + 4);
+                __m256d outx = _mm256_add_pd(_mm256_mul_pd(b0x, inx), s1x);
+                __m256d outy = _mm256_add_pd(_mm256_mul_pd(b0y, iny), s1y);
+                s1x = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1x, inx), _mm256_mul_pd(a1x, outx)), s2x);
+                s1y = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1y, iny), _mm256_mul_pd(a1y, outy)), s2y);
+                s2x = _mm256_sub_pd(_mm256_mul_pd(b2x, inx), _mm256_mul_pd(a2x, outx));
+                s2y = _mm256_sub_pd(_mm256_mul_pd(b2y, iny), _mm256_mul_pd(a2y, outy));
+                _mm256_store_pd(frame, outx);
+                _mm256_store_pd(frame + 4, outy);
+            }
+            _mm256_store_pd(s1, s1x);
+            _mm256_store_pd(s2, s2x);
+            _mm256_store_pd(s1 + 4, s1y);
+            _mm256_store_pd(s2 + 4, s2y);
+        }
+        // the remaining four lanes:
+        for (; lane < lanes; lane += 4) {
+            double *b0 = arrays + IirFilterBank::B0 * lanes + lane, *b1 = arrays + IirFilterBank::B1 * lanes + lane, *b2 = arrays + IirFilterBank::B2 * lanes + lane;
+            double *a1 = arrays + IirFilterBank::A1 * lanes + lane, *a2 = arrays + IirFilterBank::A2 * lanes + lane;
+            double *s1 = arrays + IirFilterBank::S1 * lanes + lane, *s2 = arrays + IirFilterBank::S2 * lanes + lane;
+            __m256d b0x = _mm256_load_pd(b0), b1x = _mm256_load_pd(b1), b2x = _mm256_load_pd(b2), a1x = _mm256_load_pd(a1), a2x = _mm256_load_pd(a2);
+            __m256d s1x = _mm256_load_pd(s1), s2x = _mm256_load_pd(s2);
+            for (int i = 0; i < frames; i++) {
+                double *frame = buffer + i * lanes + lane;
+                __m256d inx = _mm256_load_pd(frame);
+                __m256d outx = _mm256_add_pd(_mm256_mul_pd(b0x, inx), s1x);
+                s1x = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1x, inx), _mm256_mul_pd(a1x, outx)), s2x);
+                s2x = _mm256_sub_pd(_mm256_mul_pd(b2x, inx), _mm256_mul_pd(a2x, outx));
+                _mm256_store_pd(frame, outx);
+            }
+            _mm256_store_pd(s1, s1x);
+            _mm256_store_pd(s2, s2x);
+        }
+    }
+}
+
+#endif // IIRFILTERBANK_X86
+
+IirFilterBank::IirFilterBank(int voices_) :
+    AudioProcessor(createPortNames("Audio in", voices_), createPortNames("Audio out", voices_)),
+    voices(voices_),
+    lanes((voices_ + LANE_GRANULARITY - 1) / LANE_GRANULARITY * LANE_GRANULARITY),
+    sectionCount(0),
+    voiceSectionCounts(voices_, 0),
+    memory((BiquadCascade::MAX_SECTIONS * SECTION_ARRAYS + CHUNK_SIZE) * lanes + MixingKernels::ALIGNMENT / sizeof(double), 0.0)
+{
+    // align the section arrays and the chunk buffer for the vector kernels:
+    double *data = memory.data();
+    size_t misalignment = (size_t)data % MixingKernels::ALIGNMENT;
+    sections = data + (misalignment ? (MixingKernels::ALIGNMENT - misalignment) / sizeof(double) : 0);
+    buffer = sections + BiquadCascade::MAX_SECTIONS * SECTION_ARRAYS * lanes;
+    // all sections initially pass their input unchanged:
+    for (int section = 0; section < BiquadCascade::MAX_SECTIONS; section++) {
+        double *b0 = getSectionArray(section, B0);
+        for (int lane = 0; lane < lanes; lane++) {
+            b0[lane] = 1.0;
+        }
+    }
+}
+
+int IirFilterBank::getNrOfVoices() const
+{
+    return voices;
+}
+
+bool IirFilterBank::setFilter(int voice, const IirFilter &filter)
+{
+    // only filters which can't be converted without allocating memory have to be factorized here:
+    if (!filter.getCascade(converter) && !converter.setTransferFunction(filter.getNumeratorPolynomial(), filter.getDenominatorPolynomial())) {
+        return false;
+    }
+    int count = converter.getSectionCount();
+    bool keepState = (count == voiceSectionCounts[voice]);
+    for (int section = 0; section < BiquadCascade::MAX_SECTIONS; section++) {
+        if (section < count) {
+            const BiquadCascade::Section &converted = converter.getSection(section);
+            getSectionArray(section, B0)[voice] = converted.b0;
+            getSectionArray(section, B1)[voice] = converted.b1;
+            getSectionArray(section, B2)[voice] = converted.b2;
+            getSectionArray(section, A1)[voice] = converted.a1;
+            getSectionArray(section, A2)[voice] = converted.a2;
+        } else {
+            getSectionArray(section, B0)[voice] = 1.0;
+            getSectionArray(section, B1)[voice] = 0.0;
+            getSectionArray(section, B2)[voice] = 0.0;
+            getSectionArray(section, A1)[voice] = 0.0;
+            getSectionArray(section, A2)[voice] = 0.0;
+        }
+        if (!keepState) {
+            getSectionArray(section, S1)[voice] = 0.0;
+            getSectionArray(section, S2)[voice] = 0.0;
+        }
+    }
+    voiceSectionCounts[voice] = count;
+    sectionCount = 0;
+    for (int i = 0; i < voices; i++) {
+        sectionCount = std::max(sectionCount, voiceSectionCounts[i]);
+    }
+    return true;
+}
+
+void IirFilterBank::reset()
+{
+    for (int section = 0; section < BiquadCascade::MAX_SECTIONS; section++) {
+        double *s1 = getSectionArray(section, S1), *s2 = getSectionArray(section, S2);
+        for (int lane = 0; lane < lanes; lane++) {
+            s1[lane] = s2[lane] = 0.0;
+        }
+    }
+}
+
+void IirFilterBank::processAudio(const double *inputs, double *outputs, jack_nframes_t)
+{
+    for (int voice = 0; voice < voices; voice++) {
+        double value = inputs[voice];
+        for (int section = 0; section < sectionCount; section++) {
+            double *arrays = getSectionArray(section, B0);
+            double out = arrays[B0 * lanes + voice] * value + arrays[S1 * lanes + voice];
+            arrays[S1 * lanes + voice] = arrays[B1 * lanes + voice] * value - arrays[A1 * lanes + voice] * out + arrays[S2 * lanes + voice];
+            arrays[S2 * lanes + voice] = arrays[B2 * lanes + voice] * value - arrays[A2 * lanes + voice] * out;
+            value = out;
+        }
+        outputs[voice] = value;
+    }
+}
+
+void IirFilterBank::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+#ifdef IIRFILTERBANK_X86
+    MixingKernels::Implementation implementation = MixingKernels::getImplementation();
+#endif
+    for (jack_nframes_t chunkStart = start; chunkStart < end; chunkStart += CHUNK_SIZE) {
+        int frames = std::min<jack_nframes_t>(end - chunkStart, CHUNK_SIZE);
+        // interleave the voices' inputs:
+        for (int voice = 0; voice < voices; voice++) {
+            const jack_default_audio_sample_t *input = inputs[voice] + chunkStart;
+            for (int i = 0; i < frames; i++) {
+                buffer[i * lanes + voice] = input[i];
+            }
+        }
+#ifdef IIRFILTERBANK_X86
+        if (implementation == MixingKernels::AVX) {
+            processSectionsAvx(sections, sectionCount, lanes, buffer, frames);
+        } else if (implementation == MixingKernels::SSE2) {
+            processSectionsSse2(sections, sectionCount, lanes, buffer, frames);
+        } else {
+            processSectionsScalar(sections, sectionCount, lanes, buffer, frames);
+        }
+#else
+        processSectionsScalar(sections, sectionCount, lanes, buffer, frames);
+#endif
+        // write the voices' outputs:
+        for (int voice = 0; voice < voices; voice++) {
+            jack_default_audio_sample_t *output = outputs[voice] + chunkStart;
+            for (int i = 0; i < frames; i++) {
+                output[i] = buffer[i * lanes + voice];
+            }
+        }
+    }
+}
+
+jack_nframes_t IirFilterBank::getSilenceTail() const
+{
+    // each band decays on its own once the input is silent:
+    return 0;
+}
+
+double * IirFilterBank::getSectionArray(int section, SectionArray array)
+{
+    return sections + (section * SECTION_ARRAYS + array) * lanes;
+}
+
+QStringList IirFilterBank::createPortNames(const QString &prefix, int voices)
+{
+    QStringList names;
+    for (int voice = 0; voice < voices; voice++) {
+        names.append(QString("%1 %2").arg(prefix).arg(voice + 1));
+    }
+    return names;
+}
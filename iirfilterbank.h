@@ -0,0 +1,103 @@
+#ifndef IIRFILTERBANK_H
+#define IIRFILTERBANK_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QVector>
+#include "audioprocessor.h"
+#include "iirfilter.h"
+#include "biquadcascade.h"
+
+/**
+  Processes several independent IIR filters (voices) in lockstep, each one
+  with its own input and output and its own coefficients.
+
+  The recursion of an IIR filter cannot be vectorized across time, but the
+  same recursion of several voices can: all voices are realized as cascades
+  of second order sections (see BiquadCascade), whose coefficients and
+  states are stored in structure-of-arrays layout, such that the SSE2 or AVX
+  kernels (as selected by MixingKernels) advance two or four voices per
+  instruction.
+
+  Voices whose filter has fewer sections than others are padded with
+  sections which pass their input unchanged.
+  */
+class IirFilterBank : public AudioProcessor
+{
+public:
+    // the arrays (in memory order) held for each section, each one has one element per lane:
+    enum SectionArray {
+        B0,
+        B1,
+        B2,
+        A1,
+        A2,
+        S1,
+        S2,
+        SECTION_ARRAYS
+    };
+
+    IirFilterBank(int voices);
+
+    int getNrOfVoices() const;
+
+    /**
+      Sets the given voice's coefficients to realize the transfer function
+      of the given filter. The voice's state is kept if its number of
+      sections does not change.
+
+      This may be called from the process thread for filters which can be
+      converted in closed form (see IirFilter::getCascade()), e.g. the Moog
+      filter of IirMoogFilterBank.
+
+      @return false if the filter's transfer function cannot be realized by
+        at most BiquadCascade::MAX_SECTIONS sections, in which case the
+        voice is left unchanged
+      */
+    bool setFilter(int voice, const IirFilter &filter);
+
+    void reset();
+
+    // reimplemented from AudioProcessor:
+    virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+    virtual jack_nframes_t getSilenceTail() const;
+private:
+    enum {
+        // the number of lanes is a multiple of the widest vector (four doubles with AVX):
+        LANE_GRANULARITY = 4,
+        CHUNK_SIZE = 64
+    };
+    int voices, lanes, sectionCount;
+    QVector<int> voiceSectionCounts;
+    // the section arrays and the chunk buffer (interleaved by lanes), aligned within this memory:
+    QVector<double> memory;
+    double *sections, *buffer;
+    BiquadCascade converter;
+
+    // copying would leave the aligned pointers pointing into the original's memory:
+    IirFilterBank(const IirFilterBank &tocopy);
+    IirFilterBank & operator=(const IirFilterBank &tocopy);
+
+    double * getSectionArray(int section, SectionArray array);
+    static QStringList createPortNames(const QString &prefix, int voices);
+};
+
+#endif // IIRFILTERBANK_H
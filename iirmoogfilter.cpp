@@ -20,10 +20,16 @@
 #include "iirmoogfilter.h"
 #include <cmath>
 
+QVector<double> IirMoogFilter::coefficientTable = IirMoogFilter::createCoefficientTable();
+
 IirMoogFilter::IirMoogFilter(int zeros) :
     IirFilter(1 + zeros, 4, QStringList("Cutoff mod.") + QStringList("Resonance mod.")),
     MidiParameterProcessor(QStringList("Midi note in"), QStringList()),
-    recomputeCoefficients(false)
+    recomputeCoefficients(false),
+    controlRate(16),
+    controlCoefficientsValid(false),
+    controlA1(0),
+    controlK(0)
 {
     // cutoff frequency in Hertz (default is a quarter the sample rate)
     registerParameter("Base cutoff frequency", 440, 0, 0, 0);
@@ -43,12 +49,21 @@ IirMoogFilter::IirMoogFilter(int zeros) :
     registerParameter("Resonance modulation", 0, 0, 0, 0);
     registerParameter("Pitch bend", 0, 0, 0, 0);
 
+    // the coefficients change from frame to frame when modulated, which is cheaper to follow in direct form:
+    setRealization(DIRECT_FORM);
+    computeFeedForwardWeights();
     computeCoefficients();
 }
 
 IirMoogFilter::IirMoogFilter(const IirMoogFilter &tocopy) :
     IirFilter(tocopy),
-    MidiParameterProcessor(tocopy)
+    MidiParameterProcessor(tocopy),
+    recomputeCoefficients(true),
+    controlRate(tocopy.controlRate),
+    controlCoefficientsValid(false),
+    controlA1(0),
+    controlK(0),
+    feedForwardWeights(tocopy.feedForwardWeights)
 {
 }
 
@@ -56,6 +71,7 @@ void IirMoogFilter::setSampleRate(double sampleRate)
 {
     IirFilter::setSampleRate(sampleRate);
     recomputeCoefficients = true;
+    controlCoefficientsValid = false;
     // adapt the maximum cutoff frequency:
     getParameter(1).max = 0.5 * sampleRate;
 }
@@ -66,16 +82,91 @@ void IirMoogFilter::processAudio(const double *inputs, double *outputs, jack_nfr
     ParameterProcessor::setParameterValue(8, inputs[1], time);
     // resonance modulation through audio input 3:
     ParameterProcessor::setParameterValue(9, inputs[2], time);
+    // follow a ramping base cutoff frequency:
+    ParameterSmoother &cutoffSmoother = getParameterSmoother(1);
+    if (cutoffSmoother.isSmoothing()) {
+        cutoffSmoother.next();
+        recomputeCoefficients = true;
+    }
     // compute coefficients if necessary:
     computeCoefficients();
     IirFilter::processAudio(inputs, outputs, time);
 }
 
+void IirMoogFilter::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    if (controlRate <= 1) {
+        // the modulation inputs have to be considered per frame, thus don't use IirFilter's block processing:
+        AudioProcessor::processAudio(inputs, outputs, start, end);
+        return;
+    }
+    const jack_default_audio_sample_t *input = inputs[0];
+    jack_default_audio_sample_t *output = outputs[0];
+    // access the history directly to avoid QVector's checks in the inner loop:
+    int xSize = getInputHistory().size();
+    double *xx = getInputHistory().data(), *yy = getOutputHistory().data();
+    const double *weights = feedForwardWeights.constData();
+    ParameterSmoother &cutoffSmoother = getParameterSmoother(1);
+    for (jack_nframes_t controlStart = start; controlStart < end; controlStart += controlRate) {
+        jack_nframes_t controlEnd = qMin(controlStart + (jack_nframes_t)controlRate, end);
+        // evaluate the modulation inputs only once per control period, at its last frame
+        // (such that the interpolated coefficients do not lag behind the modulation):
+        ParameterProcessor::setParameterValue(8, inputs[1][controlEnd - 1], controlEnd - 1);
+        ParameterProcessor::setParameterValue(9, inputs[2][controlEnd - 1], controlEnd - 1);
+        // a ramping base cutoff frequency is followed the same way:
+        if (cutoffSmoother.isSmoothing()) {
+            cutoffSmoother.advance(controlEnd - controlStart);
+            recomputeCoefficients = true;
+        }
+        double targetA1, targetK;
+        lookUpCoefficients(targetA1, targetK);
+        if (!controlCoefficientsValid) {
+            controlA1 = targetA1;
+            controlK = targetK;
+            controlCoefficientsValid = true;
+        }
+        // interpolate linearly from the previous to the new coefficients:
+        double a1Increment = (targetA1 - controlA1) / (controlEnd - controlStart);
+        double kIncrement = (targetK - controlK) / (controlEnd - controlStart);
+        double a1 = controlA1, k = controlK;
+        for (jack_nframes_t i = controlStart; i < controlEnd; i++) {
+            a1 += a1Increment;
+            k += kIncrement;
+            // same as in computeCoefficients():
+            double a2 = a1 * a1;
+            double b0 = k + 4.0 * a1;
+            double b1 = 6.0 * a2;
+            double b2 = 4.0 * a2 * a1;
+            double b3 = a2 * a2;
+            double feedBackSum = 1.0 + b0 + b1 + b2 + b3;
+            xx[0] = input[i];
+            double result = 0.0;
+            for (int j = 0; j < xSize; j++) {
+                result += xx[j] * weights[j];
+            }
+            result = result * feedBackSum - yy[0] * b0 - yy[1] * b1 - yy[2] * b2 - yy[3] * b3;
+            // remember x and y values for next frames:
+            for (int j = xSize - 1; j > 0; j--) {
+                xx[j] = xx[j - 1];
+            }
+            yy[3] = yy[2];
+            yy[2] = yy[1];
+            yy[1] = yy[0];
+            output[i] = yy[0] = result;
+        }
+        // avoid accumulating rounding errors:
+        controlA1 = targetA1;
+        controlK = targetK;
+    }
+}
+
 void IirMoogFilter::processNoteOn(int inputIndex, unsigned char, unsigned char noteNumber, unsigned char, jack_nframes_t time)
 {
     if (inputIndex == 1) {
         // set base cutoff frequency from note number:
         ParameterProcessor::setParameterValue(1, computeFrequencyFromMidiNoteNumber(noteNumber) * pow(2.0, getCutoffMidiNoteOffset() / 12.0), time);
+        // notes change the cutoff frequency immediately:
+        getParameterSmoother(1).finish();
     }
 }
 
@@ -151,49 +242,31 @@ double IirMoogFilter::getCutoffPitchBendModulation() const
 bool IirMoogFilter::computeCoefficients()
 {
     if (recomputeCoefficients) {
-        double cutoffFrequencyInHertz = getBaseCutoffFrequency() * pow(2.0, (getCutoffPitchBendModulationIntensity() * getCutoffPitchBendModulation() +  getCutoffControllerModulationIntensity() * getCutoffControllerModulation() + getCutoffAudioModulationIntensity() * getCutoffAudioModulation()) / 12.0);
+        double cutoffFrequencyInHertz = computeCutoffFrequency();
 
 //        // invert frequency:
 //        double cutoffFrequency = cutoffFrequencyInHertz * getSampleDuration();
 //        if (cutoffFrequency > 0.5) cutoffFrequency = 0.5;
 //        cutoffFrequencyInHertz = getSampleRate() * (0.5 - cutoffFrequency);
 
-        double resonance = getResonance() + getResonanceAudioModulation();
-        if (resonance < -1.0) {
-            resonance += 2.0;
-        } else if (resonance < 0.0) {
-            resonance = -resonance;
-        } else if (resonance > 2.0) {
-            resonance -= 2.0;
-        } else if (resonance > 1.0) {
-            resonance = 2.0 - resonance;
-        }
+        double resonance = foldResonance(getResonance() + getResonanceAudioModulation());
 
         double radians = convertHertzToRadians(cutoffFrequencyInHertz);
         if (radians > M_PI) {
             radians = M_PI;
         }
-        double s = sin(radians);
-        double c = cos(radians);
-        double t = tan((radians - M_PI) * 0.25);
-        double a1 = t / (s - c * t);
+        double a1, resonanceGain;
+        computeTableEntry(radians, a1, resonanceGain);
         double a2 = a1 * a1;
-        double g1Square_inv = 1.0 + a2 + 2.0 * a1 * c;
-        double k = resonance * g1Square_inv * g1Square_inv;
+        double k = resonance * resonanceGain;
         getFeedBackCoefficients()[0] = k + 4.0 * a1;
         getFeedBackCoefficients()[1] = 6.0 * a2;
         getFeedBackCoefficients()[2] = 4.0 * a2 * a1;
         getFeedBackCoefficients()[3] = a2 * a2;
 
-        int n = getFeedForwardCoefficients().size() - 1;
         double feedBackSum = 1.0 + getFeedBackCoefficients()[0] + getFeedBackCoefficients()[1] + getFeedBackCoefficients()[2] + getFeedBackCoefficients()[3];
-        int powerOfTwo = 1 << n;
-        double factor = 1.0 / powerOfTwo;
-        for (int k = 0; k < (n + 2) / 2; k++) {
-            getFeedForwardCoefficients()[k] = factor * IirFilter::computeBinomialCoefficient(n, k) * feedBackSum;
-        }
-        for (int k = (n + 2) / 2; k <= n; k++) {
-            getFeedForwardCoefficients()[k] = getFeedForwardCoefficients()[n - k];
+        for (int k = 0; k < feedForwardWeights.size(); k++) {
+            getFeedForwardCoefficients()[k] = feedForwardWeights[k] * feedBackSum;
         }
 
 //        invert();
@@ -204,3 +277,89 @@ bool IirMoogFilter::computeCoefficients()
         return false;
     }
 }
+
+void IirMoogFilter::setControlRate(int frames)
+{
+    controlRate = (frames < 1 ? 1 : frames);
+}
+
+int IirMoogFilter::getControlRate() const
+{
+    return controlRate;
+}
+
+void IirMoogFilter::computeFeedForwardWeights()
+{
+    // binomial coefficients, normalized such that the gain at the Nyquist frequency is one:
+    int n = getFeedForwardCoefficients().size() - 1;
+    int powerOfTwo = 1 << n;
+    double factor = 1.0 / powerOfTwo;
+    feedForwardWeights.resize(n + 1);
+    for (int k = 0; k < (n + 2) / 2; k++) {
+        feedForwardWeights[k] = factor * IirFilter::computeBinomialCoefficient(n, k);
+    }
+    for (int k = (n + 2) / 2; k <= n; k++) {
+        feedForwardWeights[k] = feedForwardWeights[n - k];
+    }
+}
+
+void IirMoogFilter::lookUpCoefficients(double &a1, double &k) const
+{
+    double position = convertHertzToRadians(computeCutoffFrequency()) * (COEFFICIENT_TABLE_SIZE / M_PI);
+    if (position > COEFFICIENT_TABLE_SIZE) {
+        position = COEFFICIENT_TABLE_SIZE;
+    } else if (position < 0) {
+        position = 0;
+    }
+    int index = (int)position;
+    if (index == COEFFICIENT_TABLE_SIZE) {
+        index--;
+    }
+    double fraction = position - index;
+    // interpolate linearly between the two nearest table entries:
+    const double *entry = coefficientTable.constData() + 2 * index;
+    a1 = entry[0] + fraction * (entry[2] - entry[0]);
+    double resonanceGain = entry[1] + fraction * (entry[3] - entry[1]);
+    k = foldResonance(getResonance() + getResonanceAudioModulation()) * resonanceGain;
+}
+
+double IirMoogFilter::computeCutoffFrequency() const
+{
+    // while the base cutoff frequency is ramping, its current value is used instead of its target:
+    const ParameterSmoother &cutoffSmoother = getParameterSmoother(1);
+    double baseCutoffFrequency = (cutoffSmoother.isSmoothing() ? cutoffSmoother.getValue() : getBaseCutoffFrequency());
+    return baseCutoffFrequency * pow(2.0, (getCutoffPitchBendModulationIntensity() * getCutoffPitchBendModulation() +  getCutoffControllerModulationIntensity() * getCutoffControllerModulation() + getCutoffAudioModulationIntensity() * getCutoffAudioModulation()) / 12.0);
+}
+
+double IirMoogFilter::foldResonance(double resonance)
+{
+    if (resonance < -1.0) {
+        return resonance + 2.0;
+    } else if (resonance < 0.0) {
+        return -resonance;
+    } else if (resonance > 2.0) {
+        return resonance - 2.0;
+    } else if (resonance > 1.0) {
+        return 2.0 - resonance;
+    }
+    return resonance;
+}
+
+void IirMoogFilter::computeTableEntry(double radians, double &a1, double &resonanceGain)
+{
+    double s = sin(radians);
+    double c = cos(radians);
+    double t = tan((radians - M_PI) * 0.25);
+    a1 = t / (s - c * t);
+    double g1Square_inv = 1.0 + a1 * a1 + 2.0 * a1 * c;
+    resonanceGain = g1Square_inv * g1Square_inv;
+}
+
+QVector<double> IirMoogFilter::createCoefficientTable()
+{
+    QVector<double> table(2 * (COEFFICIENT_TABLE_SIZE + 1));
+    for (int i = 0; i <= COEFFICIENT_TABLE_SIZE; i++) {
+        computeTableEntry(M_PI * i / COEFFICIENT_TABLE_SIZE, table[2 * i], table[2 * i + 1]);
+    }
+    return table;
+}
@@ -35,6 +35,7 @@ public:
 
     // reimplemented from IirFilter (originally from AudioProcessor):
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
     // reimplemented from MidiProcessor:
     virtual void processNoteOn(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time);
     virtual void processPitchBend(int inputIndex, unsigned char channel, unsigned int value, jack_nframes_t time);
@@ -53,8 +54,39 @@ public:
     double getResonanceAudioModulation() const;
 
     bool computeCoefficients();
+
+    /**
+      Sets the number of frames after which the block processing method
+      re-evaluates the cutoff and resonance modulation. In between, the
+      coefficients are interpolated linearly, and they are taken from a
+      precomputed table instead of being computed with trigonometric functions.
+
+      A control rate of 1 computes the exact coefficients for every frame,
+      which is much slower when the modulation inputs are connected.
+      The default is 16 frames.
+      */
+    void setControlRate(int frames);
+    int getControlRate() const;
 private:
+    enum {
+        COEFFICIENT_TABLE_SIZE = 4096
+    };
     bool recomputeCoefficients;
+    int controlRate;
+    // the interpolated coefficients of the block processing method:
+    bool controlCoefficientsValid;
+    double controlA1, controlK;
+    // the feed forward coefficients without the gain compensation:
+    QVector<double> feedForwardWeights;
+    // a1 and the resonance gain for COEFFICIENT_TABLE_SIZE + 1 cutoff frequencies between 0 and pi (interleaved):
+    static QVector<double> coefficientTable;
+
+    void computeFeedForwardWeights();
+    void lookUpCoefficients(double &a1, double &k) const;
+    double computeCutoffFrequency() const;
+    static double foldResonance(double resonance);
+    static void computeTableEntry(double radians, double &a1, double &resonanceGain);
+    static QVector<double> createCoefficientTable();
 };
 
 #endif // IIRMOOGFILTER_H
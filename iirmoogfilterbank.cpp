@@ -0,0 +1,126 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "iirmoogfilterbank.h"
+
+IirMoogFilterBank::IirMoogFilterBank(int voices) :
+    IirFilterBank(voices),
+    MidiParameterProcessor(QStringList(), QStringList()),
+    prototype(1)
+{
+    // resonance [0:1] of all voices (default is zero)
+    registerParameter("Resonance", 0, 0, 1, 0);
+    // cutoff frequency in Hertz of each voice
+    for (int voice = 0; voice < voices; voice++) {
+        registerParameter(QString("Cutoff frequency %1").arg(voice + 1), 440, 0, 0, 0);
+    }
+    computeCoefficients();
+}
+
+void IirMoogFilterBank::setSampleRate(double sampleRate)
+{
+    IirFilterBank::setSampleRate(sampleRate);
+    prototype.setSampleRate(sampleRate);
+    // adapt the maximum cutoff frequencies:
+    for (int voice = 0; voice < getNrOfVoices(); voice++) {
+        getParameter(2 + voice).max = 0.5 * sampleRate;
+    }
+    computeCoefficients();
+}
+
+bool IirMoogFilterBank::setParameterValue(int index, double value, double min, double max, unsigned int time)
+{
+    if (MidiParameterProcessor::setParameterValue(index, value, min, max, time)) {
+        if (index == 1) {
+            computeCoefficients();
+        } else if (index >= 2) {
+            computeCoefficients(index - 2);
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void IirMoogFilterBank::computeCoefficients()
+{
+    for (int voice = 0; voice < getNrOfVoices(); voice++) {
+        computeCoefficients(voice);
+    }
+}
+
+void IirMoogFilterBank::computeCoefficients(int voice)
+{
+    prototype.ParameterProcessor::setParameterValue(1, getParameter(2 + voice).value, 0);
+    prototype.ParameterProcessor::setParameterValue(2, getParameter(1).value, 0);
+    prototype.computeCoefficients();
+    setFilter(voice, prototype);
+}
+
+IirMoogFilterBankClient::IirMoogFilterBankClient(const QString &clientName, IirMoogFilterBank *processFilter_, IirMoogFilterBank *guiFilter_, size_t ringBufferSize) :
+    ParameterClient(clientName, processFilter_, processFilter_, 0, processFilter_, guiFilter_, ringBufferSize),
+    processFilter(processFilter_),
+    guiFilter(guiFilter_)
+{
+}
+
+IirMoogFilterBankClient::~IirMoogFilterBankClient()
+{
+    // calling close will stop the Jack client:
+    close();
+    // deleting the filter is now safe, as it is not used anymore (the Jack process thread is stopped):
+    delete processFilter;
+    delete guiFilter;
+}
+
+bool IirMoogFilterBankClient::init()
+{
+    if (ParameterClient::init()) {
+        // adjust the guiFilter's samplerate to that of the processFilter:
+        guiFilter->setSampleRate(processFilter->getSampleRate());
+        return true;
+    } else {
+        return false;
+    }
+}
+
+class IirMoogFilterBankClientFactory : public JackClientFactory
+{
+public:
+    IirMoogFilterBankClientFactory()
+    {
+        JackClientSerializer::getInstance()->registerFactory(this);
+    }
+    QString getName()
+    {
+        return "Filter bank (low-pass, 8 voices)";
+    }
+    JackClient * createClient(const QString &clientName)
+    {
+        return new IirMoogFilterBankClient(clientName, new IirMoogFilterBank(8), new IirMoogFilterBank(8));
+    }
+    static IirMoogFilterBankClientFactory factory;
+};
+
+IirMoogFilterBankClientFactory IirMoogFilterBankClientFactory::factory;
+
+JackClientFactory * IirMoogFilterBankClient::getFactory()
+{
+    return &IirMoogFilterBankClientFactory::factory;
+}
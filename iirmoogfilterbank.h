@@ -0,0 +1,62 @@
+#ifndef IIRMOOGFILTERBANK_H
+#define IIRMOOGFILTERBANK_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "iirfilterbank.h"
+#include "iirmoogfilter.h"
+#include "midiparameterprocessor.h"
+#include "parameterclient.h"
+
+/**
+  A bank of Moog low-pass filters with a common resonance and an individual
+  cutoff frequency for each voice.
+  */
+class IirMoogFilterBank : public IirFilterBank, public MidiParameterProcessor
+{
+public:
+    IirMoogFilterBank(int voices = 8);
+
+    // reimplemented from AudioProcessor:
+    virtual void setSampleRate(double sampleRate);
+    // reimplemented from MidiParameterProcessor:
+    virtual bool setParameterValue(int index, double value, double min, double max, unsigned int time);
+private:
+    // computes the coefficients of each voice:
+    IirMoogFilter prototype;
+
+    void computeCoefficients();
+    void computeCoefficients(int voice);
+};
+
+class IirMoogFilterBankClient : public ParameterClient
+{
+public:
+    IirMoogFilterBankClient(const QString &clientName, IirMoogFilterBank *processFilter, IirMoogFilterBank *guiFilter, size_t ringBufferSize = 1024);
+    virtual ~IirMoogFilterBankClient();
+    virtual JackClientFactory * getFactory();
+protected:
+    // reimplemented from ParameterClient:
+    virtual bool init();
+private:
+    IirMoogFilterBank *processFilter, *guiFilter;
+};
+
+#endif // IIRMOOGFILTERBANK_H
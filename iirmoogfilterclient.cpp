@@ -24,6 +24,8 @@ IirMoogFilterClient::IirMoogFilterClient(const QString &clientName, IirMoogFilte
     processFilter(processFilter_),
     guiFilter(guiFilter_)
 {
+    // glide to a new base cutoff frequency instead of jumping to it:
+    setParameterSmoothing(1, ParameterSmoother::EXPONENTIAL_SMOOTHING, 0.005);
 }
 
 IirMoogFilterClient::~IirMoogFilterClient()
@@ -203,6 +203,27 @@ void Interpolator::processInterpolatorEvent(const InterpolatorEvent *event)
     }
 }
 
+bool Interpolator::processInterpolatorEvent(const RingBufferInlineEvent &event)
+{
+    switch (event.getTag()) {
+    case INTERPOLATOR_CHANGE_CONTROL_POINT: {
+        const ChangeControlPoint &change = event.get<ChangeControlPoint>();
+        changeControlPoint(change.index, change.x, change.y);
+        return true;
+    }
+    case INTERPOLATOR_ADD_CONTROL_POINT: {
+        const AddControlPoint &add = event.get<AddControlPoint>();
+        addControlPoint(add.x, add.y);
+        return true;
+    }
+    case INTERPOLATOR_DELETE_CONTROL_POINT:
+        deleteControlPoint(event.get<DeleteControlPoint>().index);
+        return true;
+    default:
+        return false;
+    }
+}
+
 
 void Interpolator::setMonotonicity(bool isStrictlyMonotonic)
 {
@@ -71,6 +71,24 @@ public:
         {}
         int index;
     };
+    /**
+      The same changes as the events above, to be sent by value
+      (see RingBufferInlineEvent), which avoids allocating an event
+      object for each of them.
+      */
+    struct ChangeControlPoint {
+        enum { TAG = INTERPOLATOR_CHANGE_CONTROL_POINT };
+        int index;
+        double x, y;
+    };
+    struct AddControlPoint {
+        enum { TAG = INTERPOLATOR_ADD_CONTROL_POINT };
+        double x, y;
+    };
+    struct DeleteControlPoint {
+        enum { TAG = INTERPOLATOR_DELETE_CONTROL_POINT };
+        int index;
+    };
 
     virtual ~Interpolator();
 
@@ -111,6 +129,13 @@ public:
     virtual void load(QDataStream &stream);
     virtual void changeControlPoints(const QVector<double> &xx, const QVector<double> &yy);
     virtual void processInterpolatorEvent(const InterpolatorEvent *event);
+    /**
+      Applies a change sent by value.
+
+      @return true if the event is one of the inline interpolator events
+        above, false otherwise
+      */
+    bool processInterpolatorEvent(const RingBufferInlineEvent &event);
 protected:
     Interpolator(const QVector<double> &xx, const QVector<double> &yy, int m);
 
@@ -19,6 +19,7 @@
 
 #include "jackclient.h"
 #include "graphicsclientitemsclient.h"
+#include "metajack/recursivejackcontext.h"
 #include <QSet>
 #include <QRegExp>
 
@@ -331,6 +332,19 @@ jack_nframes_t JackClient::getSampleRate() const
     return jack_get_sample_rate(client);
 }
 
+void JackClient::setSilenceTail(jack_nframes_t silenceTail)
+{
+    Q_ASSERT(client);
+    RecursiveJackContext::getInstance()->setClientSilenceTail(client, silenceTail);
+}
+
+void JackClient::wake()
+{
+    if (client) {
+        RecursiveJackContext::getInstance()->wakeClient(client);
+    }
+}
+
 jack_port_t * JackClient::registerAudioPort(const QString &name, unsigned long flags)
 {
     return jack_port_register(client, name.toAscii().data(), JACK_DEFAULT_AUDIO_TYPE, flags, 0);
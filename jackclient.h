@@ -306,6 +306,26 @@ protected:
       @return the sample rate of the Jack server in Hertz
       */
     jack_nframes_t getSampleRate() const;
+    /**
+      Lets the process callback be skipped while this client is idle, i.e.
+      once its inputs have been silent for the given number of frames and its
+      outputs have become silent as well. Its output ports are then cleared
+      instead. Clients which generate sound by themselves must not call this.
+
+      This has no effect unless the client runs within a MetaJackContext.
+
+      @param silenceTail the number of frames the outputs may still sound
+        after the inputs became silent, or JACK_MAX_FRAMES to always process
+      */
+    void setSilenceTail(jack_nframes_t silenceTail);
+    /**
+      Makes sure the process callback is called in the next cycles, even if
+      the client is idle (see setSilenceTail()). Call this when something other
+      than the input ports changed, e.g. a parameter or an event was sent to
+      the process thread. This can be called from any thread except the jack
+      process thread.
+      */
+    void wake();
     /**
       Creates an audio port with a given name.
 
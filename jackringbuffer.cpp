@@ -22,7 +22,7 @@
 
 RingBuffer::RingBuffer(size_t ringBufferSize)
 {
-    ringBuffer = jack_ringbuffer_create(ringBufferSize * (sizeof(jack_nframes_t) + sizeof(RingBufferEvent*)));
+    ringBuffer = jack_ringbuffer_create(ringBufferSize * sizeof(Slot));
     ringBufferReturn = jack_ringbuffer_create(ringBufferSize * sizeof(RingBufferEvent*));
 }
 
@@ -52,36 +52,38 @@ jack_nframes_t RingBuffer::peekEventTime()
 
 bool RingBuffer::sendEvent(RingBufferEvent *event, jack_nframes_t time)
 {
-    // first delete all event objects in the "return" ring buffer:
-    for (; jack_ringbuffer_read_space(ringBufferReturn); ) {
-        RingBufferEvent *event;
-        jack_ringbuffer_read(ringBufferReturn, (char*)&event, sizeof(RingBufferEvent*));
-        undeletedEvents.remove(event);
-        delete event;
-    }
-    if (sizeof(jack_nframes_t) + sizeof(RingBufferEvent*) + sizeof(size_t) <= jack_ringbuffer_write_space(ringBuffer)) {
+    if (sendEvent(RingBufferInlineEvent(event), time)) {
         undeletedEvents.insert(event);
-        // write the event time:
-        jack_ringbuffer_write(ringBuffer, (const char*)&time, sizeof(jack_nframes_t));
-        // write a pointer to event object:
-        jack_ringbuffer_write(ringBuffer, (const char*)&event, sizeof(RingBufferEvent*));
         return true;
     } else {
         return false;
     }
 }
 
-RingBufferEvent * RingBuffer::readEvent(jack_nframes_t &time)
+bool RingBuffer::sendEvent(const RingBufferInlineEvent &event, jack_nframes_t time)
+{
+    // first delete all event objects in the "return" ring buffer:
+    deleteReturnedEvents();
+    if (sizeof(Slot) <= jack_ringbuffer_write_space(ringBuffer)) {
+        Slot slot;
+        slot.time = time;
+        slot.event = event;
+        jack_ringbuffer_write(ringBuffer, (const char*)&slot, sizeof(Slot));
+        return true;
+    } else {
+        return false;
+    }
+}
+
+RingBufferInlineEvent RingBuffer::readEvent(jack_nframes_t &time)
 {
-    // read the event time:
-    jack_ringbuffer_read(ringBuffer, (char*)&time, sizeof(jack_nframes_t));
-    // read the event object pointer from the ring buffer:
-    RingBufferEvent *event;
-    jack_ringbuffer_read(ringBuffer, (char*)&event, sizeof(RingBufferEvent*));
-    return event;
+    Slot slot;
+    jack_ringbuffer_read(ringBuffer, (char*)&slot, sizeof(Slot));
+    time = slot.time;
+    return slot.event;
 }
 
-RingBufferEvent * RingBuffer::readEvent()
+RingBufferInlineEvent RingBuffer::readEvent()
 {
     jack_nframes_t time;
     return readEvent(time);
@@ -92,3 +94,13 @@ void RingBuffer::returnEvent(RingBufferEvent *event)
     // write a pointer to the "return" ring buffer to be deleted with the next call to write():
     jack_ringbuffer_write(ringBufferReturn, (const char*)&event, sizeof(RingBufferEvent*));
 }
+
+void RingBuffer::deleteReturnedEvents()
+{
+    for (; jack_ringbuffer_read_space(ringBufferReturn); ) {
+        RingBufferEvent *event;
+        jack_ringbuffer_read(ringBufferReturn, (char*)&event, sizeof(RingBufferEvent*));
+        undeletedEvents.remove(event);
+        delete event;
+    }
+}
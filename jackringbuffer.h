@@ -24,6 +24,8 @@
 #include <QDataStream>
 #include <QByteArray>
 #include <QSet>
+#include <QtGlobal>
+#include <cstring>
 #include <jack/ringbuffer.h>
 #include <jack/types.h>
 
@@ -177,6 +179,82 @@ public:
     virtual ~RingBufferEvent() {}
 };
 
+/**
+  The tags identifying the types of events which are sent by value
+  through a RingBuffer (see RingBufferInlineEvent). Add a tag here for
+  every new inline event type.
+  */
+enum RingBufferEventTag {
+    // a RingBufferEvent object sent by pointer:
+    RING_BUFFER_EVENT_OBJECT,
+    INTERPOLATOR_CHANGE_CONTROL_POINT,
+    INTERPOLATOR_ADD_CONTROL_POINT,
+    INTERPOLATOR_DELETE_CONTROL_POINT
+};
+
+/**
+  An event as it is stored in a RingBuffer: a tag identifying its type
+  and a payload of limited size, which is copied by value. Sending such
+  events does not involve any memory allocation.
+
+  An inline event type is a plain struct without constructors, destructor
+  or virtual methods (i.e., it can be copied bytewise), which defines its
+  tag as an enum value TAG, e.g.:
+
+  struct ChangeSomething {
+      enum { TAG = CHANGE_SOMETHING };
+      int index;
+      double value;
+  };
+
+  The receiver dispatches on getTag() and gets the payload with get<T>().
+
+  For compatibility, objects of RingBufferEvent subclasses can still be
+  sent by pointer, their tag is RING_BUFFER_EVENT_OBJECT.
+  */
+class RingBufferInlineEvent
+{
+public:
+    enum {
+        MAX_PAYLOAD_SIZE = 24
+    };
+
+    explicit RingBufferInlineEvent(RingBufferEvent *object = 0) :
+        tag(RING_BUFFER_EVENT_OBJECT)
+    {
+        payload.object = object;
+    }
+    template<class T> explicit RingBufferInlineEvent(const T &payload_) :
+        tag(T::TAG)
+    {
+        // this does not compile if the payload is too large:
+        (void)sizeof(char[sizeof(T) <= MAX_PAYLOAD_SIZE ? 1 : -1]);
+        memcpy(payload.data, &payload_, sizeof(T));
+    }
+
+    int getTag() const
+    {
+        return tag;
+    }
+    template<class T> const T & get() const
+    {
+        Q_ASSERT(tag == T::TAG);
+        return *reinterpret_cast<const T*>(payload.data);
+    }
+    RingBufferEvent * getObject() const
+    {
+        Q_ASSERT(tag == RING_BUFFER_EVENT_OBJECT);
+        return payload.object;
+    }
+private:
+    qint32 tag;
+    union {
+        char data[MAX_PAYLOAD_SIZE];
+        double alignment;
+        RingBufferEvent *object;
+    } payload;
+};
+
 /**
   This class enables lock-free communication between two threads, one
   "sender" thread and one "receiver" thread.
@@ -213,6 +291,11 @@ public:
   communication between a Jack process thread (as sender) and another
   thread, because there is memory allocation (object creation) and
   deletion involved, which would happen in the Jack process thread.
+
+  Events which fit into a RingBufferInlineEvent can instead be sent by
+  value with sendEvent(const RingBufferInlineEvent &, jack_nframes_t).
+  They are stored in the ring buffer itself, i.e. the ring buffer is a
+  fixed-capacity pool for them, and they need not be returned.
   */
 class RingBuffer
 {
@@ -220,7 +303,8 @@ public:
     /**
       Initializes the ring buffer with the given size.
 
-      @param ringBufferSize specifies the maximum number of events
+      @param ringBufferSize specifies the maximum number of events (sent
+        by value or by pointer)
         that can be in the ring buffer at the same time. I.e., the maximum
         number of events that can be sent via sendEvent() without any of
         them being retrieved via readEvent()
@@ -279,32 +363,40 @@ public:
         solely on what the sender and receiver define and agree upon
       */
     bool sendEvent(RingBufferEvent *event, jack_nframes_t time);
+    /**
+      Copies an event into the ring buffer. This method is meant to be
+      called by the sender thread. It does not allocate memory.
+
+      @return false if the ring buffer is full
+      */
+    bool sendEvent(const RingBufferInlineEvent &event, jack_nframes_t time);
     /**
       Reads and returns an event from the ring buffer. Call hasEvents()
       before to make sure that there really is an event in the buffer.
 
       This method is meant to be called by the receiver.
       The returned event will be removed from the ring buffer.
-      Call returnEvent() after you have processed the event to make sure
+      If it carries an event object (i.e. its tag is RING_BUFFER_EVENT_OBJECT),
+      call returnEvent() after you have processed the object to make sure
       that it is deleted properly.
 
       @param time a reference to where the event's time will be stored by
         this method
-      @return a pointer to the first event in the buffer
+      @return the first event in the buffer
       */
-    RingBufferEvent * readEvent(jack_nframes_t &time);
+    RingBufferInlineEvent readEvent(jack_nframes_t &time);
     /**
       This is an overloaded function which can be used when the time
       associated with an event is not relevant to the receiver.
 
       See readEvent(jack_nframes_t &) for further information.
 
-      @return a pointer to the first event in the buffer
+      @return the first event in the buffer
       */
-    RingBufferEvent * readEvent();
+    RingBufferInlineEvent readEvent();
     /**
       This method is meant to be called by the receiver after
-      it has processed an event read from the buffer and doesn't
+      it has processed an event object read from the buffer and doesn't
       need access to it anymore.
 
       The given event will be deleted during the next call to sendEvent()
@@ -315,8 +407,14 @@ public:
       */
     void returnEvent(RingBufferEvent *event);
 private:
+    struct Slot {
+        jack_nframes_t time;
+        RingBufferInlineEvent event;
+    };
     jack_ringbuffer_t *ringBuffer, *ringBufferReturn;
     QSet<RingBufferEvent*> undeletedEvents;
+
+    void deleteReturnedEvents();
 };
 
 #endif // JACKRINGBUFFER_H
@@ -23,7 +23,8 @@
 #include <QtGlobal>
 
 LinearWaveShaper::LinearWaveShaper() :
-    AudioProcessor(QStringList("Audio in"), QStringList("Audio out"))
+    AudioProcessor(QStringList("Audio in"), QStringList("Audio out")),
+    compiledInterpolator(new CompiledInterpolator())
 {
     QVector<double> xx, yy;
     xx.append(-1);
@@ -36,6 +37,11 @@ LinearWaveShaper::LinearWaveShaper() :
     registerParameter("Y steps", 0, 0, 12, 1);
 }
 
+LinearWaveShaper::~LinearWaveShaper()
+{
+    delete compiledInterpolator;
+}
+
 void LinearWaveShaper::addControlPoint(double x, double y)
 {
     double xSteps = getParameter(0).value;
@@ -66,9 +72,24 @@ void LinearWaveShaper::changeControlPoint(int index, double x, double y)
     LinearInterpolator::changeControlPoint(index, x, y);
 }
 
+void LinearWaveShaper::compile()
+{
+    compiledInterpolator->compile(*this);
+}
+
+const CompiledInterpolator & LinearWaveShaper::getCompiledInterpolator() const
+{
+    return *compiledInterpolator;
+}
+
 void LinearWaveShaper::processAudio(const double *inputs, double *outputs, jack_nframes_t)
 {
-    outputs[0] = evaluate(inputs[0]);
+    outputs[0] = compiledInterpolator->evaluate(inputs[0]);
+}
+
+void LinearWaveShaper::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    compiledInterpolator->evaluate(inputs[0] + start, outputs[0] + start, end - start);
 }
 
 bool LinearWaveShaper::processEvent(const RingBufferEvent *event, jack_nframes_t)
@@ -76,11 +97,21 @@ bool LinearWaveShaper::processEvent(const RingBufferEvent *event, jack_nframes_t
     if (const Interpolator::InterpolatorEvent *event_ = dynamic_cast<const Interpolator::InterpolatorEvent*>(event)) {
         processInterpolatorEvent(event_);
         return true;
+    } else if (const CompiledInterpolator::ChangeEvent *event_ = dynamic_cast<const CompiledInterpolator::ChangeEvent*>(event)) {
+        // swap in the curve compiled in the GUI thread, the previous one is deleted with the event:
+        event_->swap(compiledInterpolator);
+        return true;
     } else {
         return false;
     }
 }
 
+void LinearWaveShaper::controlPointsChanged()
+{
+    LinearInterpolator::controlPointsChanged();
+    compile();
+}
+
 LinearWaveShapingClient::LinearWaveShapingClient(const QString &clientName, LinearWaveShaper *processWaveShaper_, LinearWaveShaper * guiWaveShaper_, size_t ringBufferSize) :
     ParameterClient(clientName, processWaveShaper_, 0, processWaveShaper_, processWaveShaper_, guiWaveShaper_, ringBufferSize),
     processWaveShaper(processWaveShaper_),
@@ -144,22 +175,19 @@ QPointF LinearWaveShapingClient::getControlPoint(int index)
 void LinearWaveShapingClient::changeControlPoint(int index, double x, double y)
 {
     guiWaveShaper->changeControlPoint(index, x, y);
-    Interpolator::ChangeControlPointEvent *event = new Interpolator::ChangeControlPointEvent(index, x, y);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 void LinearWaveShapingClient::addControlPoint(double x, double y)
 {
     guiWaveShaper->addControlPoint(x, y);
-    Interpolator::AddControlPointEvent *event = new Interpolator::AddControlPointEvent(x, y);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 void LinearWaveShapingClient::deleteControlPoint(int index)
 {
     guiWaveShaper->deleteControlPoint(index);
-    Interpolator::DeleteControlPointEvent *event = new Interpolator::DeleteControlPointEvent(index);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 QString LinearWaveShapingClient::getControlPointName(int index) const
@@ -167,6 +195,12 @@ QString LinearWaveShapingClient::getControlPointName(int index) const
     return guiWaveShaper->getControlPointName(index);
 }
 
+void LinearWaveShapingClient::postCompiledInterpolator()
+{
+    // the process thread only swaps in the compiled curve, so that it does not have to recompile it:
+    postEvent(new CompiledInterpolator::ChangeEvent(guiWaveShaper->getCompiledInterpolator()));
+}
+
 void LinearWaveShapingClient::onChangedParameterValue(int index, double value, double min, double max)
 {
     if (index == 0) {
@@ -23,18 +23,35 @@
 #include "linearinterpolator.h"
 #include "parameterclient.h"
 #include "graphicsinterpolatoredititem.h"
+#include "compiledinterpolator.h"
 
 class LinearWaveShaper : public AudioProcessor, public EventProcessor, public ParameterProcessor, public LinearInterpolator
 {
 public:
     LinearWaveShaper();
+    virtual ~LinearWaveShaper();
     // reimplemented from Interpolator; change the behaviour when adding/changing control points:
     virtual void addControlPoint(double x, double y);
     virtual void changeControlPoint(int index, double x, double y);
+    /**
+      Rebuilds the compiled interpolator from the current control points.
+      */
+    void compile();
+    /**
+      @return the compiled form of this interpolator, which is used for
+        processing audio
+      */
+    const CompiledInterpolator & getCompiledInterpolator() const;
     // reimplemented from AudioProcessor:
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
     // reimplemented from EventProcessor:
     virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
+protected:
+    // reimplemented from Interpolator:
+    virtual void controlPointsChanged();
+private:
+    CompiledInterpolator *compiledInterpolator;
 };
 
 class LinearWaveShapingClient : public ParameterClient, public AbstractInterpolator
@@ -74,6 +91,8 @@ protected:
     virtual void onChangedParameterValue(int index, double value, double min, double max);
 private:
     LinearWaveShaper *processWaveShaper, *guiWaveShaper;
+
+    void postCompiledInterpolator();
 };
 
 #endif // LINEARWAVESHAPINGCLIENT_H
@@ -7,7 +7,8 @@
 
 LogarithmicWaveShaper::LogarithmicWaveShaper() :
     AudioProcessor(QStringList("Audio in"), QStringList("Audio out")),
-    LogarithmicInterpolator(1)
+    LogarithmicInterpolator(1),
+    compiledInterpolator(new CompiledInterpolator())
 {
     QVector<double> xx, yy;
     xx.append(-1);
@@ -21,6 +22,11 @@ LogarithmicWaveShaper::LogarithmicWaveShaper() :
     registerParameter("Y steps", 0, 0, 12, 1);
 }
 
+LogarithmicWaveShaper::~LogarithmicWaveShaper()
+{
+    delete compiledInterpolator;
+}
+
 void LogarithmicWaveShaper::addControlPoint(double x, double y)
 {
     double xSteps = getParameter(1).value;
@@ -51,9 +57,24 @@ void LogarithmicWaveShaper::changeControlPoint(int index, double x, double y)
     LogarithmicInterpolator::changeControlPoint(index, x, y);
 }
 
+void LogarithmicWaveShaper::compile()
+{
+    compiledInterpolator->compile(*this);
+}
+
+const CompiledInterpolator & LogarithmicWaveShaper::getCompiledInterpolator() const
+{
+    return *compiledInterpolator;
+}
+
 void LogarithmicWaveShaper::processAudio(const double *inputs, double *outputs, jack_nframes_t)
 {
-    outputs[0] = evaluate(inputs[0]);
+    outputs[0] = compiledInterpolator->evaluate(inputs[0]);
+}
+
+void LogarithmicWaveShaper::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    compiledInterpolator->evaluate(inputs[0] + start, outputs[0] + start, end - start);
 }
 
 bool LogarithmicWaveShaper::processEvent(const RingBufferEvent *event, jack_nframes_t)
@@ -61,6 +82,10 @@ bool LogarithmicWaveShaper::processEvent(const RingBufferEvent *event, jack_nfra
     if (const Interpolator::InterpolatorEvent *event_ = dynamic_cast<const Interpolator::InterpolatorEvent*>(event)) {
         processInterpolatorEvent(event_);
         return true;
+    } else if (const CompiledInterpolator::ChangeEvent *event_ = dynamic_cast<const CompiledInterpolator::ChangeEvent*>(event)) {
+        // swap in the curve compiled in the GUI thread, the previous one is deleted with the event:
+        event_->swap(compiledInterpolator);
+        return true;
     } else {
         return false;
     }
@@ -71,7 +96,7 @@ bool LogarithmicWaveShaper::setParameterValue(int index, double value, double mi
     if (ParameterProcessor::setParameterValue(index, value, min, max, time)) {
         const ParameterProcessor::Parameter &parameter = getParameter(index);
         if (index == 0) {
-            // slope:
+            // slope (the client recompiles the curve in the GUI thread and sends it to the process thread):
             LogarithmicInterpolator::setBase(pow(1000.0, parameter.value));
         }
         return true;
@@ -80,11 +105,19 @@ bool LogarithmicWaveShaper::setParameterValue(int index, double value, double mi
     }
 }
 
+void LogarithmicWaveShaper::controlPointsChanged()
+{
+    LogarithmicInterpolator::controlPointsChanged();
+    compile();
+}
+
 LogarithmicWaveShapingClient::LogarithmicWaveShapingClient(const QString &clientName, LogarithmicWaveShaper *processWaveShaper_, LogarithmicWaveShaper * guiWaveShaper_, size_t ringBufferSize) :
     ParameterClient(clientName, processWaveShaper_, 0, processWaveShaper_, processWaveShaper_, guiWaveShaper_, ringBufferSize),
     processWaveShaper(processWaveShaper_),
     guiWaveShaper(guiWaveShaper_)
 {
+    // parameter changes from both the GUI and the process thread arrive here:
+    QObject::connect(this, SIGNAL(changedParameterValue(int,double,double,double)), this, SLOT(onChangedSlope(int)));
 }
 
 LogarithmicWaveShapingClient::~LogarithmicWaveShapingClient()
@@ -144,22 +177,19 @@ QPointF LogarithmicWaveShapingClient::getControlPoint(int index)
 void LogarithmicWaveShapingClient::changeControlPoint(int index, double x, double y)
 {
     guiWaveShaper->changeControlPoint(index, x, y);
-    Interpolator::ChangeControlPointEvent *event = new Interpolator::ChangeControlPointEvent(index, x, y);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 void LogarithmicWaveShapingClient::addControlPoint(double x, double y)
 {
     guiWaveShaper->addControlPoint(x, y);
-    Interpolator::AddControlPointEvent *event = new Interpolator::AddControlPointEvent(x, y);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 void LogarithmicWaveShapingClient::deleteControlPoint(int index)
 {
     guiWaveShaper->deleteControlPoint(index);
-    Interpolator::DeleteControlPointEvent *event = new Interpolator::DeleteControlPointEvent(index);
-    postEvent(event);
+    postCompiledInterpolator();
 }
 
 QString LogarithmicWaveShapingClient::getControlPointName(int index) const
@@ -167,6 +197,20 @@ QString LogarithmicWaveShapingClient::getControlPointName(int index) const
     return guiWaveShaper->getControlPointName(index);
 }
 
+void LogarithmicWaveShapingClient::postCompiledInterpolator()
+{
+    // the process thread only swaps in the compiled curve, so that it does not have to recompile it:
+    postEvent(new CompiledInterpolator::ChangeEvent(guiWaveShaper->getCompiledInterpolator()));
+}
+
+void LogarithmicWaveShapingClient::onChangedSlope(int index)
+{
+    if (index == 0) {
+        guiWaveShaper->compile();
+        postCompiledInterpolator();
+    }
+}
+
 void LogarithmicWaveShapingClient::onChangedParameterValue(int index, double value, double min, double max)
 {
     if (index == 1) {
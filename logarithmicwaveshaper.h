@@ -23,20 +23,37 @@
 #include "logarithmicinterpolator.h"
 #include "parameterclient.h"
 #include "graphicsinterpolatoredititem.h"
+#include "compiledinterpolator.h"
 
 class LogarithmicWaveShaper : public AudioProcessor, public EventProcessor, public ParameterProcessor, public LogarithmicInterpolator
 {
 public:
     LogarithmicWaveShaper();
+    virtual ~LogarithmicWaveShaper();
     // Reimplemented from Interpolator; change the behaviour when adding/changing control points:
     virtual void addControlPoint(double x, double y);
     virtual void changeControlPoint(int index, double x, double y);
+    /**
+      Rebuilds the compiled interpolator from the current control points.
+      */
+    void compile();
+    /**
+      @return the compiled form of this interpolator, which is used for
+        processing audio
+      */
+    const CompiledInterpolator & getCompiledInterpolator() const;
     // Reimplemented from AudioProcessor:
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
     // Reimplemented from EventProcessor:
     virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
     // Reimplemented from ParameterProcessor:
     virtual bool setParameterValue(int index, double value, double min, double max, unsigned int time);
+protected:
+    // Reimplemented from Interpolator:
+    virtual void controlPointsChanged();
+private:
+    CompiledInterpolator *compiledInterpolator;
 };
 
 class LogarithmicWaveShapingClient : public ParameterClient, public AbstractInterpolator
@@ -74,8 +91,12 @@ signals:
 protected:
     // Reimplemented from ParameterClient:
     virtual void onChangedParameterValue(int index, double value, double min, double max);
+private slots:
+    void onChangedSlope(int index);
 private:
     LogarithmicWaveShaper *processWaveShaper, *guiWaveShaper;
+
+    void postCompiledInterpolator();
 };
 
 #endif // LOGARITHMICWAVESHAPER_H
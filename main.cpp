@@ -18,10 +18,87 @@
  */
 
 #include <QtGui/QApplication>
+#include <QStringList>
+#include <cstdio>
 #include "mainwindow.h"
+#include "offlinerenderer.h"
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "usage: elektrocillin --render SESSION [options]\n"
+            "Renders SESSION faster than realtime without a Jack server. The session's\n"
+            "first system_in MIDI port is fed from the MIDI file, the audio sent to its\n"
+            "system_out ports is written to the output file.\n"
+            "  --midi FILE          Standard MIDI File to play\n"
+            "  --output FILE        output file (default: SESSION.wav)\n"
+            "  --raw                write raw interleaved 32 bit floats instead of WAVE\n"
+            "  --length SECONDS     duration to render (default: length of the MIDI file)\n"
+            "  --tail SECONDS       duration to render in addition (default: 0)\n"
+            "  --sample-rate RATE   sample rate (default: 44100)\n"
+            "  --buffer-size FRAMES frames per process cycle (default: 1024)\n"
+            "  --threads COUNT      threads processing the session (default: 1)\n");
+}
+
+static int render(const QStringList &arguments)
+{
+    QString sessionFileName, midiFileName, outputFileName;
+    OfflineRenderer::OutputFormat format = OfflineRenderer::WAVE;
+    double length = 0, tail = 0;
+    unsigned int sampleRate = 44100, bufferSize = 1024, threadCount = 1;
+    bool ok = true;
+    for (int i = 1; ok && (i < arguments.size()); i++) {
+        QString argument = arguments[i];
+        if (argument == "--raw") {
+            format = OfflineRenderer::RAW_FLOAT;
+        } else if (i + 1 >= arguments.size()) {
+            ok = false;
+        } else if (argument == "--render") {
+            sessionFileName = arguments[++i];
+        } else if (argument == "--midi") {
+            midiFileName = arguments[++i];
+        } else if (argument == "--output") {
+            outputFileName = arguments[++i];
+        } else if (argument == "--length") {
+            length = arguments[++i].toDouble(&ok);
+        } else if (argument == "--tail") {
+            tail = arguments[++i].toDouble(&ok);
+        } else if (argument == "--sample-rate") {
+            sampleRate = arguments[++i].toUInt(&ok);
+        } else if (argument == "--buffer-size") {
+            bufferSize = arguments[++i].toUInt(&ok);
+        } else if (argument == "--threads") {
+            threadCount = arguments[++i].toUInt(&ok);
+        } else {
+            ok = false;
+        }
+    }
+    if (!ok || sessionFileName.isEmpty() || !sampleRate || !bufferSize || !threadCount) {
+        printUsage();
+        return 2;
+    }
+    if (outputFileName.isEmpty()) {
+        outputFileName = sessionFileName + (format == OfflineRenderer::WAVE ? ".wav" : ".raw");
+    }
+    OfflineRenderer renderer(sampleRate, bufferSize, threadCount);
+    if (!renderer.loadSession(sessionFileName) || (!midiFileName.isEmpty() && !renderer.loadMidiFile(midiFileName)) || !renderer.render(outputFileName, format, length, tail)) {
+        fprintf(stderr, "%s\n", renderer.getErrorString().toLocal8Bit().constData());
+        return 1;
+    }
+    double renderedTime = (double)renderer.getRenderedFrameCount() / sampleRate;
+    fprintf(stderr, "Rendered %.3f s (%d channels) in %.3f s to %s\n", renderedTime, renderer.getOutputChannelCount(), renderer.getRenderTime(), outputFileName.toLocal8Bit().constData());
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    // render without GUI if requested:
+    for (int i = 1; i < argc; i++) {
+        if (QString(argv[i]) == "--render") {
+            QApplication a(argc, argv, false);
+            return render(a.arguments());
+        }
+    }
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
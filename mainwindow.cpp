@@ -25,6 +25,8 @@
 #include <QDebug>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QActionGroup>
+#include <QThread>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -39,6 +41,18 @@ MainWindow::MainWindow(QWidget *parent) :
         ui->menuNew_module->addAction(factory->getName(), this, SLOT(onActionCreateClient()));
     }
 
+    // macros process their modules with the number of threads chosen last time:
+    unsigned int threadCount = settings.value("threadCount", 1).toUInt();
+    RecursiveJackContext::getInstance()->setThreadCount(threadCount);
+    QActionGroup *threadCountGroup = new QActionGroup(this);
+    for (int i = 1; i <= qMax(QThread::idealThreadCount(), 1); i++) {
+        QAction *action = ui->menuThreads->addAction(QString::number(i), this, SLOT(onActionThreadCount()));
+        action->setCheckable(true);
+        action->setChecked((unsigned int)i == threadCount);
+        action->setData(i);
+        threadCountGroup->addAction(action);
+    }
+
     scene = new JackContextGraphicsScene();
     QObject::connect(ui->actionPlay, SIGNAL(triggered()), scene, SLOT(play()));
     QObject::connect(ui->actionStop, SIGNAL(triggered()), scene, SLOT(stop()));
@@ -66,6 +80,13 @@ void MainWindow::onActionCreateClient()
     scene->createNewModule(((QAction*)sender())->text());
 }
 
+void MainWindow::onActionThreadCount()
+{
+    unsigned int threadCount = ((QAction*)sender())->data().toUInt();
+    RecursiveJackContext::getInstance()->setThreadCount(threadCount);
+    settings.setValue("threadCount", threadCount);
+}
+
 void MainWindow::on_actionSave_session_triggered()
 {
     // ask for the session file name:
@@ -58,6 +58,7 @@ private slots:
     void onContextLevelChanged(int level);
     void on_actionNew_module_triggered();
     void on_actionLoad_macro_triggered();
+    void onActionThreadCount();
 
 private:
     Ui::MainWindow *ui;
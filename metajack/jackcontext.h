@@ -116,6 +116,10 @@ public:
     virtual void transport_stop (jack_client_t *client) = 0;
     virtual void get_transport_info (jack_client_t *client, jack_transport_info_t *tinfo) = 0;
     virtual void set_transport_info (jack_client_t *client, jack_transport_info_t *tinfo) = 0;
+    // Jack thread API methods:
+    virtual int client_real_time_priority (jack_client_t *client) = 0;
+    virtual int client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg) = 0;
+    virtual int client_stop_thread (jack_client_t *client, jack_native_thread_t thread) = 0;
 };
 
 #endif // METAJACKINTERFACE_H
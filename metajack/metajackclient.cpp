@@ -23,6 +23,7 @@
 #include "recursivejackcontext.h"
 #include <sstream>
 #include <cassert>
+#include <algorithm>
 
 MetaJackClientBase::MetaJackClientBase(const std::string &name_) :
     name(name_)
@@ -76,7 +77,10 @@ bool MetaJackClientBase::isIndirectInputOf(MetaJackPortBase *port) const
 MetaJackClientProcess::MetaJackClientProcess(const std::string &name) :
     MetaJackClientBase(name),
     processCallback(0),
-    processCallbackArgument(0)
+    processCallbackArgument(0),
+    silenceTail(JACK_MAX_FRAMES),
+    silentFrames(0),
+    woken(0)
 {}
 
 void MetaJackClientProcess::setProcessCallback(JackProcessCallback processCallback, void *processCallbackArgument)
@@ -85,32 +89,109 @@ void MetaJackClientProcess::setProcessCallback(JackProcessCallback processCallba
     this->processCallbackArgument = processCallbackArgument;
 }
 
-bool MetaJackClientProcess::process(std::set<MetaJackClientProcess*> &unprocessedClients, jack_nframes_t nframes)
+bool MetaJackClientProcess::process(jack_nframes_t nframes)
 {
-    // recursively process all clients that are connected to this client's input ports first:
-    for (std::set<MetaJackPortBase*>::iterator i = ports.begin(); i != ports.end(); i++) {
-        MetaJackPortProcess *port = (MetaJackPortProcess*)*i;
-        // make sure all the client's buffers are initialized:
-        port->getBuffer(nframes);
-        // process all other clients that are connected to one of our inputs first:
-        if (port->isInput()) {
-            if (!port->process(unprocessedClients, nframes)) {
-                return false;
-            }
-        }
+    // the clients connected to this client's inputs have already been processed (see MetaJackSchedule):
+    if (isIdle(nframes)) {
+        // the outputs stay silent, they only have to be cleared (their buffers may be shared with other ports):
+        load.start();
+        clearOutputs();
+        load.stop();
+        return true;
     }
-    // process this client:
     if (processCallback) {
+        load.start();
         int errorCode = processCallback(nframes, processCallbackArgument);
+        load.stop();
         if (errorCode) {
             return false;
         }
     }
-    // processing succeeded:
-    unprocessedClients.erase(this);
+    // let the connected clients know whether they get silence:
+    detectSilentOutputs(nframes);
     return true;
 }
 
+void MetaJackClientProcess::setSilenceTail(jack_nframes_t silenceTail)
+{
+    this->silenceTail = silenceTail;
+    silentFrames = 0;
+}
+
+void MetaJackClientProcess::wake()
+{
+    // events sent to the client (with the estimated current time) are processed up to one cycle later:
+    woken.fetchAndStoreOrdered(2);
+}
+
+MetaJackClientLoad & MetaJackClientProcess::getLoad()
+{
+    return load;
+}
+
+bool MetaJackClientProcess::isIdle(jack_nframes_t nframes)
+{
+    if (silenceTail == JACK_MAX_FRAMES) {
+        return false;
+    }
+    // a woken client is processed for the next two cycles (e.g. to take over parameter changes) and its tail starts again:
+    int wokenCycles = woken;
+    if (wokenCycles > 0) {
+        // if the client has been woken again meanwhile, this fails and it stays woken:
+        woken.testAndSetOrdered(wokenCycles, wokenCycles - 1);
+        silentFrames = 0;
+        return false;
+    }
+    for (std::set<MetaJackPortBase*>::iterator i = ports.begin(); i != ports.end(); i++) {
+        MetaJackPortProcess *port = (MetaJackPortProcess*)*i;
+        if (port->isInput() && !port->isSilent()) {
+            silentFrames = 0;
+            return false;
+        }
+    }
+    // the inputs are silent, wait for the tail to pass:
+    if (silentFrames < silenceTail) {
+        silentFrames += std::min(nframes, silenceTail - silentFrames);
+        return false;
+    }
+    // the outputs have to be silent as well (as of the last cycle), e.g. an envelope might still be sustaining:
+    for (std::set<MetaJackPortBase*>::iterator i = ports.begin(); i != ports.end(); i++) {
+        MetaJackPortProcess *port = (MetaJackPortProcess*)*i;
+        if (!port->isInput() && !port->isSilent()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MetaJackClientProcess::clearOutputs()
+{
+    for (std::set<MetaJackPortBase*>::iterator i = ports.begin(); i != ports.end(); i++) {
+        MetaJackPortProcess *port = (MetaJackPortProcess*)*i;
+        if (!port->isInput()) {
+            port->clearBuffer();
+            port->setSilent(true);
+        }
+    }
+}
+
+void MetaJackClientProcess::detectSilentOutputs(jack_nframes_t nframes)
+{
+    for (std::set<MetaJackPortBase*>::iterator i = ports.begin(); i != ports.end(); i++) {
+        MetaJackPortProcess *port = (MetaJackPortProcess*)*i;
+        if (!port->isInput()) {
+            port->detectSilence(nframes);
+        }
+    }
+}
+
+void MetaJackClientProcess::releasePortBuffers()
+{
+    for (std::set<MetaJackPortBase*>::iterator i = ports.begin(); i != ports.end(); i++) {
+        ((MetaJackPortProcess*)*i)->setBuffer(0, 0);
+    }
+}
+
 MetaJackClient::MetaJackClient(const std::string &name) :
     MetaJackClientBase(name),
     active(false),
@@ -153,9 +234,19 @@ MetaJackInterfaceClient::MetaJackInterfaceClient(MetaJackContext *context_, Jack
     context->portConnectCallbackHandler[this] = std::make_pair(portConnectCallback, this);
 }
 
+MetaJackInterfaceClient::~MetaJackInterfaceClient()
+{
+    for (ConnectedPort *connectedPort = connectedPorts; connectedPort; ) {
+        ConnectedPort *next = connectedPort->next;
+        delete connectedPort->resampler;
+        delete connectedPort;
+        connectedPort = next;
+    }
+}
+
 bool MetaJackInterfaceClient::hasWrapperPorts() const
 {
-    return connectedPorts.size();
+    return connectedPorts;
 }
 
 int MetaJackInterfaceClient::process(jack_nframes_t nframes, void *arg)
@@ -163,37 +254,32 @@ int MetaJackInterfaceClient::process(jack_nframes_t nframes, void *arg)
     // the purpose of the dummy input client is to make the wrapper client inputs available to clients inside the wrapper
     MetaJackInterfaceClient *me = (MetaJackInterfaceClient*)arg;
     unsigned int oversampling = me->context->getOversampling();
-    for (std::map<MetaJackPort*, jack_port_t*>::iterator i = me->connectedPorts.begin(); i != me->connectedPorts.end(); i++) {
+    for (ConnectedPort *connectedPort = me->connectedPorts; connectedPort; connectedPort = connectedPort->next) {
         // for each connected port, copy from the wrapper client's port to the corresponding internal port:
-        MetaJackPort *port = i->first;
-        jack_port_t *wrapperPort = i->second;
+        MetaJackPort *port = connectedPort->port;
+        jack_port_t *wrapperPort = connectedPort->wrapperPort;
         if (port && wrapperPort) {
             if (port->getType() == JACK_DEFAULT_AUDIO_TYPE) {
                 // copy audio:
                 jack_default_audio_sample_t *wrapperAudioBuffer = (jack_default_audio_sample_t*)me->wrapperInterface->port_get_buffer(wrapperPort, nframes / oversampling);
                 jack_default_audio_sample_t *audioBuffer = (jack_default_audio_sample_t*)me->context->getPortBuffer(port, nframes);
-                if (port->isInput()) {
-                    if (oversampling > 1) {
+                if (oversampling > 1) {
+                    // each audio port gets its own resampler when it is connected (see createNewPort()):
+                    assert(connectedPort->resampler);
+                    if (port->isInput()) {
                         // downsampling:
-                        for (jack_nframes_t i = 0, wrapperi = 0; i < nframes; i += oversampling, wrapperi++) {
-                            // apply a sinc filter for bandlimiting:
-                            for (jack_nframes_t j = 0; j < oversampling; j++) {
-                                me->downsamplers[port].feed(audioBuffer[i + j]);
-                            }
-                            wrapperAudioBuffer[wrapperi] = me->downsamplers[port].process();
-                        }
+                        connectedPort->resampler->downsample(audioBuffer, wrapperAudioBuffer, nframes / oversampling);
                     } else {
-                        for (jack_nframes_t i = 0; i < nframes; i++) {
-                            wrapperAudioBuffer[i] = audioBuffer[i];
-                        }
+                        // upsampling:
+                        connectedPort->resampler->upsample(wrapperAudioBuffer, audioBuffer, nframes / oversampling);
+                    }
+                } else if (port->isInput()) {
+                    for (jack_nframes_t i = 0; i < nframes; i++) {
+                        wrapperAudioBuffer[i] = audioBuffer[i];
                     }
                 } else {
-                    // upsampling:
-                    for (jack_nframes_t i = 0, wrapperi = 0; i < nframes; i += oversampling, wrapperi++) {
-                        // currently just copying of samples:
-                        for (jack_nframes_t j = 0; j < oversampling; j++) {
-                            audioBuffer[i + j] = wrapperAudioBuffer[wrapperi];
-                        }
+                    for (jack_nframes_t i = 0; i < nframes; i++) {
+                        audioBuffer[i] = wrapperAudioBuffer[i];
                     }
                 }
             } else if (port->getType() == JACK_DEFAULT_MIDI_TYPE) {
@@ -258,13 +344,18 @@ void MetaJackInterfaceClient::createNewPort(MetaJackPort *freePort, MetaJackPort
     // one of the unconnected output port has been connected, create a corresponding real jack input port:
     std::string wrapperPortName = freePort->getShortName();//createPortName(otherPort->getShortName(), !freePort->isInput(), freePort->getType() == JACK_DEFAULT_AUDIO_TYPE ? wrapperAudioSuffix++ : wrapperMidiSuffix++);
     jack_port_t *wrapperPort = context->createWrapperPort(wrapperPortName, freePort->getType(), freePort->isInput() ? JackPortIsOutput : JackPortIsInput);
-    connectedPorts[freePort] = wrapperPort;
-    if (freePort->getType() == JACK_DEFAULT_AUDIO_TYPE) {
-        unsigned int oversampling = context->getOversampling();
-        SincFilter sincFilter(8, 0.5);
-        sincFilter.setSampleRate(oversampling);
-        downsamplers.insert(std::make_pair(freePort, sincFilter));
+    // set up everything the process thread needs for the new port, including its resampler:
+    ConnectedPort *connectedPort = new ConnectedPort();
+    connectedPort->port = freePort;
+    connectedPort->wrapperPort = wrapperPort;
+    connectedPort->resampler = 0;
+    unsigned int oversampling = context->getOversampling();
+    if ((freePort->getType() == JACK_DEFAULT_AUDIO_TYPE) && (oversampling > 1)) {
+        connectedPort->resampler = new PolyphaseResampler(oversampling, context->getResamplingQuality());
     }
+    // only then publish it to the process thread (only this thread changes the list):
+    connectedPort->next = connectedPorts;
+    connectedPorts.fetchAndStoreRelease(connectedPort);
     freePorts.erase(freePort);
     // create a new free port:
     std::string newPortName = freePort->getType() == JACK_DEFAULT_AUDIO_TYPE ? createPortName("audio", !freePort->isInput(), audioSuffix++) : createPortName("midi", !freePort->isInput(), midiSuffix++);
@@ -22,9 +22,11 @@
 
 #include <string>
 #include <set>
-#include <map>
 #include <jack/types.h>
-#include "sincfilter.h"
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include "polyphaseresampler.h"
+#include "metajackclientload.h"
 
 class MetaJackPortBase;
 class MetaJackPort;
@@ -48,10 +50,46 @@ class MetaJackClientProcess : public MetaJackClientBase {
 public:
     MetaJackClientProcess(const std::string &name);
     void setProcessCallback(JackProcessCallback processCallback, void *processCallbackArgument);
-    bool process(std::set<MetaJackClientProcess*> &unprocessedClients, jack_nframes_t nframes);
+    /**
+      Calls the process callback, unless the client is idle (see setSilenceTail()).
+      Afterwards, the output ports know whether their buffers are silent.
+      */
+    bool process(jack_nframes_t nframes);
+    /**
+      Lets the client be skipped while it is idle, i.e. while its inputs are
+      silent and its outputs have become silent, once the inputs have been
+      silent for the given tail. Idle clients only get their outputs cleared.
+
+      @param silenceTail the number of frames the outputs may still become
+        non-silent after the inputs became silent, or JACK_MAX_FRAMES (the
+        default) if the client must always be processed
+      */
+    void setSilenceTail(jack_nframes_t silenceTail);
+    /**
+      Makes sure the client is processed in the next two cycles, even if it is
+      idle. This can be called from any thread.
+      */
+    void wake();
+    /**
+      @return the time statistics of this client's process callback, which
+        are only accessed by the threads processing the schedule
+      */
+    MetaJackClientLoad & getLoad();
+    /**
+      Makes this client's ports fall back to the scratch buffers, such that
+      they don't use the buffers of a schedule which doesn't process them.
+      */
+    void releasePortBuffers();
 private:
     JackProcessCallback processCallback;
     void * processCallbackArgument;
+    MetaJackClientLoad load;
+    jack_nframes_t silenceTail, silentFrames;
+    QAtomicInt woken;
+
+    bool isIdle(jack_nframes_t nframes);
+    void clearOutputs();
+    void detectSilentOutputs(jack_nframes_t nframes);
 };
 
 class MetaJackClient : public MetaJackClientBase {
@@ -72,12 +110,25 @@ class JackContext;
 class MetaJackInterfaceClient : public MetaJackClient {
 public:
     MetaJackInterfaceClient(MetaJackContext *context, JackContext *wrapperInterface, int flags);
+    ~MetaJackInterfaceClient();
     bool hasWrapperPorts() const;
 private:
+    /**
+      A connected port together with its wrapper port and (for oversampled
+      audio ports) its resampler. Entries are completely set up in the GUI
+      thread before they are prepended to the list which the process thread
+      reads, and are never changed afterwards.
+      */
+    struct ConnectedPort {
+        MetaJackPort *port;
+        jack_port_t *wrapperPort;
+        PolyphaseResampler *resampler;
+        ConnectedPort *next;
+    };
+
     MetaJackContext *context;
     JackContext *wrapperInterface;
-    std::map<MetaJackPort*, jack_port_t*> connectedPorts;
-    std::map<MetaJackPort*, SincFilter> downsamplers;
+    QAtomicPointer<ConnectedPort> connectedPorts;
     std::set<MetaJackPort*> freePorts;
     int wrapperAudioSuffix, wrapperMidiSuffix, audioSuffix, midiSuffix;
     static int process(jack_nframes_t nframes, void *arg);
@@ -0,0 +1,99 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "metajackclientload.h"
+#include <memory.h>
+
+MetaJackClientLoad::MetaJackClientLoad()
+{
+    reset();
+}
+
+void MetaJackClientLoad::addMeasurement(qint64 nanoseconds)
+{
+    if (!cycles || (nanoseconds < minimum)) {
+        minimum = nanoseconds;
+    }
+    if (!cycles || (nanoseconds > maximum)) {
+        maximum = nanoseconds;
+    }
+    sum += nanoseconds;
+    histogram[getBin(nanoseconds)]++;
+    cycles++;
+}
+
+unsigned int MetaJackClientLoad::getCycles() const
+{
+    return cycles;
+}
+
+MetaJackClientLoad::Statistics MetaJackClientLoad::getStatistics(qint64 period) const
+{
+    Statistics statistics;
+    statistics.cycles = cycles;
+    statistics.minimum = minimum;
+    statistics.average = (cycles ? sum / cycles : 0);
+    statistics.maximum = maximum;
+    statistics.percentile99 = maximum;
+    statistics.period = period;
+    // walk down from the slowest bin until more than one percent of the cycles have been seen:
+    unsigned int slowerCycles = 0;
+    for (int bin = BINS - 1; bin >= 0; bin--) {
+        slowerCycles += histogram[bin];
+        if (slowerCycles > cycles / 100) {
+            statistics.percentile99 = qMin(getBinUpperBound(bin), maximum);
+            break;
+        }
+    }
+    return statistics;
+}
+
+void MetaJackClientLoad::reset()
+{
+    cycles = 0;
+    minimum = maximum = sum = 0;
+    memset(histogram, 0, sizeof(histogram));
+}
+
+int MetaJackClientLoad::getBin(qint64 nanoseconds)
+{
+    // the first octaves are too short to be split, each value gets its own bin:
+    if (nanoseconds < 2 * SUBBINS) {
+        return (nanoseconds < 0 ? 0 : (int)nanoseconds);
+    }
+    // find the most significant bit:
+    quint64 value = nanoseconds;
+    int msb = 0;
+    for (int shift = 32; shift; shift >>= 1) {
+        if (value >> shift) {
+            value >>= shift;
+            msb += shift;
+        }
+    }
+    // the two bits below the most significant one select the bin within the octave:
+    return msb * SUBBINS + (int)((nanoseconds >> (msb - 2)) & (SUBBINS - 1));
+}
+
+qint64 MetaJackClientLoad::getBinUpperBound(int bin)
+{
+    if (bin < 2 * SUBBINS) {
+        return bin;
+    }
+    int msb = bin / SUBBINS;
+    return ((qint64)(SUBBINS + bin % SUBBINS + 1) << (msb - 2)) - 1;
+}
@@ -0,0 +1,92 @@
+#ifndef METAJACKCLIENTLOAD_H
+#define METAJACKCLIENTLOAD_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+/**
+  Accumulates the time a client's process callback takes per cycle.
+
+  Each MetaJackClientProcess owns one of these. The time is measured around
+  the process callback by whichever thread processes the client. A client is
+  processed by only one thread per cycle, and MetaJackSchedule orders the cycles,
+  so no locking is needed. The process thread periodically takes the statistics
+  and resets them after the schedule is done (see MetaJackContext::process()).
+
+  Percentiles come from a histogram with four bins per octave. It has a fixed size,
+  so no memory is allocated in the process thread.
+  */
+class MetaJackClientLoad {
+public:
+    /**
+      A snapshot of the statistics, which can be copied through a ring buffer.
+      All times are given in nanoseconds.
+      */
+    struct Statistics {
+        // the number of measured process cycles:
+        unsigned int cycles;
+        qint64 minimum, average, maximum, percentile99;
+        // the duration of one period (i.e., the time budget of all clients):
+        qint64 period;
+    };
+
+    MetaJackClientLoad();
+
+    /**
+      Starts measuring a process callback.
+      */
+    void start()
+    {
+        timer.start();
+    }
+    /**
+      Stops measuring a process callback and adds the elapsed time.
+      */
+    void stop()
+    {
+        addMeasurement(timer.nsecsElapsed());
+    }
+    void addMeasurement(qint64 nanoseconds);
+
+    unsigned int getCycles() const;
+    /**
+      @param period the duration of one period in nanoseconds, which is copied to the result
+      */
+    Statistics getStatistics(qint64 period) const;
+    void reset();
+
+private:
+    enum {
+        SUBBINS = 4,
+        BINS = 64 * SUBBINS
+    };
+
+    QElapsedTimer timer;
+    unsigned int cycles;
+    qint64 minimum, maximum, sum;
+    unsigned int histogram[BINS];
+
+    static int getBin(qint64 nanoseconds);
+    static qint64 getBinUpperBound(int bin);
+};
+
+#endif // METAJACKCLIENTLOAD_H
@@ -25,20 +25,43 @@
 //#include <boost/xpressive/xpressive_dynamic.hpp>
 #include <QRegExp>
 
-MetaJackContext::MetaJackContext(JackContext *jackInterface_, const std::string &name, unsigned int oversampling_) :
+MetaJackContext::MetaJackContext(JackContext *jackInterface_, const std::string &name, unsigned int oversampling_, unsigned int threadCount_) :
     wrapperInterface(jackInterface_),
     wrapperClient(0),
     wrapperClientName(name),
     uniquePortId(1),
+    audioSilencePort(0),
+    midiSilencePort(0),
+    audioScratchPort(0),
+    midiScratchPort(0),
+    schedule(0),
+    threadCount(1),
+    threadPool(0),
     graphChangesRingBuffer(1024),
+    retiredSchedulesRingBuffer(1024),
+    retiredThreadPoolsRingBuffer(16),
+    transaction(0),
+    transactionDepth(0),
+    transactionChangesSchedule(false),
+    retiredTransactionsRingBuffer(1024),
+    clientLoadRingBuffer(1024),
     shutdown(false),
-    oversampling(oversampling_)
+    processing(false),
+    oversampling(oversampling_),
+    resamplingQuality(PolyphaseResampler::MEDIUM_QUALITY)
 {
     // register at the given jack interface:
     wrapperClient = wrapperInterface->client_open(name.c_str(), JackNullOption, 0);
     if (wrapperClient) {
         // get the buffer size:
         bufferSize = wrapperInterface->get_buffer_size(wrapperClient) * oversampling;
+        // create the buffers which unconnected input ports share:
+        audioSilencePort = new MetaJackPortProcess(0, "silence", JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, bufferSize);
+        audioSilencePort->clearBuffer();
+        midiSilencePort = new MetaJackPortProcess(0, "silence", JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, bufferSize);
+        // create the buffers which ports without a buffer in the schedule's arena use:
+        audioScratchPort = new MetaJackPortProcess(0, "scratch", JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, bufferSize);
+        midiScratchPort = new MetaJackPortProcess(0, "scratch", JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, bufferSize);
         // register the process callback (this gets special treatment):
         wrapperInterface->set_process_callback(wrapperClient, process, this);
         // register the thread init callback:
@@ -55,11 +78,13 @@ MetaJackContext::MetaJackContext(JackContext *jackInterface_, const std::string
         wrapperInterface->set_xrun_callback(wrapperClient, JackXRunCallbackHandler::invokeCallbacksWithoutArgs, &xRunCallbackHandler);
         // register the transport sync callback:
         wrapperInterface->set_sync_callback(wrapperClient, JackSyncCallbackHandler::invokeCallbacksWithArgs, &syncCallbackHandler);
+        clientLoadTimer.start();
         // activate the client:
         if (wrapperInterface->activate(wrapperClient)) {
             wrapperInterface->client_close(wrapperClient);
             wrapperClient = 0;
         } else {
+            processing = true;
             wrapperClientName = wrapperInterface->get_client_name(wrapperClient);
             inputInterfaceClient = new MetaJackInterfaceClient(this, wrapperInterface, JackPortIsOutput);
             clients[inputInterfaceClient->getName()] = inputInterfaceClient;
@@ -67,6 +92,8 @@ MetaJackContext::MetaJackContext(JackContext *jackInterface_, const std::string
             outputInterfaceClient = new MetaJackInterfaceClient(this, wrapperInterface, JackPortIsInput);
             clients[outputInterfaceClient->getName()] = outputInterfaceClient;
             activateClient(outputInterfaceClient);
+            // now that there is a process thread, create the worker threads:
+            setThreadCount(threadCount_);
         }
     }
     std::stringstream nameStream;
@@ -80,7 +107,12 @@ MetaJackContext::~MetaJackContext()
     // (note: no status is set, because there is no one that really fits this situation)
     infoShutdownCallbackHandler.invokeCallbacksWithArgs((jack_status_t)0, "Your MetaJack instance is being deleted");
     shutdownCallbackHandler.invokeCallbacks();
-    // close all clients:
+    // stop the process thread before stopping the worker threads, which are bound to the wrapper client:
+    stopProcessing();
+    deleteRetiredThreadPools();
+    delete threadPool;
+    threadPool = 0;
+    // close all clients (this does not involve the process thread anymore):
     for (; clients.size(); ) {
         MetaJackClient *client = clients.begin()->second;
         closeClient(client);
@@ -88,6 +120,15 @@ MetaJackContext::~MetaJackContext()
     // close the wrapper client:
     wrapperInterface->client_close(wrapperClient);
     wrapperClient = 0;
+    // the process thread is not running anymore, delete the schedules and transactions:
+    deleteRetiredSchedules();
+    delete schedule;
+    deleteRetiredTransactions();
+    delete transaction;
+    delete audioSilencePort;
+    delete midiSilencePort;
+    delete audioScratchPort;
+    delete midiScratchPort;
 }
 
 jack_port_t * MetaJackContext::createWrapperPort(const std::string &shortName, const std::string &type, unsigned long flags)
@@ -120,11 +161,101 @@ unsigned int MetaJackContext::getOversampling() const
     return oversampling;
 }
 
+void MetaJackContext::setResamplingQuality(PolyphaseResampler::Quality quality)
+{
+    resamplingQuality = quality;
+}
+
+PolyphaseResampler::Quality MetaJackContext::getResamplingQuality() const
+{
+    return resamplingQuality;
+}
+
+void MetaJackContext::setThreadCount(unsigned int threadCount)
+{
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    if (threadCount == this->threadCount) {
+        return;
+    }
+    this->threadCount = threadCount;
+    deleteRetiredSchedules();
+    deleteRetiredThreadPools();
+    // worker threads are only needed if there is a process thread:
+    MetaJackThreadPool *newThreadPool = ((threadCount > 1) && isProcessing() ? new MetaJackThreadPool(wrapperInterface, wrapperClient, &threadInitCallbackHandler, threadCount - 1) : 0);
+    // the schedule needs one task queue per thread:
+    MetaJackSchedule *newSchedule = new MetaJackSchedule(clients, 0, threadCount, bufferSize);
+    if (isProcessing()) {
+        MetaJackGraphEvent event;
+        event.type = MetaJackGraphEvent::SET_THREAD_POOL;
+        event.threadPool = newThreadPool;
+        event.schedule = newSchedule;
+        // the following will call the process thread's setThreadPool() and setSchedule() methods:
+        sendGraphChangeEvent(event);
+    } else {
+        setThreadPool(newThreadPool);
+        setSchedule(newSchedule);
+        deleteRetiredSchedules();
+        deleteRetiredThreadPools();
+    }
+}
+
+unsigned int MetaJackContext::getThreadCount() const
+{
+    return threadCount;
+}
+
+void MetaJackContext::stopProcessing()
+{
+    if (!processing) {
+        return;
+    }
+    // send the open transaction's changes to be applied below, the following ones are applied directly:
+    if (transaction) {
+        sendGraphTransaction();
+        delete transaction;
+        transaction = 0;
+    }
+    if (!shutdown) {
+        wrapperInterface->deactivate(wrapperClient);
+    }
+    processing = false;
+    // the process thread is not running anymore (or never will), so apply its pending changes here:
+    processGraphChangeEvents();
+    deleteRetiredSchedules();
+    deleteRetiredTransactions();
+}
+
 bool MetaJackContext::isActive() const
 {
     return wrapperClient && !shutdown;
 }
 
+bool MetaJackContext::isProcessing() const
+{
+    if (!processing || shutdown) {
+        return false;
+    }
+    // a nested context is only processed while its wrapper context is:
+    if (const MetaJackContext *wrapperContext = dynamic_cast<const MetaJackContext*>(wrapperInterface)) {
+        return wrapperContext->isProcessing();
+    }
+    return true;
+}
+
+bool MetaJackContext::getClientLoad(MetaJackClient *client, MetaJackClientLoad::Statistics &statistics)
+{
+    assert(client);
+    readClientLoads();
+    std::map<MetaJackClientProcess*, MetaJackClientLoad::Statistics>::iterator find = clientLoads.find(client->getProcessClient());
+    if (find == clientLoads.end()) {
+        return false;
+    }
+    statistics = find->second;
+    return true;
+}
+
 jack_port_id_t MetaJackContext::createUniquePortId()
 {
     return uniquePortId++;
@@ -181,7 +312,7 @@ bool MetaJackContext::closeClient(MetaJackClient *client)
     for (; client->getPorts().size(); ) {
         unregisterPort((MetaJackPort*)*client->getPorts().begin());
     }
-    if (isActive()) {
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::CLOSE_CLIENT;
         event.client = client->getProcessClient();
@@ -190,6 +321,9 @@ bool MetaJackContext::closeClient(MetaJackClient *client)
     } else {
         closeClient(client->getProcessClient());
     }
+    // forget the client's load statistics:
+    readClientLoads();
+    clientLoads.erase(client->getProcessClient());
     clients.erase(client->getName());
     delete client;
     return true;
@@ -207,7 +341,7 @@ bool MetaJackContext::setProcessCallback(MetaJackClient *client, JackProcessCall
     if (client->isActive()) {
         return false;
     }
-    if (isActive()) {
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::SET_PROCESS_CALLBACK;
         event.client = client->getProcessClient();
@@ -227,6 +361,35 @@ void MetaJackContext::setProcessCallback(MetaJackClientProcess *client, JackProc
     client->setProcessCallback(processCallback, processCallbackArgument);
 }
 
+bool MetaJackContext::setSilenceTail(MetaJackClient *client, jack_nframes_t silenceTail)
+{
+    assert(client);
+    if (isProcessing()) {
+        MetaJackGraphEvent event;
+        event.type = MetaJackGraphEvent::SET_SILENCE_TAIL;
+        event.client = client->getProcessClient();
+        event.silenceTail = silenceTail;
+        // the following will call the process thread's setSilenceTail() method:
+        sendGraphChangeEvent(event);
+    } else {
+        setSilenceTail(client->getProcessClient(), silenceTail);
+    }
+    return true;
+}
+
+void MetaJackContext::setSilenceTail(MetaJackClientProcess *client, jack_nframes_t silenceTail)
+{
+    assert(client);
+    client->setSilenceTail(silenceTail);
+}
+
+void MetaJackContext::wakeClient(MetaJackClient *client)
+{
+    assert(client);
+    // this does not change the graph, so it does not need to go through the process thread:
+    client->getProcessClient()->wake();
+}
+
 bool MetaJackContext::activateClient(MetaJackClient *client)
 {
     assert(client);
@@ -240,7 +403,7 @@ bool MetaJackContext::activateClient(MetaJackClient *client)
         void *arg = find->second.second;
         callback(bufferSize, arg);
     }
-    if (isActive()) {
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::ACTIVATE_CLIENT;
         event.client = client->getProcessClient();
@@ -250,6 +413,7 @@ bool MetaJackContext::activateClient(MetaJackClient *client)
         activateClient(client->getProcessClient());
     }
     client->setActive(true);
+    compileSchedule();
     clientRegistrationCallbackHandler.invokeCallbacksWithArgs(client->getName().c_str(), 1);
     // invoke port registration callback for each port:
     for (std::set<MetaJackPortBase*>::iterator i = client->getPorts().begin(); i != client->getPorts().end(); i++) {
@@ -270,12 +434,19 @@ bool MetaJackContext::deactivateClient(MetaJackClient *client)
     if (!client->isActive()) {
         return false;
     }
-    if (isActive()) {
+    // remove the client from the execution order before deactivating it:
+    client->setActive(false);
+    compileSchedule();
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::DEACTIVATE_CLIENT;
         event.client = client->getProcessClient();
         // the following will call the process thread's deactivateClient() method:
         sendGraphChangeEvent(event);
+        if (transaction) {
+            // the process thread can only process the event if it gets the open transaction's changes:
+            sendGraphTransaction();
+        }
         // this event has to be synchronous, thus we wait here for the event to be processed before returning:
         waitMutex.lock();
         waitCondition.wait(&waitMutex);
@@ -283,7 +454,6 @@ bool MetaJackContext::deactivateClient(MetaJackClient *client)
     } else {
         deactivateClient(client->getProcessClient());
     }
-    client->setActive(false);
     // disconnect all ports:
     for (std::set<MetaJackPortBase*>::iterator i = client->getPorts().begin(); i != client->getPorts().end(); i++) {
         port_disconnect((jack_client_t*)client, (jack_port_t*)*i);
@@ -301,6 +471,8 @@ void MetaJackContext::deactivateClient(MetaJackClientProcess *client)
     assert(client);
     activeClients.erase(client);
     client->disconnect();
+    // the client is not part of the schedule anymore, thus its ports must not use the schedule's buffers:
+    client->releasePortBuffers();
 }
 
 MetaJackPort * MetaJackContext::registerPort(MetaJackClient *client, const std::string & shortName, const std::string &type, unsigned long flags, unsigned long)
@@ -326,59 +498,67 @@ MetaJackPort * MetaJackContext::registerPort(MetaJackClient *client, const std::
         return 0;
     }
     MetaJackPort *port = new MetaJackPort(client, createUniquePortId(), shortName, type, flags);
-    port->createProcessPort(bufferSize);
-    if (isActive()) {
+    if (type == JACK_DEFAULT_AUDIO_TYPE) {
+        port->createProcessPort(audioSilencePort, audioScratchPort);
+    } else {
+        port->createProcessPort(midiSilencePort, midiScratchPort);
+    }
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::REGISTER_PORT;
         event.client = client->getProcessClient();
         event.port = port->getProcessPort();
-        event.nonProcessPort = port;
         // the following will call the process thread's registerPort() method:
         sendGraphChangeEvent(event);
     } else {
-        registerPort(client->getProcessClient(), port->getProcessPort(), port);
+        registerPort(client->getProcessClient(), port->getProcessPort());
+    }
+    if (client->isActive()) {
+        compileSchedule();
     }
-    portsById[port->getId()] = portsByName[port->getFullName()] = port;
+    portsById[port->getId()] = port;
+    addPortName(port);
     if (client->isActive()) {
         portRegistrationCallbackHandler.invokeCallbacksWithArgs(port->getId(), 1);
     }
     return port;
 }
 
-void MetaJackContext::registerPort(MetaJackClientProcess *client, MetaJackPortProcess *port, MetaJackPort *nonProcessPort)
+void MetaJackContext::registerPort(MetaJackClientProcess *client, MetaJackPortProcess *port)
 {
     assert(client && port);
     port->setClient(client);
-    processPorts[nonProcessPort] = port;
 }
 
 bool MetaJackContext::unregisterPort(MetaJackPort *port)
 {
     assert(port && port->getProcessPort());
-    if (isActive()) {
+    if (((MetaJackClient*)port->getClient())->isActive()) {
+        // remove the port from the execution order before it is deleted in the process thread:
+        compileSchedule(port);
+    }
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::UNREGISTER_PORT;
         event.port = port->getProcessPort();
-        event.nonProcessPort = port;
         // the following will call the process thread's unregisterPort() method:
         sendGraphChangeEvent(event);
     } else {
-        unregisterPort(port->getProcessPort(), port);
+        unregisterPort(port->getProcessPort());
     }
     port->disconnect();
     if (((MetaJackClient*)port->getClient())->isActive()) {
         portRegistrationCallbackHandler.invokeCallbacksWithArgs(port->getId(), 0);
     }
     portsById.erase(port->getId());
-    portsByName.erase(port->getFullName());
+    removePortName(port->getFullName());
     delete port;
     return true;
 }
 
-void MetaJackContext::unregisterPort(MetaJackPortProcess *port, MetaJackPort *nonProcessPort)
+void MetaJackContext::unregisterPort(MetaJackPortProcess *port)
 {
     assert(port);
-    processPorts.erase(nonProcessPort);
     port->disconnect();
     delete port;
 }
@@ -394,23 +574,23 @@ bool MetaJackContext::renamePort(MetaJackPort *port, const std::string &shortNam
         port->setShortName(oldShortName);
         return false;
     }
-    if (isActive()) {
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::RENAME_PORT;
         event.port = port->getProcessPort();
-        event.shortName = shortName;
+        event.shortName = names.getName(names.intern(shortName)).c_str();
         // the following will call the process thread's renamePort() method:
         sendGraphChangeEvent(event);
     } else {
-        renamePort(port->getProcessPort(), shortName);
+        renamePort(port->getProcessPort(), shortName.c_str());
     }
     portRenameCallbackHandler.invokeCallbacksWithArgs(port->getId(), oldFullName.c_str(), port->getFullName().c_str());
-    portsByName.erase(oldFullName);
-    portsByName[port->getFullName()] = port;
+    removePortName(oldFullName);
+    addPortName(port);
     return true;
 }
 
-void MetaJackContext::renamePort(MetaJackPortProcess *port, const std::string &shortName)
+void MetaJackContext::renamePort(MetaJackPortProcess *port, const char *shortName)
 {
     assert(port);
     port->setShortName(shortName);
@@ -440,7 +620,7 @@ bool MetaJackContext::connectPorts(const std::string &sourceName, const std::str
         return false;
     }
     source->connect(dest);
-    if (isActive()) {
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::CONNECT_PORTS;
         event.port = source->getProcessPort();
@@ -450,6 +630,7 @@ bool MetaJackContext::connectPorts(const std::string &sourceName, const std::str
     } else {
         connectPorts(source->getProcessPort(), dest->getProcessPort());
     }
+    compileSchedule();
     portConnectCallbackHandler.invokeCallbacksWithArgs(source->getId(), dest->getId(), 1);
     return true;
 }
@@ -484,7 +665,7 @@ bool MetaJackContext::disconnectPorts(const std::string &sourceName, const std::
         return false;
     }
     source->disconnect(dest);
-    if (isActive()) {
+    if (isProcessing()) {
         MetaJackGraphEvent event;
         event.type = MetaJackGraphEvent::DISCONNECT_PORTS;
         event.port = source->getProcessPort();
@@ -494,6 +675,7 @@ bool MetaJackContext::disconnectPorts(const std::string &sourceName, const std::
     } else {
         disconnectPorts(source->getProcessPort(), dest->getProcessPort());
     }
+    compileSchedule();
     portConnectCallbackHandler.invokeCallbacksWithArgs(source->getId(), dest->getId(), 0);
     return true;
 }
@@ -504,40 +686,188 @@ void MetaJackContext::disconnectPorts(MetaJackPortProcess *source, MetaJackPortP
     source->disconnect(dest);
 }
 
-const char ** MetaJackContext::getPortsByPattern(const std::string &port_name_pattern, const std::string &type_name_pattern, unsigned long flags)
+void MetaJackContext::setSchedule(MetaJackSchedule *schedule)
 {
-//    boost::xpressive::sregex regexPortNames = boost::xpressive::sregex::compile(port_name_pattern);
-//    boost::xpressive::sregex regexTypeNames = boost::xpressive::sregex::compile(type_name_pattern);
-    QRegExp regexPortNames(port_name_pattern.c_str());
-    QRegExp regexTypeNames(type_name_pattern.c_str());
-    std::list<MetaJackPort*> matchingPorts;
-    for (std::map<jack_port_id_t, MetaJackPort*>::iterator i = portsById.begin(); i != portsById.end(); i++) {
-        MetaJackPort *port = i->second;
-//        if (((port->getFlags() & flags) == flags) && ((port_name_pattern.length() == 0) || boost::xpressive::regex_match(port->getFullName(), regexPortNames)) && ((type_name_pattern.length() == 0) || boost::xpressive::regex_match(port->getType(), regexTypeNames))) {
-        if (((port->getFlags() & flags) == flags) && ((port_name_pattern.length() == 0) || regexPortNames.exactMatch(port->getFullName().c_str())) && ((type_name_pattern.length() == 0) || regexTypeNames.exactMatch(port->getType().c_str()))) {
-            // flags, port name and type match:
-            matchingPorts.push_back(port);
+    MetaJackSchedule *retiredSchedule = this->schedule;
+    this->schedule = schedule;
+    if (schedule) {
+        if (schedule->getBufferSize() != bufferSize) {
+            // the buffer size changed while the schedule was on its way (this allocates memory, but happens rarely):
+            schedule->changeBufferSize(bufferSize);
         }
+        // (ports in feedback loops copy their previous buffers, which are part of the old schedule's arena)
+        schedule->assignBuffers();
+    }
+    // the old schedule will be deleted outside the process thread:
+    if (retiredSchedule) {
+        retiredSchedulesRingBuffer.write(retiredSchedule);
+    }
+}
+
+void MetaJackContext::setThreadPool(MetaJackThreadPool *threadPool)
+{
+    // the old thread pool will be deleted outside the process thread:
+    if (this->threadPool) {
+        retiredThreadPoolsRingBuffer.write(this->threadPool);
+    }
+    this->threadPool = threadPool;
+}
+
+void MetaJackContext::beginGraphTransaction()
+{
+    // changes are only sent to the process thread if there is one:
+    if (!transactionDepth++ && isProcessing()) {
+        transaction = new std::vector<MetaJackGraphEvent>();
+    }
+}
+
+void MetaJackContext::commitGraphTransaction()
+{
+    assert(transactionDepth > 0);
+    if (!--transactionDepth && transaction) {
+        sendGraphTransaction();
+        delete transaction;
+        transaction = 0;
+    }
+}
+
+void MetaJackContext::sendGraphTransaction()
+{
+    assert(transaction);
+    if (transactionChangesSchedule) {
+        // compile the execution order once for all collected changes, it is set after applying them:
+        deleteRetiredSchedules();
+        deleteRetiredThreadPools();
+        MetaJackGraphEvent event;
+        event.type = MetaJackGraphEvent::SET_SCHEDULE;
+        event.schedule = new MetaJackSchedule(clients, 0, threadCount, bufferSize);
+        transaction->push_back(event);
+        transactionChangesSchedule = false;
+    }
+    if (transaction->size()) {
+        deleteRetiredTransactions();
+        MetaJackGraphEvent event;
+        event.type = MetaJackGraphEvent::APPLY_TRANSACTION;
+        event.transaction = transaction;
+        // the following will call the process thread's processGraphChangeEvent() method for each collected change:
+        sendGraphChangeEvent(event);
+        transaction = new std::vector<MetaJackGraphEvent>();
+    }
+}
+
+void MetaJackContext::compileSchedule(MetaJackPort *excludedPort)
+{
+    if (transaction) {
+        // the execution order is compiled when the transaction's changes are sent
+        // (ports being unregistered are deleted by then):
+        transactionChangesSchedule = true;
+        return;
+    }
+    deleteRetiredSchedules();
+    deleteRetiredThreadPools();
+    MetaJackSchedule *newSchedule = new MetaJackSchedule(clients, excludedPort, threadCount, bufferSize);
+    if (isProcessing()) {
+        MetaJackGraphEvent event;
+        event.type = MetaJackGraphEvent::SET_SCHEDULE;
+        event.schedule = newSchedule;
+        // the following will call the process thread's setSchedule() method:
+        sendGraphChangeEvent(event);
+    } else {
+        setSchedule(newSchedule);
+        deleteRetiredSchedules();
     }
-    if (matchingPorts.size()) {
-        char ** names = new char*[matchingPorts.size() + 1];
-        size_t index = 0;
-        for (std::list<MetaJackPort*>::iterator i = matchingPorts.begin(); i != matchingPorts.end(); i++, index++) {
-            MetaJackPort *port = *i;
-            names[index] = new char[port->getFullName().length() + 1];
-            memcpy(names[index], port->getFullName().c_str(), port->getFullName().length() + 1);
+}
+
+void MetaJackContext::deleteRetiredSchedules()
+{
+    for (; retiredSchedulesRingBuffer.readSpace(); ) {
+        delete retiredSchedulesRingBuffer.read();
+    }
+}
+
+void MetaJackContext::deleteRetiredThreadPools()
+{
+    for (; retiredThreadPoolsRingBuffer.readSpace(); ) {
+        delete retiredThreadPoolsRingBuffer.read();
+    }
+}
+
+void MetaJackContext::deleteRetiredTransactions()
+{
+    for (; retiredTransactionsRingBuffer.readSpace(); ) {
+        delete retiredTransactionsRingBuffer.read();
+    }
+}
+
+void MetaJackContext::addPortName(MetaJackPort *port)
+{
+    unsigned int id = names.intern(port->getFullName());
+    if (id >= portsByName.size()) {
+        portsByName.resize(id + 1, 0);
+    }
+    portsByName[id] = port;
+}
+
+void MetaJackContext::removePortName(const std::string &fullName)
+{
+    unsigned int id = names.find(fullName);
+    if (id < portsByName.size()) {
+        portsByName[id] = 0;
+    }
+}
+
+const QRegExp & MetaJackContext::getPattern(const std::string &pattern)
+{
+    std::map<std::string, QRegExp>::iterator find = patterns.find(pattern);
+    if (find != patterns.end()) {
+        return find->second;
+    }
+    return patterns.insert(std::make_pair(pattern, QRegExp(pattern.c_str()))).first->second;
+}
+
+bool MetaJackContext::isPlainPattern(const std::string &pattern)
+{
+    return pattern.find_first_of("\\^$.|?*+()[]{}") == std::string::npos;
+}
+
+const char ** MetaJackContext::getPortsByPattern(const std::string &port_name_pattern, const std::string &type_name_pattern, unsigned long flags)
+{
+    // do not let the cache grow without bounds if lots of different patterns are used:
+    if (patterns.size() >= 64) {
+        patterns.clear();
+    }
+    // patterns without special characters are compared as they are, others are compiled only once:
+    const QRegExp *regexPortNames = (isPlainPattern(port_name_pattern) ? 0 : &getPattern(port_name_pattern));
+    const QRegExp *regexTypeNames = (isPlainPattern(type_name_pattern) ? 0 : &getPattern(type_name_pattern));
+    std::vector<MetaJackPort*> candidates;
+    if (port_name_pattern.length() && !regexPortNames) {
+        // the pattern is a full port name, which can be looked up directly:
+        if (MetaJackPort *port = getPortByName(port_name_pattern)) {
+            candidates.push_back(port);
         }
-        names[index] = 0;
-        return (const char**)names;
     } else {
-        return 0;
+        for (std::map<jack_port_id_t, MetaJackPort*>::iterator i = portsById.begin(); i != portsById.end(); i++) {
+            MetaJackPort *port = i->second;
+            if ((port_name_pattern.length() == 0) || regexPortNames->exactMatch(port->getFullName().c_str())) {
+                candidates.push_back(port);
+            }
+        }
     }
+    std::vector<const std::string*> matchingNames;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        MetaJackPort *port = candidates[i];
+        if (((port->getFlags() & flags) == flags) && ((type_name_pattern.length() == 0) || (regexTypeNames ? regexTypeNames->exactMatch(port->getType().c_str()) : port->getType() == type_name_pattern))) {
+            // flags, port name and type match:
+            matchingNames.push_back(&port->getFullName());
+        }
+    }
+    return MetaJackNameTable::createNameArray(matchingNames);
 }
 
 MetaJackPort * MetaJackContext::getPortByName(const std::string &name) const {
-    std::map<std::string, MetaJackPort*>::const_iterator i = portsByName.find(name);
-    if (i != portsByName.end()) {
-        return i->second;
+    unsigned int id = names.find(name);
+    if (id < portsByName.size()) {
+        return portsByName[id];
     } else {
         return 0;
     }
@@ -555,13 +885,10 @@ MetaJackPort * MetaJackContext::getPortById(jack_port_id_t id)
 
 void * MetaJackContext::getPortBuffer(MetaJackPort *port, jack_nframes_t nframes)
 {
-    std::map<MetaJackPort*, MetaJackPortProcess*>::iterator find = processPorts.find(port);
-    if (find != processPorts.end()) {
-        MetaJackPortProcess *processPort = find->second;
-        return processPort->getBuffer(nframes);
-    } else {
-        return 0;
-    }
+    // the process twin is created with the port, so this does not need any lookup:
+    MetaJackPortProcess *processPort = port->getProcessPort();
+    assert(processPort);
+    return processPort->getBuffer(nframes);
 }
 
 void MetaJackContext::midi_init_buffer(void *port_buffer, size_t bufferSizeInBytes)
@@ -596,7 +923,7 @@ void MetaJackContext::midi_clear_buffer(void *port_buffer)
 size_t MetaJackContext::midi_max_event_size(void* port_buffer)
 {
     MetaJackContextMidiBufferHead *head = (MetaJackContextMidiBufferHead*)port_buffer;
-    return head->bufferSize - head->midiEventCount * sizeof(jack_midi_data_t) - head->midiDataSize;
+    return head->bufferSize - head->midiEventCount * sizeof(jack_midi_event_t) - head->midiDataSize;
 }
 
 jack_midi_data_t* MetaJackContext::midi_event_reserve(void *port_buffer, jack_nframes_t  time, size_t data_size)
@@ -604,7 +931,7 @@ jack_midi_data_t* MetaJackContext::midi_event_reserve(void *port_buffer, jack_nf
     MetaJackContextMidiBufferHead *head = (MetaJackContextMidiBufferHead*)port_buffer;
     char *charBuffer = (char*)port_buffer + sizeof(MetaJackContextMidiBufferHead);
     // check if enough space is left:
-    if (head->bufferSize >= (head->midiEventCount + 1) * sizeof(jack_midi_data_t) + head->midiDataSize + data_size) {
+    if (head->bufferSize >= (head->midiEventCount + 1) * sizeof(jack_midi_event_t) + head->midiDataSize + data_size) {
         jack_midi_event_t event;
         event.time = time;
         event.size = data_size;
@@ -639,51 +966,149 @@ jack_nframes_t MetaJackContext::midi_get_lost_event_count(void *port_buffer)
     return head->lostMidiEvents;
 }
 
+void MetaJackContext::midi_merge_buffer(void *port_buffer, void *source_port_buffer)
+{
+    MetaJackContextMidiBufferHead *head = (MetaJackContextMidiBufferHead*)port_buffer;
+    MetaJackContextMidiBufferHead *sourceHead = (MetaJackContextMidiBufferHead*)source_port_buffer;
+    jack_midi_event_t *events = (jack_midi_event_t*)((char*)port_buffer + sizeof(MetaJackContextMidiBufferHead));
+    jack_midi_event_t *sourceEvents = (jack_midi_event_t*)((char*)source_port_buffer + sizeof(MetaJackContextMidiBufferHead));
+    // find out how many of the source events fit into the buffer (the earliest ones are kept):
+    size_t freeSpace = midi_max_event_size(port_buffer);
+    jack_nframes_t sourceEventCount = 0;
+    size_t sourceDataSize = 0;
+    for (; sourceEventCount < sourceHead->midiEventCount; sourceEventCount++) {
+        size_t eventSize = sizeof(jack_midi_event_t) + sourceEvents[sourceEventCount].size;
+        if (eventSize > freeSpace) {
+            break;
+        }
+        freeSpace -= eventSize;
+        sourceDataSize += sourceEvents[sourceEventCount].size;
+    }
+    // the event data is reserved from the end of the buffer in event order, thus the data of the
+    // copied events is one block which can be copied below the data already in the buffer:
+    char *sourceData = (char*)sourceEvents + sourceHead->bufferSize - sourceDataSize;
+    head->midiDataSize += sourceDataSize;
+    char *data = (char*)events + head->bufferSize - head->midiDataSize;
+    memcpy(data, sourceData, sourceDataSize);
+    // merge both time-sorted event tables from the back, such that no temporary storage is needed
+    // (events with equal time keep their order, with the events already in the buffer first):
+    jack_nframes_t i = head->midiEventCount, j = sourceEventCount, k = head->midiEventCount + sourceEventCount;
+    for (; j; ) {
+        if (i && (events[i - 1].time > sourceEvents[j - 1].time)) {
+            events[--k] = events[--i];
+        } else {
+            events[--k] = sourceEvents[--j];
+            events[k].buffer = (jack_midi_data_t*)(data + ((char*)events[k].buffer - sourceData));
+        }
+    }
+    head->midiEventCount += sourceEventCount;
+    head->lostMidiEvents += sourceHead->midiEventCount - sourceEventCount;
+}
+
 bool MetaJackContext::compare_midi_events(const jack_midi_event_t &event1, const jack_midi_event_t &event2) {
     return event1.time < event2.time;
 }
 
 void MetaJackContext::sendGraphChangeEvent(const MetaJackGraphEvent &event)
 {
-    // write the event to the ring buffer:
-    graphChangesRingBuffer.write(event);
+    if (transaction && (event.type != MetaJackGraphEvent::APPLY_TRANSACTION)) {
+        // collect the event until the transaction is sent:
+        transaction->push_back(event);
+    } else {
+        // write the event to the ring buffer:
+        graphChangesRingBuffer.write(event);
+    }
+}
+
+void MetaJackContext::processGraphChangeEvent(const MetaJackGraphEvent &event)
+{
+    if (event.type == MetaJackGraphEvent::CLOSE_CLIENT) {
+        closeClient(event.client);
+    } else if (event.type == MetaJackGraphEvent::SET_PROCESS_CALLBACK) {
+        setProcessCallback(event.client, event.processCallback, event.processCallbackArgument);
+    } else if (event.type == MetaJackGraphEvent::SET_SILENCE_TAIL) {
+        setSilenceTail(event.client, event.silenceTail);
+    } else if (event.type == MetaJackGraphEvent::ACTIVATE_CLIENT) {
+        activateClient(event.client);
+    } else if (event.type == MetaJackGraphEvent::DEACTIVATE_CLIENT) {
+        deactivateClient(event.client);
+        waitCondition.wakeAll();
+    } else if (event.type == MetaJackGraphEvent::REGISTER_PORT) {
+        registerPort(event.client, event.port);
+    } else if (event.type == MetaJackGraphEvent::UNREGISTER_PORT) {
+        unregisterPort(event.port);
+    } else if (event.type == MetaJackGraphEvent::RENAME_PORT) {
+        renamePort(event.port, event.shortName);
+    } else if (event.type == MetaJackGraphEvent::CONNECT_PORTS) {
+        connectPorts(event.port, event.connectedPort);
+    } else if (event.type == MetaJackGraphEvent::DISCONNECT_PORTS) {
+        disconnectPorts(event.port, event.connectedPort);
+    } else if (event.type == MetaJackGraphEvent::SET_SCHEDULE) {
+        setSchedule(event.schedule);
+    } else if (event.type == MetaJackGraphEvent::SET_THREAD_POOL) {
+        setThreadPool(event.threadPool);
+        setSchedule(event.schedule);
+    } else if (event.type == MetaJackGraphEvent::APPLY_TRANSACTION) {
+        for (std::vector<MetaJackGraphEvent>::const_iterator i = event.transaction->begin(); i != event.transaction->end(); i++) {
+            processGraphChangeEvent(*i);
+        }
+        // the transaction will be deleted outside the process thread:
+        retiredTransactionsRingBuffer.write(event.transaction);
+    }
 }
 
 int MetaJackContext::process(jack_nframes_t nframes)
 {
     // first get all changes to the graph since the last call:
+    processGraphChangeEvents();
+    // call all process callbacks registered by internal clients in the precompiled order (concurrently if possible):
+    bool success = true;
+    if (schedule) {
+        success = (threadPool ? threadPool->process(schedule, nframes) : schedule->process(nframes));
+    }
+    // all clients are done with this cycle, so their load statistics can be read:
+    if (clientLoadTimer.hasExpired(250)) {
+        publishClientLoads(nframes);
+        clientLoadTimer.start();
+    }
+    return (success ? 0 : 1);
+}
+
+void MetaJackContext::processGraphChangeEvents()
+{
     for (; graphChangesRingBuffer.readSpace(); ) {
-        MetaJackGraphEvent event = graphChangesRingBuffer.read();
-        if (event.type == MetaJackGraphEvent::CLOSE_CLIENT) {
-            closeClient(event.client);
-        } else if (event.type == MetaJackGraphEvent::SET_PROCESS_CALLBACK) {
-            setProcessCallback(event.client, event.processCallback, event.processCallbackArgument);
-        } else if (event.type == MetaJackGraphEvent::ACTIVATE_CLIENT) {
-            activateClient(event.client);
-        } else if (event.type == MetaJackGraphEvent::DEACTIVATE_CLIENT) {
-            deactivateClient(event.client);
-            waitCondition.wakeAll();
-        } else if (event.type == MetaJackGraphEvent::REGISTER_PORT) {
-            registerPort(event.client, event.port, event.nonProcessPort);
-        } else if (event.type == MetaJackGraphEvent::UNREGISTER_PORT) {
-            unregisterPort(event.port, event.nonProcessPort);
-        } else if (event.type == MetaJackGraphEvent::RENAME_PORT) {
-            renamePort(event.port, event.shortName);
-        } else if (event.type == MetaJackGraphEvent::CONNECT_PORTS) {
-            connectPorts(event.port, event.connectedPort);
-        } else if (event.type == MetaJackGraphEvent::DISCONNECT_PORTS) {
-            disconnectPorts(event.port, event.connectedPort);
+        processGraphChangeEvent(graphChangesRingBuffer.read());
+    }
+}
+
+void MetaJackContext::publishClientLoads(jack_nframes_t nframes)
+{
+    qint64 period = (qint64)nframes * 1000000000 / get_sample_rate(wrapperClient);
+    for (std::set<MetaJackClientProcess*>::iterator i = activeClients.begin(); i != activeClients.end(); i++) {
+        MetaJackClientProcess *client = *i;
+        MetaJackClientLoad &load = client->getLoad();
+        // skip clients which have not been processed since the last time:
+        if (!load.getCycles()) {
+            continue;
+        }
+        // drop the statistics if the ring buffer is full, i.e. nobody reads them:
+        if (clientLoadRingBuffer.writeSpace()) {
+            MetaJackClientLoadEvent event;
+            event.client = client;
+            event.statistics = load.getStatistics(period);
+            clientLoadRingBuffer.write(event);
         }
+        load.reset();
     }
-    // evaluate the graph structure and call all process callbacks registered by internal clients:
-    std::set<MetaJackClientProcess*> unprocessedClients = activeClients;
-    bool success = true;
-    for (; success && unprocessedClients.size(); ) {
-        // get an arbitrary client and process it:
-        MetaJackClientProcess *client = *unprocessedClients.begin();
-        success = client->process(unprocessedClients, nframes);
+}
+
+void MetaJackContext::readClientLoads()
+{
+    // only the latest statistics of each client are kept:
+    for (; clientLoadRingBuffer.readSpace(); ) {
+        MetaJackClientLoadEvent event = clientLoadRingBuffer.read();
+        clientLoads[event.client] = event.statistics;
     }
-    return (success ? 0 : 1);
 }
 
 int MetaJackContext::process(jack_nframes_t nframes, void *arg)
@@ -708,11 +1133,15 @@ int MetaJackContext::bufferSizeCallback(jack_nframes_t bufferSize, void *arg)
 {
     MetaJackContext *context = (MetaJackContext*)arg;
     context->bufferSize = bufferSize * context->oversampling;
-    // change all ports' buffer sizes:
-    for (std::map<jack_port_id_t, MetaJackPort*>::iterator i = context->portsById.begin(); i != context->portsById.end(); i++) {
-        MetaJackPort *port = i->second;
-        port->getProcessPort()->changeBufferSize(context->bufferSize);
+    // the ports' buffers are in the schedule's arena, which is reallocated at once:
+    if (context->schedule) {
+        context->schedule->changeBufferSize(context->bufferSize);
     }
+    context->audioSilencePort->changeBufferSize(context->bufferSize);
+    context->audioSilencePort->clearBuffer();
+    context->midiSilencePort->changeBufferSize(context->bufferSize);
+    context->audioScratchPort->changeBufferSize(context->bufferSize);
+    context->midiScratchPort->changeBufferSize(context->bufferSize);
     // now invoke all callbacks registered by the internal clients:
     context->bufferSizeCallbackHandler.invokeCallbacksWithArgs(context->bufferSize);
     return 0;
@@ -1133,13 +1562,8 @@ void MetaJackContext::set_info_function (void (*func)(const char *))
 
 void MetaJackContext::free(void* ptr)
 {
-    if (ptr) {
-        char **names = (char**)ptr;
-        for (size_t index = 0; names[index]; index++) {
-            delete [] names[index];
-        }
-        delete [] names;
-    }
+    // all name arrays are created by MetaJackNameTable::createNameArray():
+    MetaJackNameTable::deleteNameArray((const char**)ptr);
 }
 
 int MetaJackContext::release_timebase (jack_client_t *client)
@@ -1202,3 +1626,18 @@ void MetaJackContext::set_transport_info (jack_client_t *client, jack_transport_
 {
     wrapperInterface->set_transport_info(wrapperClient, tinfo);
 }
+
+int MetaJackContext::client_real_time_priority (jack_client_t *client)
+{
+    return wrapperInterface->client_real_time_priority(wrapperClient);
+}
+
+int MetaJackContext::client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg)
+{
+    return wrapperInterface->client_create_thread(wrapperClient, thread, priority, realtime, start_routine, arg);
+}
+
+int MetaJackContext::client_stop_thread (jack_client_t *client, jack_native_thread_t thread)
+{
+    return wrapperInterface->client_stop_thread(wrapperClient, thread);
+}
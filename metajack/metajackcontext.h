@@ -24,11 +24,18 @@
 #include "midiport.h"
 #include "metajackclient.h"
 #include "metajackport.h"
+#include "metajackschedule.h"
+#include "metajackthreadpool.h"
 #include "callbackhandlers.h"
 #include "jackringbuffer.h"
+#include "metajackclientload.h"
+#include "metajacknametable.h"
 #include <map>
+#include <vector>
 #include <QWaitCondition>
+#include <QRegExp>
 #include <QMutex>
+#include <QElapsedTimer>
 
 class MetaJackContext : public JackContext
 {
@@ -40,7 +47,11 @@ public:
         jack_nframes_t lostMidiEvents;
     };
 
-    MetaJackContext(JackContext *wrapperInterface, const std::string &name, unsigned int oversampling = 1);
+    /**
+      Creates the wrapper client and activates it. The worker threads for the
+      given thread count (see setThreadCount()) are created right after that.
+      */
+    MetaJackContext(JackContext *wrapperInterface, const std::string &name, unsigned int oversampling = 1, unsigned int threadCount = 1);
     virtual ~MetaJackContext();
 
     jack_port_t * createWrapperPort(const std::string &shortName, const std::string &type, unsigned long flags);
@@ -50,9 +61,65 @@ public:
     JackContext * getWrapperInterface();
     bool hasWrapperPorts() const;
     unsigned int getOversampling() const;
+    /**
+      Sets the quality of the resamplers used to convert audio between the
+      wrapper client's sample rate and the oversampled rate inside this context.
+      This only affects wrapper ports connected after the call. The quality
+      is saved together with the oversampling factor by
+      RecursiveJackContext::saveCurrentContext().
+      */
+    void setResamplingQuality(PolyphaseResampler::Quality quality);
+    PolyphaseResampler::Quality getResamplingQuality() const;
+
+    /**
+      Sets the number of threads which process the internal clients, including
+      the wrapper client's process thread. With more than one thread, clients
+      which do not depend on each other are processed concurrently by additional
+      worker threads. With one thread (the default), all clients are processed
+      serially by the process thread.
+
+      The worker threads are bound to the wrapper client, so they only exist
+      while the context is active.
+      */
+    void setThreadCount(unsigned int threadCount);
+    unsigned int getThreadCount() const;
+
+    /**
+      Stops processing the internal clients by deactivating the wrapper client,
+      and applies the graph changes the process thread has not applied yet.
+      From then on, changes to the graph are applied directly, which is needed
+      to tear down a context whose wrapper is not processed anymore, like an
+      offline context when rendering is done. The destructor calls this
+      implicitly.
+      */
+    void stopProcessing();
 
     bool isActive() const;
 
+    /**
+      Gets the most recent statistics of the time the given client's process
+      callback took per cycle. The process thread publishes them about four
+      times per second. This must not be called from the process thread.
+
+      @return false, if no statistics have been published for the client yet
+      */
+    bool getClientLoad(MetaJackClient *client, MetaJackClientLoad::Statistics &statistics);
+    /**
+      Lets the given client's process callback be skipped while its inputs
+      and outputs are silent (see MetaJackClientProcess::setSilenceTail()).
+
+      @param silenceTail the number of frames the client's outputs may still
+        sound after its inputs became silent, or JACK_MAX_FRAMES if the client
+        must always be processed (e.g. because it generates sound by itself)
+      */
+    bool setSilenceTail(MetaJackClient *client, jack_nframes_t silenceTail);
+    /**
+      Makes sure the given client is processed in the next cycles, even if it
+      is idle, e.g. because its parameters changed. This can be called from
+      any thread except the process thread.
+      */
+    void wakeClient(MetaJackClient *client);
+
     jack_port_id_t createUniquePortId();
 
     // create and delete clients:
@@ -69,6 +136,21 @@ public:
     bool connectPorts(const std::string &source_port, const std::string &destination_port);
     bool disconnectPorts(const std::string &source_port, const std::string &destination_port);
 
+    /**
+      Starts collecting the changes done by the methods above, instead of
+      sending each one of them to the process thread separately.
+      commitGraphTransaction() sends all of them at once, such that the process
+      thread applies them within the same cycle, and compiles the execution
+      order only once for all of them. This is meant for many changes in a row,
+      like when loading a session.
+
+      Transactions may be nested, only the outermost commit sends the changes.
+      Deactivating (and thus closing) a client has to wait for the process thread,
+      so it sends the changes collected so far.
+      */
+    void beginGraphTransaction();
+    void commitGraphTransaction();
+
     // client- and port-related methods:
     const char ** getPortsByPattern(const std::string &port_name_pattern, const std::string &type_name_pattern, unsigned long flags);
     MetaJackPort * getPortByName(const std::string &name) const;
@@ -91,6 +173,8 @@ public:
     static jack_midi_data_t * midi_event_reserve(void *port_buffer, jack_nframes_t time, size_t data_size);
     static int midi_event_write(void *port_buffer, jack_nframes_t time, const jack_midi_data_t *data, size_t data_size);
     static jack_nframes_t midi_get_lost_event_count(void *port_buffer);
+    // merges the time-sorted events of the source buffer into the (time-sorted) port buffer without memory allocation:
+    static void midi_merge_buffer(void *port_buffer, void *source_port_buffer);
     static bool compare_midi_events(const jack_midi_event_t &event1, const jack_midi_event_t &event2);
 
     // callback handlers for the internal clients:
@@ -115,20 +199,32 @@ private:
         enum {
             CLOSE_CLIENT,
             SET_PROCESS_CALLBACK,
+            SET_SILENCE_TAIL,
             ACTIVATE_CLIENT,
             DEACTIVATE_CLIENT,
             REGISTER_PORT,
             UNREGISTER_PORT,
             CONNECT_PORTS,
             DISCONNECT_PORTS,
-            RENAME_PORT
+            RENAME_PORT,
+            SET_SCHEDULE,
+            SET_THREAD_POOL,
+            APPLY_TRANSACTION
         } type;
         MetaJackClientProcess *client;
         MetaJackPortProcess *port, *connectedPort;
-        MetaJackPort *nonProcessPort;
         JackProcessCallback processCallback;
         void * processCallbackArgument;
-        std::string shortName;
+        jack_nframes_t silenceTail;
+        MetaJackSchedule *schedule;
+        MetaJackThreadPool *threadPool;
+        std::vector<MetaJackGraphEvent> *transaction;
+        // an interned name, such that events can be copied through the ring buffer as plain data:
+        const char *shortName;
+    };
+    struct MetaJackClientLoadEvent {
+        MetaJackClientProcess *client;
+        MetaJackClientLoad::Statistics statistics;
     };
 
     JackContext *wrapperInterface;
@@ -138,29 +234,79 @@ private:
     jack_nframes_t bufferSize;
     jack_port_id_t uniquePortId;
     std::map<std::string, MetaJackClient*> clients;
-    std::map<std::string, MetaJackPort*> portsByName;
+    // the full port names (and short names sent to the process thread) are interned:
+    MetaJackNameTable names;
+    // the ports by the ids of their full names (zero for names not used by a port anymore):
+    std::vector<MetaJackPort*> portsByName;
     std::map<jack_port_id_t, MetaJackPort*> portsById;
-    std::map<MetaJackPort*,MetaJackPortProcess*> processPorts;
+    // the compiled regular expressions of the port name and type patterns used recently:
+    std::map<std::string, QRegExp> patterns;
     std::set<MetaJackClientProcess*> activeClients;
+    // silent buffers shared by all input ports without connections:
+    MetaJackPortProcess *audioSilencePort, *midiSilencePort;
+    // buffers used by ports which have none in the schedule's arena (e.g. of inactive clients):
+    MetaJackPortProcess *audioScratchPort, *midiScratchPort;
+    MetaJackSchedule *schedule;
+    unsigned int threadCount;
+    MetaJackThreadPool *threadPool;
     JackRingBuffer<MetaJackGraphEvent> graphChangesRingBuffer;
+    JackRingBuffer<MetaJackSchedule*> retiredSchedulesRingBuffer;
+    JackRingBuffer<MetaJackThreadPool*> retiredThreadPoolsRingBuffer;
+    // the changes collected by the open transaction (only if active), and how many transactions are open:
+    std::vector<MetaJackGraphEvent> *transaction;
+    int transactionDepth;
+    bool transactionChangesSchedule;
+    JackRingBuffer<std::vector<MetaJackGraphEvent>*> retiredTransactionsRingBuffer;
+    // client load statistics, published by the process thread:
+    JackRingBuffer<MetaJackClientLoadEvent> clientLoadRingBuffer;
+    QElapsedTimer clientLoadTimer;
+    std::map<MetaJackClientProcess*, MetaJackClientLoad::Statistics> clientLoads;
     QWaitCondition waitCondition;
     QMutex waitMutex;
     bool shutdown;
+    bool processing;
     unsigned int oversampling;
+    PolyphaseResampler::Quality resamplingQuality;
     std::string contextName;
 
     void closeClient(MetaJackClientProcess *client);
     void setProcessCallback(MetaJackClientProcess *client, JackProcessCallback processCallback, void *processCallbackArgument);
+    void setSilenceTail(MetaJackClientProcess *client, jack_nframes_t silenceTail);
     void activateClient(MetaJackClientProcess *client);
     void deactivateClient(MetaJackClientProcess *client);
-    void registerPort(MetaJackClientProcess *client, MetaJackPortProcess *port, MetaJackPort *nonProcessPort);
-    void unregisterPort(MetaJackPortProcess *port, MetaJackPort *nonProcessPort);
-    void renamePort(MetaJackPortProcess *port, const std::string &shortName);
+    void registerPort(MetaJackClientProcess *client, MetaJackPortProcess *port);
+    void unregisterPort(MetaJackPortProcess *port);
+    void renamePort(MetaJackPortProcess *port, const char *shortName);
     void connectPorts(MetaJackPortProcess *source, MetaJackPortProcess *dest);
     void disconnectPorts(MetaJackPortProcess *source, MetaJackPortProcess *dest);
+    void setSchedule(MetaJackSchedule *schedule);
+    void setThreadPool(MetaJackThreadPool *threadPool);
+
+    // true, if graph changes have to be sent to the process thread (otherwise they are applied directly):
+    bool isProcessing() const;
+    // recompile the execution order after a graph change (not called from the process thread):
+    void compileSchedule(MetaJackPort *excludedPort = 0);
+    void deleteRetiredSchedules();
+    void deleteRetiredThreadPools();
+    void deleteRetiredTransactions();
+    // maintain the lookup of ports by their full names (not called from the process thread):
+    void addPortName(MetaJackPort *port);
+    void removePortName(const std::string &fullName);
+    const QRegExp & getPattern(const std::string &pattern);
+    static bool isPlainPattern(const std::string &pattern);
+    // publish the active clients' load statistics (called from the process thread):
+    void publishClientLoads(jack_nframes_t nframes);
+    // read the published statistics (not called from the process thread):
+    void readClientLoads();
 
     // signal graph change:
     void sendGraphChangeEvent(const MetaJackGraphEvent &event);
+    // send the changes collected by the open transaction and keep it open:
+    void sendGraphTransaction();
+    // apply a graph change (called from the process thread):
+    void processGraphChangeEvent(const MetaJackGraphEvent &event);
+    // apply the changes sent so far (called from the process thread, or when there is none):
+    void processGraphChangeEvents();
 
     int process(jack_nframes_t nframes);
     static int process(jack_nframes_t nframes, void *arg);
@@ -257,6 +403,10 @@ public:
     virtual void transport_stop (jack_client_t *client);
     virtual void get_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
     virtual void set_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
+    // Jack thread API methods:
+    virtual int client_real_time_priority (jack_client_t *client);
+    virtual int client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg);
+    virtual int client_stop_thread (jack_client_t *client, jack_native_thread_t thread);
 };
 
 #endif // METAJACKCONTEXTNEW_H
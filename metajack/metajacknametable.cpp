@@ -0,0 +1,120 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "metajacknametable.h"
+#include <cassert>
+#include <memory.h>
+
+const unsigned int MetaJackNameTable::NOT_FOUND;
+
+MetaJackNameTable::MetaJackNameTable() :
+    slots(64, 0)
+{
+}
+
+unsigned int MetaJackNameTable::intern(const std::string &name)
+{
+    size_t slot = findSlot(name);
+    if (slots[slot]) {
+        return slots[slot] - 1;
+    }
+    unsigned int id = names.size();
+    names.push_back(name);
+    slots[slot] = id + 1;
+    // keep the load factor below one half, such that probe sequences stay short:
+    if (names.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+unsigned int MetaJackNameTable::find(const std::string &name) const
+{
+    size_t slot = findSlot(name);
+    return (slots[slot] ? slots[slot] - 1 : NOT_FOUND);
+}
+
+const std::string & MetaJackNameTable::getName(unsigned int id) const
+{
+    assert(id < names.size());
+    return names[id];
+}
+
+size_t MetaJackNameTable::size() const
+{
+    return names.size();
+}
+
+const char ** MetaJackNameTable::createNameArray(const std::vector<const std::string*> &names)
+{
+    if (names.empty()) {
+        return 0;
+    }
+    // the pointers come first, followed by the characters of all names:
+    size_t pointersSize = (names.size() + 1) * sizeof(char*);
+    size_t size = pointersSize;
+    for (size_t i = 0; i < names.size(); i++) {
+        size += names[i]->length() + 1;
+    }
+    char *memory = new char[size];
+    char **pointers = (char**)memory;
+    char *characters = memory + pointersSize;
+    for (size_t i = 0; i < names.size(); i++) {
+        pointers[i] = characters;
+        memcpy(characters, names[i]->c_str(), names[i]->length() + 1);
+        characters += names[i]->length() + 1;
+    }
+    pointers[names.size()] = 0;
+    return (const char**)pointers;
+}
+
+void MetaJackNameTable::deleteNameArray(const char **names)
+{
+    delete [] (char*)names;
+}
+
+size_t MetaJackNameTable::findSlot(const std::string &name) const
+{
+    // the number of slots is a power of two:
+    size_t mask = slots.size() - 1;
+    size_t slot = hash(name) & mask;
+    for (; slots[slot] && (names[slots[slot] - 1] != name); slot = (slot + 1) & mask);
+    return slot;
+}
+
+void MetaJackNameTable::grow()
+{
+    std::vector<unsigned int> oldSlots;
+    oldSlots.swap(slots);
+    slots.assign(oldSlots.size() * 2, 0);
+    for (size_t i = 0; i < oldSlots.size(); i++) {
+        if (oldSlots[i]) {
+            slots[findSlot(names[oldSlots[i] - 1])] = oldSlots[i];
+        }
+    }
+}
+
+size_t MetaJackNameTable::hash(const std::string &name)
+{
+    // 32 bit FNV-1a:
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < name.length(); i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,73 @@
+#ifndef METAJACKNAMETABLE_H
+#define METAJACKNAMETABLE_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <deque>
+#include <vector>
+
+/**
+  Interns names (like full port names), i.e. gives each distinct name a
+  small integer id and keeps a single copy of it. Names are looked up
+  through a hash table with open addressing.
+
+  Interned names are never removed, so their ids and the addresses of
+  the interned strings stay valid as long as the table exists. This allows
+  passing an interned name to the process thread as a plain pointer.
+  This class is not thread-safe otherwise.
+  */
+class MetaJackNameTable {
+public:
+    static const unsigned int NOT_FOUND = ~0u;
+
+    MetaJackNameTable();
+
+    /**
+      @return the id of the given name, which is added to the table if necessary
+      */
+    unsigned int intern(const std::string &name);
+    /**
+      @return the id of the given name, or NOT_FOUND if it has not been interned
+      */
+    unsigned int find(const std::string &name) const;
+    const std::string & getName(unsigned int id) const;
+    size_t size() const;
+
+    /**
+      Creates a zero-terminated array of names as returned by jack_get_ports()
+      within a single allocation. Delete it with deleteNameArray().
+
+      @return zero, if the given list is empty (like Jack does)
+      */
+    static const char ** createNameArray(const std::vector<const std::string*> &names);
+    static void deleteNameArray(const char **names);
+
+private:
+    std::deque<std::string> names;
+    // contains the id + 1 of the name at each slot, zero for empty slots:
+    std::vector<unsigned int> slots;
+
+    size_t findSlot(const std::string &name) const;
+    void grow();
+    static size_t hash(const std::string &name);
+};
+
+#endif // METAJACKNAMETABLE_H
@@ -20,9 +20,11 @@
 #include "metajackport.h"
 #include "metajackclient.h"
 #include "metajackcontext.h"
+#include "mixingkernels.h"
+#include "metajacknametable.h"
 #include <sstream>
 #include <cassert>
-#include <list>
+#include <algorithm>
 #include <memory.h>
 
 MetaJackPortBase::MetaJackPortBase(jack_port_id_t id_, const std::string &shortName_, const std::string &type_, int flags_) :
@@ -116,19 +118,11 @@ bool MetaJackPortBase::isIndirectInputOf(MetaJackPortBase *port) const
 
 const char ** MetaJackPortBase::getConnections() const
 {
-    if (getConnectionCount()) {
-        char ** names = new char*[getConnectionCount() + 1];
-        size_t index = 0;
-        for (std::set<MetaJackPortBase*>::const_iterator i = connectedPorts.begin(); i != connectedPorts.end(); i++, index++) {
-            MetaJackPortBase *port = *i;
-            names[index] = new char[port->getFullName().length() + 1];
-            memcpy(names[index], port->getFullName().c_str(), port->getFullName().length() + 1);
-        }
-        names[index] = 0;
-        return (const char**)names;
-    } else {
-        return 0;
+    std::vector<const std::string*> names;
+    for (std::set<MetaJackPortBase*>::const_iterator i = connectedPorts.begin(); i != connectedPorts.end(); i++) {
+        names.push_back(&(*i)->getFullName());
     }
+    return MetaJackNameTable::createNameArray(names);
 }
 
 void MetaJackPortBase::disconnect()
@@ -169,29 +163,59 @@ const std::set<MetaJackPortBase*> & MetaJackPortBase::getConnectedPorts()
 MetaJackPortProcess::MetaJackPortProcess(jack_port_id_t id, const std::string &shortName, const std::string &type, int flags, jack_nframes_t bufferSize) :
     MetaJackPortBase(id, shortName, type, flags),
     bufferSizeInBytes(0),
-    buffer(0)
+    bufferMemory(0),
+    buffer(0),
+    silencePort(0),
+    scratchPort(0),
+    silent(true)
 {
     changeBufferSize(bufferSize);
 }
 
+MetaJackPortProcess::MetaJackPortProcess(jack_port_id_t id, const std::string &shortName, const std::string &type, int flags, MetaJackPortProcess *silencePort_, MetaJackPortProcess *scratchPort_) :
+    MetaJackPortBase(id, shortName, type, flags),
+    bufferSizeInBytes(0),
+    bufferMemory(0),
+    buffer(0),
+    silencePort(silencePort_),
+    scratchPort(scratchPort_),
+    silent(false)
+{
+    assert(scratchPort);
+}
+
 MetaJackPortProcess::~MetaJackPortProcess()
 {
-    delete [] buffer;
+    delete [] bufferMemory;
 }
 
 void * MetaJackPortProcess::getBuffer(jack_nframes_t nframes)
 {
     // this will be called from the process thread, so no memory allocation must be done here!
-    assert(nframes * sizeof(jack_default_audio_sample_t) <= bufferSizeInBytes);
-    return buffer;
+    if (isInput()) {
+        // hand out the buffers of other ports instead of copying them:
+        if (connectedPorts.size() == 1) {
+            MetaJackPortProcess *connectedPort = (MetaJackPortProcess*)*connectedPorts.begin();
+            assert(nframes * sizeof(jack_default_audio_sample_t) <= connectedPort->getAssignedBufferSize());
+            return connectedPort->getAssignedBuffer();
+        } else if (connectedPorts.empty() && silencePort) {
+            return silencePort->buffer;
+        }
+    }
+    assert(nframes * sizeof(jack_default_audio_sample_t) <= getAssignedBufferSize());
+    return getAssignedBuffer();
 }
 
 void MetaJackPortProcess::changeBufferSize(jack_nframes_t bufferSize)
 {
+    // only ports without a scratch port own their buffer:
+    assert(!scratchPort);
     if (bufferSizeInBytes != bufferSize * sizeof(jack_default_audio_sample_t)) {
-        if (buffer) delete [] buffer;
+        if (bufferMemory) delete [] bufferMemory;
         bufferSizeInBytes = bufferSize * sizeof(jack_default_audio_sample_t);
-        buffer = new char [bufferSizeInBytes];
+        // allocate enough memory to align the buffer for the mixing kernels:
+        bufferMemory = new char [bufferSizeInBytes + MixingKernels::ALIGNMENT - 1];
+        buffer = bufferMemory + (MixingKernels::ALIGNMENT - (size_t)bufferMemory % MixingKernels::ALIGNMENT) % MixingKernels::ALIGNMENT;
         // if this is a MIDI port, write its size to the head of the buffer:
         if (getType() == JACK_DEFAULT_MIDI_TYPE) {
             MetaJackContext::midi_init_buffer(buffer, bufferSizeInBytes);
@@ -199,14 +223,30 @@ void MetaJackPortProcess::changeBufferSize(jack_nframes_t bufferSize)
     }
 }
 
+void MetaJackPortProcess::setBuffer(char *buffer_, size_t bufferSizeInBytes_, bool keepContents)
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    assert(scratchPort);
+    // the previous buffer is still allocated at this point (see MetaJackContext::setSchedule()):
+    if (keepContents && buffer && buffer_ && (buffer != buffer_) && (getType() == JACK_DEFAULT_AUDIO_TYPE)) {
+        MixingKernels::copy((jack_default_audio_sample_t*)buffer_, (jack_default_audio_sample_t*)buffer, std::min(bufferSizeInBytes, bufferSizeInBytes_) / sizeof(jack_default_audio_sample_t));
+    }
+    buffer = buffer_;
+    bufferSizeInBytes = (buffer ? bufferSizeInBytes_ : 0);
+    // the buffer may have been used by another port before, thus write the size of a MIDI buffer again:
+    if (buffer && (getType() == JACK_DEFAULT_MIDI_TYPE)) {
+        MetaJackContext::midi_init_buffer(buffer, bufferSizeInBytes);
+    }
+}
+
 bool MetaJackPortProcess::clearBuffer()
 {
     if (getType() == JACK_DEFAULT_AUDIO_TYPE) {
         // clearing means setting everything to zero:
-        memset(buffer, 0, bufferSizeInBytes);
+        MixingKernels::zero((jack_default_audio_sample_t*)getAssignedBuffer(), getAssignedBufferSize() / sizeof(jack_default_audio_sample_t));
         return true;
     } else if (getType() == JACK_DEFAULT_MIDI_TYPE) {
-        MetaJackContext::midi_clear_buffer(buffer);
+        MetaJackContext::midi_clear_buffer(getAssignedBuffer());
         return true;
     } else {
         return false;
@@ -216,40 +256,37 @@ bool MetaJackPortProcess::clearBuffer()
 bool MetaJackPortProcess::mergeConnectedBuffers()
 {
     assert(isInput());
-    // first clear the buffer:
-    if (!clearBuffer()) {
-        return false;
+    if ((connectedPorts.size() == 1) || (connectedPorts.empty() && silencePort)) {
+        // getBuffer() returns a shared buffer in these cases, nothing to merge:
+        return true;
+    }
+    char *destBuffer = getAssignedBuffer();
+    // the merged buffer is silent if all connected buffers are:
+    silent = true;
+    for (std::set<MetaJackPortBase*>::iterator i = connectedPorts.begin(); silent && (i != connectedPorts.end()); i++) {
+        silent = ((MetaJackPortProcess*)*i)->silent;
     }
     if (getType() == JACK_DEFAULT_AUDIO_TYPE) {
-        jack_default_audio_sample_t *destBuffer = (jack_default_audio_sample_t*)buffer;
-        size_t nframes = bufferSizeInBytes / sizeof(jack_default_audio_sample_t);
-        // add audio from all connected output buffers:
-        for (std::set<MetaJackPortBase*>::iterator i = connectedPorts.begin(); i != connectedPorts.end(); i++) {
-            MetaJackPortProcess *connectedPort = (MetaJackPortProcess*)*i;
-            jack_default_audio_sample_t *sourceBuffer = (jack_default_audio_sample_t*)connectedPort->buffer;
-            for (jack_nframes_t j = 0; j < nframes; j++) {
-                destBuffer[j] += sourceBuffer[j];
-            }
+        size_t nframes = getAssignedBufferSize() / sizeof(jack_default_audio_sample_t);
+        // sum the connected output buffers in one pass (this also overwrites the previous contents):
+        const jack_default_audio_sample_t *sourceBuffers[MixingKernels::MAX_SUM_SOURCES];
+        size_t sourceCount = 0;
+        std::set<MetaJackPortBase*>::iterator i = connectedPorts.begin();
+        for (; (i != connectedPorts.end()) && (sourceCount < MixingKernels::MAX_SUM_SOURCES); i++, sourceCount++) {
+            sourceBuffers[sourceCount] = (jack_default_audio_sample_t*)((MetaJackPortProcess*)*i)->getAssignedBuffer();
+        }
+        MixingKernels::sum((jack_default_audio_sample_t*)destBuffer, sourceBuffers, sourceCount, nframes);
+        // add any remaining output buffers one by one:
+        for (; i != connectedPorts.end(); i++) {
+            MixingKernels::add((jack_default_audio_sample_t*)destBuffer, (jack_default_audio_sample_t*)((MetaJackPortProcess*)*i)->getAssignedBuffer(), nframes);
         }
         return true;
     } else if (getType() == JACK_DEFAULT_MIDI_TYPE) {
-        // first collect all midi events from connected output buffers:
-        std::list<jack_midi_event_t> events;
+        MetaJackContext::midi_clear_buffer(destBuffer);
+        // the events in each connected output buffer are already sorted by time, merge them one by one into the input buffer:
         for (std::set<MetaJackPortBase*>::iterator i = connectedPorts.begin(); i != connectedPorts.end(); i++) {
             MetaJackPortProcess *connectedPort = (MetaJackPortProcess*)*i;
-            void *midiOutputBuffer = connectedPort->buffer;
-            for (jack_nframes_t j = 0; j < MetaJackContext::midi_get_event_count(midiOutputBuffer); j++) {
-                jack_midi_event_t event;
-                MetaJackContext::midi_event_get(&event, midiOutputBuffer, j);
-                events.push_back(event);
-            }
-        }
-        // now sort the events by time:
-        events.sort(MetaJackContext::compare_midi_events);
-        // write them to the input buffer:
-        void *midiInputBuffer = buffer;
-        for (std::list<jack_midi_event_t>::iterator i = events.begin(); i != events.end(); i++) {
-            MetaJackContext::midi_event_write(midiInputBuffer, i->time, i->buffer, i->size);
+            MetaJackContext::midi_merge_buffer(destBuffer, connectedPort->getAssignedBuffer());
         }
         return true;
     } else {
@@ -257,21 +294,47 @@ bool MetaJackPortProcess::mergeConnectedBuffers()
     }
 }
 
-bool MetaJackPortProcess::process(std::set<MetaJackClientProcess*> &unprocessedClients, jack_nframes_t nframes)
+bool MetaJackPortProcess::isSilent() const
 {
-    assert(isInput());
-    // process all other clients that are connected to this input:
-    for (std::set<MetaJackPortBase*>::iterator j = connectedPorts.begin(); j != connectedPorts.end(); j++) {
-        MetaJackPortProcess *connectedPort = (MetaJackPortProcess*)*j;
-        MetaJackClientProcess *client = (MetaJackClientProcess*)connectedPort->getClient();
-        if (unprocessedClients.find(client) != unprocessedClients.end()) {
-            if (!client->process(unprocessedClients, nframes)) {
-                return false;
-            }
+    if (isInput()) {
+        // see getBuffer():
+        if (connectedPorts.size() == 1) {
+            return ((MetaJackPortProcess*)*connectedPorts.begin())->silent;
+        } else if (connectedPorts.empty() && silencePort) {
+            return true;
         }
     }
-    // merge all buffers connected to this input port:
-    return mergeConnectedBuffers();
+    return silent;
+}
+
+void MetaJackPortProcess::setSilent(bool silent)
+{
+    this->silent = silent;
+}
+
+void MetaJackPortProcess::detectSilence(jack_nframes_t nframes)
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    assert(!isInput());
+    if (getType() == JACK_DEFAULT_AUDIO_TYPE) {
+        // -120 dB, which is below the noise of any 24 bit converter:
+        silent = MixingKernels::isSilent((jack_default_audio_sample_t*)getAssignedBuffer(), 1e-6f, nframes);
+    } else if (getType() == JACK_DEFAULT_MIDI_TYPE) {
+        silent = (MetaJackContext::midi_get_event_count(getAssignedBuffer()) == 0);
+    } else {
+        silent = false;
+    }
+}
+
+char * MetaJackPortProcess::getAssignedBuffer()
+{
+    // ports without an assigned buffer (e.g. of inactive clients) use the scratch buffer:
+    return (buffer ? buffer : scratchPort->buffer);
+}
+
+size_t MetaJackPortProcess::getAssignedBufferSize() const
+{
+    return (buffer ? bufferSizeInBytes : scratchPort->bufferSizeInBytes);
 }
 
 MetaJackPort::MetaJackPort(MetaJackClient *client, jack_port_id_t id, const std::string &shortName, const std::string &type, int flags) :
@@ -281,10 +344,10 @@ MetaJackPort::MetaJackPort(MetaJackClient *client, jack_port_id_t id, const std:
     setClient(client);
 }
 
-void MetaJackPort::createProcessPort(jack_nframes_t bufferSize)
+void MetaJackPort::createProcessPort(MetaJackPortProcess *silencePort, MetaJackPortProcess *scratchPort)
 {
     if (!twin) {
-        twin = new MetaJackPortProcess(getId(), getShortName(), getType(), getFlags(), bufferSize);
+        twin = new MetaJackPortProcess(getId(), getShortName(), getType(), getFlags(), silencePort, scratchPort);
     }
 }
 
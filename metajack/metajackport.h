@@ -61,22 +61,74 @@ private:
 
 class MetaJackPortProcess : public MetaJackPortBase {
 public:
+    /**
+      Creates a port which owns its buffer, e.g. a silence port.
+      */
     MetaJackPortProcess(jack_port_id_t id, const std::string &shortName, const std::string &type, int flags, jack_nframes_t bufferSize);
+    /**
+      Creates a port whose buffer is assigned by the schedule (see setBuffer()).
+
+      @param silencePort if given, an input port without connections hands out this
+        port's buffer instead of its own (which has to be silent, i.e. cleared)
+      @param scratchPort the port whose buffer is used as long as no buffer is assigned
+      */
+    MetaJackPortProcess(jack_port_id_t id, const std::string &shortName, const std::string &type, int flags, MetaJackPortProcess *silencePort, MetaJackPortProcess *scratchPort);
     ~MetaJackPortProcess();
+    /**
+      Input ports with a single connection return the connected output
+      port's buffer, input ports without connections return the silence
+      port's buffer. Such buffers are shared, they must not be written to.
+      */
     void * getBuffer(jack_nframes_t nframes);
+    /**
+      Changes the size of the buffer owned by this port.
+      */
     void changeBufferSize(jack_nframes_t bufferSize);
+    /**
+      Assigns a buffer which is owned by the schedule (i.e., part of its arena).
+      Buffers of MIDI ports are initialized here.
+
+      @param buffer the buffer to use, or 0 to fall back to the scratch port's buffer
+      @param keepContents if true, the contents of an audio port's previous buffer
+        are copied to the new one (for ports read in the next cycle, e.g. in feedback loops)
+      */
+    void setBuffer(char *buffer, size_t bufferSizeInBytes, bool keepContents = false);
     bool clearBuffer();
+    /**
+      Sums (or merges, in case of MIDI) all connected output buffers into this
+      input port's own buffer. This is only necessary with more than one connection,
+      otherwise getBuffer() returns a shared buffer.
+      */
     bool mergeConnectedBuffers();
-    bool process(std::set<MetaJackClientProcess*> &unprocessedClients, jack_nframes_t nframes);
+    /**
+      Input ports are silent if all connected output ports are silent.
+      Output ports are silent if their buffer was found to be silent in the
+      current cycle (see detectSilence()), or cleared by setSilent().
+
+      @return true, if the port's buffer contains silence in the current cycle,
+        i.e. no MIDI events or only samples below -120 dB
+      */
+    bool isSilent() const;
+    void setSilent(bool silent);
+    /**
+      Checks whether this output port's buffer is silent after it has been written.
+      */
+    void detectSilence(jack_nframes_t nframes);
 private:
     size_t bufferSizeInBytes;
-    char * buffer;
+    // the buffer is aligned to MixingKernels::ALIGNMENT bytes within the allocated memory (if owned by this port):
+    char *bufferMemory, *buffer;
+    MetaJackPortProcess *silencePort, *scratchPort;
+    bool silent;
+
+    char * getAssignedBuffer();
+    size_t getAssignedBufferSize() const;
 };
 
 class MetaJackPort : public MetaJackPortBase {
 public:
     MetaJackPort(MetaJackClient *client, jack_port_id_t id, const std::string &shortName, const std::string &type, int flags);
-    void createProcessPort(jack_nframes_t bufferSize);
+    void createProcessPort(MetaJackPortProcess *silencePort, MetaJackPortProcess *scratchPort);
     MetaJackPortProcess * getProcessPort();
 private:
     MetaJackPortProcess *twin;
@@ -0,0 +1,391 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metajackschedule.h"
+#include "metajackclient.h"
+#include "metajackport.h"
+#include "mixingkernels.h"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+MetaJackSchedule::MetaJackSchedule(const std::map<std::string, MetaJackClient*> &clients, MetaJackPort *excludedPort, unsigned int threadCount, jack_nframes_t bufferSize_) :
+    queues(threadCount ? threadCount : 1),
+    parallelism(0),
+    bufferCount(0),
+    bufferSize(bufferSize_),
+    bufferSizeInBytes(0),
+    bufferStride(0),
+    arenaMemory(0),
+    arena(0)
+{
+    std::set<MetaJackClient*> visitedClients;
+    std::map<MetaJackClient*, size_t> clientTasks;
+    std::vector<size_t> levels;
+    for (std::map<std::string, MetaJackClient*>::const_iterator i = clients.begin(); i != clients.end(); i++) {
+        MetaJackClient *client = i->second;
+        if (client->isActive()) {
+            addClient(client, visitedClients, clientTasks, levels, excludedPort);
+        }
+    }
+    // the parallelism is the maximum number of tasks on the same dependency level:
+    std::vector<size_t> levelSizes;
+    for (size_t i = 0; i < levels.size(); i++) {
+        if (levels[i] >= levelSizes.size()) {
+            levelSizes.resize(levels[i] + 1, 0);
+        }
+        if (++levelSizes[levels[i]] > parallelism) {
+            parallelism = levelSizes[levels[i]];
+        }
+    }
+    // allocate everything needed for parallel processing here, such that the process thread doesn't have to:
+    pendingDependencies.resize(tasks.size());
+    for (size_t i = 0; i < queues.size(); i++) {
+        queues[i].tasks.resize(tasks.size());
+    }
+    // the execution order is known now, so the port buffers can be planned:
+    planBuffers(clientTasks, excludedPort);
+    allocateArena();
+}
+
+MetaJackSchedule::~MetaJackSchedule()
+{
+    delete [] arenaMemory;
+}
+
+bool MetaJackSchedule::process(jack_nframes_t nframes)
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    for (std::vector<Step>::iterator i = steps.begin(); i != steps.end(); i++) {
+        if (i->type == Step::MERGE_PORT) {
+            if (!i->port->mergeConnectedBuffers()) {
+                return false;
+            }
+        } else if (!i->client->process(nframes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<MetaJackSchedule::Step> & MetaJackSchedule::getSteps() const
+{
+    return steps;
+}
+
+unsigned int MetaJackSchedule::getThreadCount() const
+{
+    return queues.size();
+}
+
+size_t MetaJackSchedule::getParallelism() const
+{
+    return parallelism;
+}
+
+size_t MetaJackSchedule::getBufferCount() const
+{
+    return bufferCount;
+}
+
+void MetaJackSchedule::assignBuffers()
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    for (std::vector<BufferAssignment>::iterator i = bufferAssignments.begin(); i != bufferAssignments.end(); i++) {
+        i->port->setBuffer(i->buffer == NO_BUFFER ? 0 : arena + i->buffer * bufferStride, bufferSizeInBytes, i->keepContents);
+    }
+}
+
+void MetaJackSchedule::changeBufferSize(jack_nframes_t bufferSize_)
+{
+    if (bufferSize == bufferSize_) {
+        return;
+    }
+    bufferSize = bufferSize_;
+    allocateArena();
+    // ports without a buffer keep using the scratch buffers (this also skips the excluded port, which may be deleted by now):
+    for (std::vector<BufferAssignment>::iterator i = bufferAssignments.begin(); i != bufferAssignments.end(); i++) {
+        if (i->buffer != NO_BUFFER) {
+            i->port->setBuffer(arena + i->buffer * bufferStride, bufferSizeInBytes);
+        }
+    }
+}
+
+jack_nframes_t MetaJackSchedule::getBufferSize() const
+{
+    return bufferSize;
+}
+
+void MetaJackSchedule::beginCycle(unsigned int threadCount)
+{
+    if (threadCount > queues.size()) {
+        threadCount = queues.size();
+    } else if (threadCount < 1) {
+        threadCount = 1;
+    }
+    for (size_t i = 0; i < tasks.size(); i++) {
+        pendingDependencies[i] = tasks[i].dependencies;
+    }
+    for (size_t i = 0; i < queues.size(); i++) {
+        queues[i].head = 0;
+        queues[i].tail = 0;
+    }
+    remainingTasks = (int)tasks.size();
+    failed = 0;
+    // distribute the tasks which are ready from the beginning among the participating threads:
+    for (size_t i = 0; i < rootTasks.size(); i++) {
+        pushTask(i % threadCount, rootTasks[i]);
+    }
+}
+
+void MetaJackSchedule::work(unsigned int thread, jack_nframes_t nframes)
+{
+    // this will be called from the process thread and from worker threads, so no memory allocation must be done here!
+    // a task is pushed to the queue of the thread which made it ready, which will pop it unless another thread steals it,
+    // so workers can leave without leaving tasks behind:
+    for (unsigned int idlePolls = 0; (remainingTasks > 0) && ((thread == 0) || (idlePolls < MAX_IDLE_POLLS)); ) {
+        size_t task;
+        if (popTask(thread, task)) {
+            runTask(thread, task, nframes);
+            idlePolls = 0;
+        } else {
+            idlePolls++;
+        }
+    }
+}
+
+bool MetaJackSchedule::endCycle()
+{
+    return (failed == 0);
+}
+
+void MetaJackSchedule::addClient(MetaJackClient *client, std::set<MetaJackClient*> &visitedClients, std::map<MetaJackClient*, size_t> &clientTasks, std::vector<size_t> &levels, MetaJackPort *excludedPort)
+{
+    if (!visitedClients.insert(client).second) {
+        // the client has already been scheduled (cycles are prevented when connecting ports):
+        return;
+    }
+    // schedule all active clients that are connected to this client's input ports first:
+    std::set<size_t> upstreamTasks;
+    for (std::set<MetaJackPortBase*>::iterator i = client->getPorts().begin(); i != client->getPorts().end(); i++) {
+        MetaJackPort *port = (MetaJackPort*)*i;
+        if (port->isInput() && (port != excludedPort)) {
+            for (std::set<MetaJackPortBase*>::const_iterator j = port->getConnectedPorts().begin(); j != port->getConnectedPorts().end(); j++) {
+                MetaJackClient *connectedClient = (MetaJackClient*)(*j)->getClient();
+                if (connectedClient->isActive()) {
+                    addClient(connectedClient, visitedClients, clientTasks, levels, excludedPort);
+                    // remember the dependency (a client connected to itself has no task yet):
+                    std::map<MetaJackClient*, size_t>::iterator find = clientTasks.find(connectedClient);
+                    if (find != clientTasks.end()) {
+                        upstreamTasks.insert(find->second);
+                    }
+                }
+            }
+        }
+    }
+    Task task;
+    task.firstStep = steps.size();
+    // merge all buffers connected to this client's input ports:
+    for (std::set<MetaJackPortBase*>::iterator i = client->getPorts().begin(); i != client->getPorts().end(); i++) {
+        MetaJackPort *port = (MetaJackPort*)*i;
+        if (port->isInput() && (port != excludedPort)) {
+            Step step;
+            step.type = Step::MERGE_PORT;
+            step.port = port->getProcessPort();
+            step.client = 0;
+            steps.push_back(step);
+        }
+    }
+    // process this client:
+    Step step;
+    step.type = Step::PROCESS_CLIENT;
+    step.port = 0;
+    step.client = client->getProcessClient();
+    assert(step.client);
+    steps.push_back(step);
+    task.endStep = steps.size();
+    // make this task depend on the tasks of all connected clients:
+    size_t index = tasks.size();
+    size_t level = 0;
+    task.dependencies = upstreamTasks.size();
+    for (std::set<size_t>::iterator i = upstreamTasks.begin(); i != upstreamTasks.end(); i++) {
+        tasks[*i].dependents.push_back(index);
+        level = std::max(level, levels[*i] + 1);
+    }
+    if (task.dependencies == 0) {
+        rootTasks.push_back(index);
+    }
+    tasks.push_back(task);
+    levels.push_back(level);
+    clientTasks[client] = index;
+}
+
+void MetaJackSchedule::planBuffers(std::map<MetaJackClient*, size_t> &clientTasks, MetaJackPort *excludedPort)
+{
+    std::map<MetaJackPortProcess*, size_t> mergeSteps;
+    for (size_t i = 0; i < steps.size(); i++) {
+        if (steps[i].type == Step::MERGE_PORT) {
+            mergeSteps[steps[i].port] = i;
+        }
+    }
+    // with several threads, independent tasks are processed in any order, thus the buffers can't be shared:
+    bool shareBuffers = (queues.size() == 1);
+    size_t lastStep = (steps.size() ? steps.size() - 1 : 0);
+    std::vector<BufferLifetime> lifetimes;
+    for (std::map<MetaJackClient*, size_t>::iterator i = clientTasks.begin(); i != clientTasks.end(); i++) {
+        MetaJackClient *client = i->first;
+        // the client is processed in the last step of its task:
+        size_t processStep = tasks[i->second].endStep - 1;
+        for (std::set<MetaJackPortBase*>::iterator j = client->getPorts().begin(); j != client->getPorts().end(); j++) {
+            MetaJackPort *port = (MetaJackPort*)*j;
+            BufferAssignment assignment;
+            assignment.port = port->getProcessPort();
+            assignment.buffer = NO_BUFFER;
+            assignment.keepContents = false;
+            BufferLifetime lifetime;
+            lifetime.assignment = bufferAssignments.size();
+            bufferAssignments.push_back(assignment);
+            if (port == excludedPort) {
+                // the port is about to be unregistered, it uses the scratch buffer until then:
+                continue;
+            } else if (port->isInput()) {
+                // input ports with several connections merge them into their buffer before their client is processed:
+                if (port->getConnectionCount() < 2) {
+                    continue;
+                }
+                lifetime.firstStep = mergeSteps[assignment.port];
+                lifetime.lastStep = processStep;
+            } else {
+                // output ports are written when their client is processed and read by the connected clients:
+                lifetime.firstStep = lifetime.lastStep = processStep;
+                BufferAssignment &outputAssignment = bufferAssignments.back();
+                for (std::set<MetaJackPortBase*>::const_iterator k = port->getConnectedPorts().begin(); k != port->getConnectedPorts().end(); k++) {
+                    std::map<MetaJackClient*, size_t>::iterator find = clientTasks.find((MetaJackClient*)(*k)->getClient());
+                    if ((*k == excludedPort) || (find == clientTasks.end())) {
+                        continue;
+                    }
+                    // (the buffer is read at the latest when the connected client is processed, merging happens before that)
+                    size_t readStep = tasks[find->second].endStep - 1;
+                    if (readStep <= processStep) {
+                        // a client connected to itself reads the buffer of the previous cycle:
+                        lifetime.firstStep = 0;
+                        lifetime.lastStep = lastStep;
+                        outputAssignment.keepContents = true;
+                    } else {
+                        lifetime.lastStep = std::max(lifetime.lastStep, readStep);
+                    }
+                }
+            }
+            if (!shareBuffers) {
+                lifetime.firstStep = 0;
+                lifetime.lastStep = lastStep;
+            }
+            lifetimes.push_back(lifetime);
+        }
+    }
+    // assign the buffers in the order in which the lifetimes begin, reusing the buffers whose lifetimes
+    // have ended (MIDI buffers have a head, thus audio and MIDI ports don't share buffers):
+    std::sort(lifetimes.begin(), lifetimes.end());
+    std::multimap<size_t, size_t> usedBuffers[2];
+    std::vector<size_t> freeBuffers[2];
+    for (std::vector<BufferLifetime>::iterator i = lifetimes.begin(); i != lifetimes.end(); i++) {
+        BufferAssignment &assignment = bufferAssignments[i->assignment];
+        int type = (assignment.port->getType() == JACK_DEFAULT_MIDI_TYPE ? 1 : 0);
+        for (; usedBuffers[type].size() && (usedBuffers[type].begin()->first < i->firstStep); ) {
+            freeBuffers[type].push_back(usedBuffers[type].begin()->second);
+            usedBuffers[type].erase(usedBuffers[type].begin());
+        }
+        if (freeBuffers[type].size()) {
+            assignment.buffer = freeBuffers[type].back();
+            freeBuffers[type].pop_back();
+        } else {
+            assignment.buffer = bufferCount++;
+        }
+        usedBuffers[type].insert(std::make_pair(i->lastStep, assignment.buffer));
+    }
+}
+
+void MetaJackSchedule::allocateArena()
+{
+    delete [] arenaMemory;
+    bufferSizeInBytes = bufferSize * sizeof(jack_default_audio_sample_t);
+    // round the buffer size up such that every buffer in the arena is aligned for the mixing kernels:
+    bufferStride = (bufferSizeInBytes + MixingKernels::ALIGNMENT - 1) / MixingKernels::ALIGNMENT * MixingKernels::ALIGNMENT;
+    arenaMemory = new char [bufferCount * bufferStride + MixingKernels::ALIGNMENT - 1];
+    arena = arenaMemory + (MixingKernels::ALIGNMENT - (size_t)arenaMemory % MixingKernels::ALIGNMENT) % MixingKernels::ALIGNMENT;
+    // buffers read before they are written in the first cycle (e.g. in feedback loops) must not contain garbage:
+    memset(arena, 0, bufferCount * bufferStride);
+}
+
+void MetaJackSchedule::pushTask(unsigned int thread, size_t task)
+{
+    // only the owning thread pushes to its queue (except in beginCycle(), before any other thread is working):
+    TaskQueue &queue = queues[thread];
+    int tail = queue.tail;
+    queue.tasks[tail] = task;
+    // make the task visible to the other threads:
+    queue.tail.fetchAndStoreRelease(tail + 1);
+}
+
+bool MetaJackSchedule::popTask(unsigned int thread, size_t &task)
+{
+    // look into the thread's own queue first, then try to steal from the other threads' queues:
+    for (size_t i = 0; i < queues.size(); i++) {
+        TaskQueue &queue = queues[(thread + i) % queues.size()];
+        for (;;) {
+            int head = queue.head;
+            if (head >= queue.tail.fetchAndAddAcquire(0)) {
+                break;
+            }
+            task = queue.tasks[head];
+            if (queue.head.testAndSetOrdered(head, head + 1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void MetaJackSchedule::runTask(unsigned int thread, size_t task, jack_nframes_t nframes)
+{
+    const Task &currentTask = tasks[task];
+    // after a failed process callback, the remaining tasks are not processed anymore (just as in process()):
+    if (failed == 0) {
+        for (size_t i = currentTask.firstStep; i < currentTask.endStep; i++) {
+            const Step &step = steps[i];
+            bool success = (step.type == Step::MERGE_PORT ? step.port->mergeConnectedBuffers() : step.client->process(nframes));
+            if (!success) {
+                failed = 1;
+                break;
+            }
+        }
+    }
+    // dependent tasks are ready when all tasks they depend on are done:
+    for (std::vector<size_t>::const_iterator i = currentTask.dependents.begin(); i != currentTask.dependents.end(); i++) {
+        if (pendingDependencies[*i].fetchAndAddOrdered(-1) == 1) {
+            pushTask(thread, *i);
+        }
+    }
+    remainingTasks.fetchAndAddOrdered(-1);
+}
+
+bool MetaJackSchedule::BufferLifetime::operator<(const BufferLifetime &lifetime) const
+{
+    return firstStep < lifetime.firstStep;
+}
@@ -0,0 +1,200 @@
+#ifndef METAJACKSCHEDULE_H
+#define METAJACKSCHEDULE_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <jack/types.h>
+#include <QAtomicInt>
+
+class MetaJackClient;
+class MetaJackClientProcess;
+class MetaJackPort;
+class MetaJackPortProcess;
+
+/**
+  A flat, precompiled execution order of the process graph of a MetaJackContext.
+
+  The schedule is compiled outside the process thread from the non-process
+  graph (i.e., from MetaJackClient and MetaJackPort objects) whenever the graph
+  changes. It consists of steps which refer to the corresponding process-side
+  twins (MetaJackClientProcess and MetaJackPortProcess objects). Each active
+  client gets one step which calls its process callback, preceded by one merge step
+  for each of its input ports. Clients are ordered such that every client is
+  processed after all active clients connected to its inputs.
+
+  The process thread only iterates over the steps, which does not involve any
+  memory allocation or graph traversal.
+
+  In addition, the steps of each client (i.e., its input port merges followed
+  by its process callback) are grouped into a task. Each task has a counter of
+  the upstream tasks it depends on, which allows several threads to process
+  independent clients concurrently (see MetaJackThreadPool). Ready tasks are kept
+  in one queue per thread, threads without work steal tasks from the other
+  threads' queues.
+
+  The schedule also owns the buffers of the output ports and of the input
+  ports with several connections (into which the connected buffers are merged).
+  These are placed in one aligned arena, such that a buffer size change only
+  reallocates the arena. From the execution order, the lifetime of each buffer
+  is known: it is written by the step which processes its port's client (or
+  merges into the input port) and is last read by the steps which merge it or
+  process the connected clients. Ports whose lifetimes do not overlap share the
+  same buffer. This is only done if the schedule is processed by a single thread,
+  with several threads each port gets its own buffer.
+  */
+class MetaJackSchedule {
+public:
+    struct Step {
+        enum {
+            MERGE_PORT,
+            PROCESS_CLIENT
+        } type;
+        MetaJackPortProcess *port;
+        MetaJackClientProcess *client;
+    };
+
+    /**
+      Compiles the schedule from the given non-process clients.
+      This must not be called from the process thread.
+
+      @param clients all clients of the context, only active ones are considered
+      @param excludedPort a port which should not be part of the schedule, e.g.
+        because it is about to be unregistered (may be 0)
+      @param threadCount the maximum number of threads which will process this
+        schedule concurrently, including the process thread
+      @param bufferSize the size of the port buffers in frames
+      */
+    MetaJackSchedule(const std::map<std::string, MetaJackClient*> &clients, MetaJackPort *excludedPort = 0, unsigned int threadCount = 1, jack_nframes_t bufferSize = 0);
+    ~MetaJackSchedule();
+
+    /**
+      Processes all steps in order. This is called from the process thread.
+
+      @return false, if any client's process callback failed, true otherwise
+      */
+    bool process(jack_nframes_t nframes);
+
+    const std::vector<Step> & getSteps() const;
+    unsigned int getThreadCount() const;
+    /**
+      @return the maximum number of clients which do not depend on each other
+        and can thus be processed concurrently
+      */
+    size_t getParallelism() const;
+    /**
+      @return the number of port buffers in the arena, which is less than the
+        number of ports using them if lifetimes do not overlap
+      */
+    size_t getBufferCount() const;
+
+    /**
+      Assigns the buffers in the arena to the ports of the active clients. This
+      is called from the process thread when this schedule becomes the current one.
+      Ports read before they are written (e.g. in feedback loops) take over the
+      contents of their previous buffers, which must still be allocated.
+      */
+    void assignBuffers();
+    /**
+      Reallocates the arena for the given buffer size and assigns the new buffers.
+      This must not be called while this schedule is processed.
+      */
+    void changeBufferSize(jack_nframes_t bufferSize);
+    jack_nframes_t getBufferSize() const;
+
+    // the following methods are used by MetaJackThreadPool to process the schedule concurrently:
+    /**
+      Prepares a parallel processing cycle, i.e. resets all dependency counters
+      and distributes the tasks without dependencies among the first
+      threadCount queues. This is called from the process thread before any
+      other thread calls work().
+      */
+    void beginCycle(unsigned int threadCount);
+    /**
+      Processes ready tasks until all tasks of the current cycle are done.
+      This can be called from several threads concurrently, each with a
+      different thread index. Threads other than the process thread (index 0)
+      return early if they don't find a ready task for a while, as the process
+      thread takes care of the remaining tasks.
+
+      @param thread index of the calling thread, must be less than getThreadCount()
+      */
+    void work(unsigned int thread, jack_nframes_t nframes);
+    /**
+      This is called from the process thread after all threads have left work().
+
+      @return false, if any client's process callback failed, true otherwise
+      */
+    bool endCycle();
+private:
+    struct Task {
+        // the steps [firstStep, endStep) belong to this task:
+        size_t firstStep, endStep;
+        int dependencies;
+        std::vector<size_t> dependents;
+    };
+    struct BufferAssignment {
+        MetaJackPortProcess *port;
+        // index of the buffer in the arena, or NO_BUFFER if the port doesn't need one:
+        size_t buffer;
+        // true, if the buffer is read in the next cycle before it is written:
+        bool keepContents;
+    };
+    struct BufferLifetime {
+        // the steps [firstStep, lastStep] during which the buffer is used:
+        size_t firstStep, lastStep;
+        size_t assignment;
+        bool operator<(const BufferLifetime &lifetime) const;
+    };
+    static const size_t NO_BUFFER = (size_t)-1;
+    // how often a worker looks for a ready task in vain before it leaves work():
+    static const unsigned int MAX_IDLE_POLLS = 4096;
+    struct TaskQueue {
+        // each task is pushed at most once per cycle, thus no wrap-around is necessary:
+        std::vector<size_t> tasks;
+        QAtomicInt head, tail;
+    };
+
+    std::vector<Step> steps;
+    std::vector<Task> tasks;
+    std::vector<size_t> rootTasks;
+    std::vector<QAtomicInt> pendingDependencies;
+    std::vector<TaskQueue> queues;
+    QAtomicInt remainingTasks, failed;
+    size_t parallelism;
+    std::vector<BufferAssignment> bufferAssignments;
+    size_t bufferCount;
+    jack_nframes_t bufferSize;
+    // each buffer is aligned to MixingKernels::ALIGNMENT bytes within the arena:
+    size_t bufferSizeInBytes, bufferStride;
+    char *arenaMemory, *arena;
+
+    void addClient(MetaJackClient *client, std::set<MetaJackClient*> &visitedClients, std::map<MetaJackClient*, size_t> &clientTasks, std::vector<size_t> &levels, MetaJackPort *excludedPort);
+    void planBuffers(std::map<MetaJackClient*, size_t> &clientTasks, MetaJackPort *excludedPort);
+    void allocateArena();
+    void pushTask(unsigned int thread, size_t task);
+    bool popTask(unsigned int thread, size_t &task);
+    void runTask(unsigned int thread, size_t task, jack_nframes_t nframes);
+};
+
+#endif // METAJACKSCHEDULE_H
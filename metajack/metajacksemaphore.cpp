@@ -0,0 +1,93 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metajacksemaphore.h"
+#include <cerrno>
+#if defined(Q_OS_MAC)
+#include <mach/mach_init.h>
+#include <mach/task.h>
+#endif
+
+MetaJackSemaphore::MetaJackSemaphore()
+{
+#if defined(Q_OS_WIN)
+    semaphore = CreateSemaphore(0, 0, 0x7fffffff, 0);
+#elif defined(Q_OS_MAC)
+    semaphore_create(mach_task_self(), &semaphore, SYNC_POLICY_FIFO, 0);
+#else
+    sem_init(&semaphore, 0, 0);
+#endif
+}
+
+MetaJackSemaphore::~MetaJackSemaphore()
+{
+#if defined(Q_OS_WIN)
+    CloseHandle(semaphore);
+#elif defined(Q_OS_MAC)
+    semaphore_destroy(mach_task_self(), semaphore);
+#else
+    sem_destroy(&semaphore);
+#endif
+}
+
+void MetaJackSemaphore::release(unsigned int n)
+{
+#if defined(Q_OS_WIN)
+    if (n) {
+        ReleaseSemaphore(semaphore, n, 0);
+    }
+#else
+    for (unsigned int i = 0; i < n; i++) {
+#if defined(Q_OS_MAC)
+        semaphore_signal(semaphore);
+#else
+        sem_post(&semaphore);
+#endif
+    }
+#endif
+}
+
+bool MetaJackSemaphore::tryAcquire()
+{
+#if defined(Q_OS_WIN)
+    return (WaitForSingleObject(semaphore, 0) == WAIT_OBJECT_0);
+#elif defined(Q_OS_MAC)
+    mach_timespec_t timeout = { 0, 0 };
+    return (semaphore_timedwait(semaphore, timeout) == KERN_SUCCESS);
+#else
+    return (sem_trywait(&semaphore) == 0);
+#endif
+}
+
+void MetaJackSemaphore::acquire(unsigned int spinCount)
+{
+    for (unsigned int i = 0; i < spinCount; i++) {
+        if (tryAcquire()) {
+            return;
+        }
+    }
+#if defined(Q_OS_WIN)
+    WaitForSingleObject(semaphore, INFINITE);
+#elif defined(Q_OS_MAC)
+    for (; semaphore_wait(semaphore) != KERN_SUCCESS; );
+#else
+    // restart the wait if it is interrupted by a signal:
+    for (; (sem_wait(&semaphore) != 0) && (errno == EINTR); );
+#endif
+}
@@ -0,0 +1,74 @@
+#ifndef METAJACKSEMAPHORE_H
+#define METAJACKSEMAPHORE_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtGlobal>
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_MAC)
+#include <mach/semaphore.h>
+#else
+#include <semaphore.h>
+#endif
+
+/**
+  A counting semaphore which the process thread can release without
+  blocking, unlike QSemaphore, which locks a mutex that a thread of
+  lower priority might hold. It wraps the operating system's semaphore,
+  i.e. a futex-based POSIX semaphore on Linux, a Mach semaphore on Mac
+  OS X and a semaphore object on Windows.
+
+  acquire() spins for a while before it waits, such that a thread which is
+  woken again shortly does not have to be rescheduled.
+  */
+class MetaJackSemaphore {
+public:
+    MetaJackSemaphore();
+    ~MetaJackSemaphore();
+
+    /**
+      Increments the count by n, waking up to n waiting threads.
+      This never blocks.
+      */
+    void release(unsigned int n = 1);
+    /**
+      Decrements the count if it is greater than zero.
+
+      @return true, if the count was decremented
+      */
+    bool tryAcquire();
+    /**
+      Decrements the count, waiting until it is greater than zero.
+
+      @param spinCount how many times to try acquiring before waiting
+      */
+    void acquire(unsigned int spinCount = 0);
+private:
+#if defined(Q_OS_WIN)
+    HANDLE semaphore;
+#elif defined(Q_OS_MAC)
+    semaphore_t semaphore;
+#else
+    sem_t semaphore;
+#endif
+};
+
+#endif // METAJACKSEMAPHORE_H
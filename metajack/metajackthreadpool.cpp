@@ -0,0 +1,110 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metajackthreadpool.h"
+#include <algorithm>
+
+MetaJackThreadPool::MetaJackThreadPool(JackContext *wrapperInterface_, jack_client_t *wrapperClient_, JackThreadInitCallbackHandler *threadInitCallbackHandler_, unsigned int workerCount) :
+    wrapperInterface(wrapperInterface_),
+    wrapperClient(wrapperClient_),
+    threadInitCallbackHandler(threadInitCallbackHandler_),
+    stop(false),
+    schedule(0),
+    nframes(0)
+{
+    // the workers get the same priority as the wrapper client's process thread:
+    int realtime = wrapperInterface->is_realtime(wrapperClient);
+    int priority = wrapperInterface->client_real_time_priority(wrapperClient);
+    // reserve the memory for all workers first, as the threads get pointers to their worker structs:
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++) {
+        Worker worker;
+        worker.threadPool = this;
+        worker.index = workers.size() + 1;
+        workers.push_back(worker);
+        Worker *newWorker = &workers.back();
+        if (wrapperInterface->client_create_thread(wrapperClient, &newWorker->thread, priority, realtime, run, newWorker)) {
+            // try again without realtime scheduling:
+            if (!realtime || wrapperInterface->client_create_thread(wrapperClient, &newWorker->thread, priority, 0, run, newWorker)) {
+                // there will be fewer workers than requested:
+                workers.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+MetaJackThreadPool::~MetaJackThreadPool()
+{
+    // wake all workers with the stop flag set:
+    stop = true;
+    wakeSemaphore.release(workers.size());
+    for (std::vector<Worker>::iterator i = workers.begin(); i != workers.end(); i++) {
+        wrapperInterface->client_stop_thread(wrapperClient, i->thread);
+    }
+}
+
+unsigned int MetaJackThreadPool::getThreadCount() const
+{
+    return workers.size() + 1;
+}
+
+bool MetaJackThreadPool::process(MetaJackSchedule *schedule, jack_nframes_t nframes)
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    // the schedule has to provide a queue for each thread, and there have to be clients which can be processed concurrently:
+    if (workers.empty() || (schedule->getThreadCount() < getThreadCount()) || (schedule->getParallelism() <= 1)) {
+        // fall back to serial processing:
+        return schedule->process(nframes);
+    }
+    // only wake as many workers as needed:
+    unsigned int wakeCount = std::min(workers.size(), schedule->getParallelism() - 1);
+    this->schedule = schedule;
+    this->nframes = nframes;
+    schedule->beginCycle(wakeCount + 1);
+    wakeSemaphore.release(wakeCount);
+    // the process thread works on the schedule as well:
+    schedule->work(0, nframes);
+    // wait for all woken workers to finish, such that none of them touches the schedule after returning:
+    for (unsigned int i = 0; i < wakeCount; i++) {
+        doneSemaphore.acquire(SPIN_COUNT);
+    }
+    return schedule->endCycle();
+}
+
+void MetaJackThreadPool::run(Worker *worker)
+{
+    // the internal clients may want to initialize each thread which calls their process callbacks:
+    threadInitCallbackHandler->invokeCallbacks();
+    for (;;) {
+        wakeSemaphore.acquire(SPIN_COUNT);
+        if (stop) {
+            break;
+        }
+        schedule->work(worker->index, nframes);
+        doneSemaphore.release();
+    }
+}
+
+void * MetaJackThreadPool::run(void *arg)
+{
+    Worker *worker = (Worker*)arg;
+    worker->threadPool->run(worker);
+    return 0;
+}
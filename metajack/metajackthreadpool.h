@@ -0,0 +1,96 @@
+#ifndef METAJACKTHREADPOOL_H
+#define METAJACKTHREADPOOL_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jackcontext.h"
+#include "metajackschedule.h"
+#include "callbackhandlers.h"
+#include "metajacksemaphore.h"
+#include <vector>
+
+/**
+  A pool of worker threads which help the process thread of a MetaJackContext
+  to process a MetaJackSchedule.
+
+  The workers are created via the wrapper client's JackContext, i.e. they get the
+  same (realtime) priority as the process thread. Each worker invokes the thread
+  init callbacks of the internal clients before it starts working.
+
+  In each process cycle the process thread wakes as many workers as there are
+  clients which can be processed concurrently, works on the schedule itself and
+  waits for all woken workers to finish before returning. Workers which run out
+  of tasks leave the schedule after a short while, and idle workers wait on a
+  semaphore after spinning briefly, so they don't occupy the CPU between cycles. If the schedule has
+  no parallelism (e.g., a single chain of clients) or if no worker could be
+  created, the schedule is processed serially by the process thread alone.
+  */
+class MetaJackThreadPool {
+public:
+    /**
+      Creates and starts the worker threads.
+      This must not be called from the process thread.
+
+      @param workerCount the number of worker threads to create in addition
+        to the process thread
+      */
+    MetaJackThreadPool(JackContext *wrapperInterface, jack_client_t *wrapperClient, JackThreadInitCallbackHandler *threadInitCallbackHandler, unsigned int workerCount);
+    /**
+      Stops all worker threads. This must not be called from the process
+      thread, and the process thread must not use this pool anymore.
+      */
+    ~MetaJackThreadPool();
+
+    /**
+      @return the number of threads processing a schedule, including the process thread
+      */
+    unsigned int getThreadCount() const;
+
+    /**
+      Processes the given schedule, using the worker threads if the schedule
+      allows for it. This is called from the process thread.
+
+      @return false, if any client's process callback failed, true otherwise
+      */
+    bool process(MetaJackSchedule *schedule, jack_nframes_t nframes);
+
+private:
+    struct Worker {
+        MetaJackThreadPool *threadPool;
+        unsigned int index;
+        jack_native_thread_t thread;
+    };
+
+    JackContext *wrapperInterface;
+    jack_client_t *wrapperClient;
+    JackThreadInitCallbackHandler *threadInitCallbackHandler;
+    std::vector<Worker> workers;
+    MetaJackSemaphore wakeSemaphore, doneSemaphore;
+    bool stop;
+    MetaJackSchedule *schedule;
+    jack_nframes_t nframes;
+    // how often to try acquiring a semaphore before waiting for it:
+    static const unsigned int SPIN_COUNT = 1000;
+
+    void run(Worker *worker);
+    static void * run(void *arg);
+};
+
+#endif // METAJACKTHREADPOOL_H
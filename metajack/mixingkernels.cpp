@@ -0,0 +1,428 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mixingkernels.h"
+#include <memory.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define MIXINGKERNELS_X86
+#include <immintrin.h>
+#endif
+
+struct MixingKernelTable {
+    void (*zero)(jack_default_audio_sample_t *dest, size_t nframes);
+    void (*copy)(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes);
+    void (*add)(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes);
+    void (*addScaled)(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes);
+    void (*sum)(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes);
+    bool (*isSilent)(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes);
+};
+
+/*
+  Scalar kernels
+  */
+
+static void zeroScalar(jack_default_audio_sample_t *dest, size_t nframes)
+{
+    memset(dest, 0, nframes * sizeof(jack_default_audio_sample_t));
+}
+
+static void copyScalar(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    memcpy(dest, source, nframes * sizeof(jack_default_audio_sample_t));
+}
+
+static void addScalar(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    for (size_t i = 0; i < nframes; i++) {
+        dest[i] += source[i];
+    }
+}
+
+static void addScaledScalar(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes)
+{
+    for (size_t i = 0; i < nframes; i++) {
+        dest[i] += gain * source[i];
+    }
+}
+
+static void sumScalar(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes)
+{
+    if (!sourceCount) {
+        zeroScalar(dest, nframes);
+        return;
+    }
+    copyScalar(dest, sources[0], nframes);
+    for (size_t j = 1; j < sourceCount; j++) {
+        addScalar(dest, sources[j], nframes);
+    }
+}
+
+static bool isSilentScalar(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes)
+{
+    // (written such that NaNs are not silent)
+    for (size_t i = 0; i < nframes; i++) {
+        if (!((source[i] <= threshold) && (source[i] >= -threshold))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const MixingKernelTable scalarKernels = { zeroScalar, copyScalar, addScalar, addScaledScalar, sumScalar, isSilentScalar };
+
+#ifdef MIXINGKERNELS_X86
+
+/*
+  SSE2 kernels (4 samples per vector)
+  */
+
+__attribute__((target("sse2"))) static void zeroSse2(jack_default_audio_sample_t *dest, size_t nframes)
+{
+    size_t i = 0;
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= nframes; i += 4) {
+        _mm_storeu_ps(dest + i, zero);
+    }
+    for (; i < nframes; i++) {
+        dest[i] = 0;
+    }
+}
+
+__attribute__((target("sse2"))) static void copySse2(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    size_t i = 0;
+    for (; i + 4 <= nframes; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_loadu_ps(source + i));
+    }
+    for (; i < nframes; i++) {
+        dest[i] = source[i];
+    }
+}
+
+__attribute__((target("sse2"))) static void addSse2(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    size_t i = 0;
+    for (; i + 4 <= nframes; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_loadu_ps(source + i)));
+    }
+    for (; i < nframes; i++) {
+        dest[i] += source[i];
+    }
+}
+
+__attribute__((target("sse2"))) static void addScaledSse2(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes)
+{
+    size_t i = 0;
+    __m128 gains = _mm_set1_ps(gain);
+    for (; i + 4 <= nframes; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(gains, _mm_loadu_ps(source + i))));
+    }
+    for (; i < nframes; i++) {
+        dest[i] += gain * source[i];
+    }
+}
+
+__attribute__((target("sse2"))) static void sumSse2(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes)
+{
+    if (!sourceCount) {
+        zeroSse2(dest, nframes);
+        return;
+    }
+    size_t i = 0;
+    // keep the sum in registers, such that the destination is written only once:
+    for (; i + 8 <= nframes; i += 8) {
+        __m128 sum0 = _mm_loadu_ps(sources[0] + i);
+        __m128 sum1 = _mm_loadu_ps(sources[0] + i + 4);
+        for (size_t j = 1; j < sourceCount; j++) {
+            sum0 = _mm_add_ps(sum0, _mm_loadu_ps(sources[j] + i));
+            sum1 = _mm_add_ps(sum1, _mm_loadu_ps(sources[j] + i + 4));
+        }
+        _mm_storeu_ps(dest + i, sum0);
+        _mm_storeu_ps(dest + i + 4, sum1);
+    }
+    for (; i < nframes; i++) {
+        jack_default_audio_sample_t sum = sources[0][i];
+        for (size_t j = 1; j < sourceCount; j++) {
+            sum += sources[j][i];
+        }
+        dest[i] = sum;
+    }
+}
+
+__attribute__((target("sse2"))) static bool isSilentSse2(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes)
+{
+    size_t i = 0;
+    // clearing the sign bit gives the absolute value, the unordered comparison treats NaNs as not silent:
+    __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 thresholds = _mm_set1_ps(threshold);
+    for (; i + 8 <= nframes; i += 8) {
+        __m128 loud0 = _mm_cmpnle_ps(_mm_andnot_ps(signMask, _mm_loadu_ps(source + i)), thresholds);
+        __m128 loud1 = _mm_cmpnle_ps(_mm_andnot_ps(signMask, _mm_loadu_ps(source + i + 4)), thresholds);
+        if (_mm_movemask_ps(_mm_or_ps(loud0, loud1))) {
+            return false;
+        }
+    }
+    return isSilentScalar(source + i, threshold, nframes - i);
+}
+
+static const MixingKernelTable sse2Kernels = { zeroSse2, copySse2, addSse2, addScaledSse2, sumSse2, isSilentSse2 };
+
+/*
+  AVX kernels (8 samples per vector)
+  */
+
+__attribute__((target("avx"))) static void zeroAvx(jack_default_audio_sample_t *dest, size_t nframes)
+{
+    size_t i = 0;
+    __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= nframes; i += 8) {
+        _mm256_storeu_ps(dest + i, zero);
+    }
+    for (; i < nframes; i++) {
+        dest[i] = 0;
+    }
+}
+
+__attribute__((target("avx"))) static void copyAvx(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    size_t i = 0;
+    for (; i + 8 <= nframes; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_loadu_ps(source + i));
+    }
+    for (; i < nframes; i++) {
+        dest[i] = source[i];
+    }
+}
+
+__attribute__((target("avx"))) static void addAvx(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    size_t i = 0;
+    for (; i + 8 <= nframes; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_loadu_ps(source + i)));
+    }
+    for (; i < nframes; i++) {
+        dest[i] += source[i];
+    }
+}
+
+__attribute__((target("avx"))) static void addScaledAvx(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes)
+{
+    size_t i = 0;
+    __m256 gains = _mm256_set1_ps(gain);
+    for (; i + 8 <= nframes; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_mul_ps(gains, _mm256_loadu_ps(source + i))));
+    }
+    for (; i < nframes; i++) {
+        dest[i] += gain * source[i];
+    }
+}
+
+__attribute__((target("avx"))) static void sumAvx(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes)
+{
+    if (!sourceCount) {
+        zeroAvx(dest, nframes);
+        return;
+    }
+    size_t i = 0;
+    // keep the sum in registers, such that the destination is written only once:
+    for (; i + 16 <= nframes; i += 16) {
+        __m256 sum0 = _mm256_loadu_ps(sources[0] + i);
+        __m256 sum1 = _mm256_loadu_ps(sources[0] + i + 8);
+        for (size_t j = 1; j < sourceCount; j++) {
+            sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(sources[j] + i));
+            sum1 = _mm256_add_ps(sum1, _mm256_loadu_ps(sources[j] + i + 8));
+        }
+        _mm256_storeu_ps(dest + i, sum0);
+        _mm256_storeu_ps(dest + i + 8, sum1);
+    }
+    for (; i < nframes; i++) {
+        jack_default_audio_sample_t sum = sources[0][i];
+        for (size_t j = 1; j < sourceCount; j++) {
+            sum += sources[j][i];
+        }
+        dest[i] = sum;
+    }
+}
+
+__attribute__((target("avx"))) static bool isSilentAvx(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes)
+{
+    size_t i = 0;
+    // clearing the sign bit gives the absolute value, the unordered comparison treats NaNs as not silent:
+    __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 thresholds = _mm256_set1_ps(threshold);
+    for (; i + 16 <= nframes; i += 16) {
+        __m256 loud0 = _mm256_cmp_ps(_mm256_andnot_ps(signMask, _mm256_loadu_ps(source + i)), thresholds, _CMP_NLE_UQ);
+        __m256 loud1 = _mm256_cmp_ps(_mm256_andnot_ps(signMask, _mm256_loadu_ps(source + i + 8)), thresholds, _CMP_NLE_UQ);
+        if (_mm256_movemask_ps(_mm256_or_ps(loud0, loud1))) {
+            return false;
+        }
+    }
+    return isSilentScalar(source + i, threshold, nframes - i);
+}
+
+static const MixingKernelTable avxKernels = { zeroAvx, copyAvx, addAvx, addScaledAvx, sumAvx, isSilentAvx };
+
+#endif // MIXINGKERNELS_X86
+
+static MixingKernels::Implementation detectImplementation()
+{
+#ifdef MIXINGKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return MixingKernels::AVX;
+    } else if (__builtin_cpu_supports("sse2")) {
+        return MixingKernels::SSE2;
+    }
+#endif
+    return MixingKernels::SCALAR;
+}
+
+static const MixingKernelTable * getKernelTable(MixingKernels::Implementation implementation)
+{
+#ifdef MIXINGKERNELS_X86
+    if (implementation == MixingKernels::AVX) {
+        return &avxKernels;
+    } else if (implementation == MixingKernels::SSE2) {
+        return &sse2Kernels;
+    }
+#endif
+    return &scalarKernels;
+}
+
+/*
+  Lazy selection
+
+  The kernels may be used by static constructors in other translation units, which
+  may run before this file's dynamic initializers. Thus the kernel table pointer
+  is initialized statically with a table which selects the best implementation on
+  first use (which only writes the same values if it happens concurrently).
+  */
+
+static bool kernelsSelected = false;
+static MixingKernels::Implementation bestImplementation = MixingKernels::SCALAR;
+static MixingKernels::Implementation currentImplementation = MixingKernels::SCALAR;
+static const MixingKernelTable * selectKernels();
+
+static void zeroLazy(jack_default_audio_sample_t *dest, size_t nframes)
+{
+    selectKernels()->zero(dest, nframes);
+}
+
+static void copyLazy(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    selectKernels()->copy(dest, source, nframes);
+}
+
+static void addLazy(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    selectKernels()->add(dest, source, nframes);
+}
+
+static void addScaledLazy(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes)
+{
+    selectKernels()->addScaled(dest, source, gain, nframes);
+}
+
+static void sumLazy(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes)
+{
+    selectKernels()->sum(dest, sources, sourceCount, nframes);
+}
+
+static bool isSilentLazy(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes)
+{
+    return selectKernels()->isSilent(source, threshold, nframes);
+}
+
+static const MixingKernelTable lazyKernels = { zeroLazy, copyLazy, addLazy, addScaledLazy, sumLazy, isSilentLazy };
+// this is a constant initialization, which happens before any static constructor runs:
+static const MixingKernelTable *kernels = &lazyKernels;
+
+static const MixingKernelTable * selectKernels()
+{
+    if (!kernelsSelected) {
+        bestImplementation = currentImplementation = detectImplementation();
+        kernels = getKernelTable(bestImplementation);
+        kernelsSelected = true;
+    }
+    return kernels;
+}
+
+MixingKernels::Implementation MixingKernels::getImplementation()
+{
+    selectKernels();
+    return currentImplementation;
+}
+
+bool MixingKernels::isSupported(Implementation implementation)
+{
+    selectKernels();
+    return implementation <= bestImplementation;
+}
+
+bool MixingKernels::setImplementation(Implementation implementation)
+{
+    if (!isSupported(implementation)) {
+        return false;
+    }
+    currentImplementation = implementation;
+    kernels = getKernelTable(implementation);
+    return true;
+}
+
+const char * MixingKernels::getImplementationName(Implementation implementation)
+{
+    if (implementation == AVX) {
+        return "AVX";
+    } else if (implementation == SSE2) {
+        return "SSE2";
+    } else {
+        return "scalar";
+    }
+}
+
+void MixingKernels::zero(jack_default_audio_sample_t *dest, size_t nframes)
+{
+    kernels->zero(dest, nframes);
+}
+
+void MixingKernels::copy(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    kernels->copy(dest, source, nframes);
+}
+
+void MixingKernels::add(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes)
+{
+    kernels->add(dest, source, nframes);
+}
+
+void MixingKernels::addScaled(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes)
+{
+    kernels->addScaled(dest, source, gain, nframes);
+}
+
+void MixingKernels::sum(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes)
+{
+    kernels->sum(dest, sources, sourceCount, nframes);
+}
+
+bool MixingKernels::isSilent(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes)
+{
+    return kernels->isSilent(source, threshold, nframes);
+}
@@ -0,0 +1,73 @@
+#ifndef MIXINGKERNELS_H
+#define MIXINGKERNELS_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <jack/types.h>
+
+/**
+  Vectorized kernels for mixing audio port buffers.
+
+  All kernels exist in a scalar version, an SSE2 version and an AVX version
+  (on x86 processors). The fastest version supported by the processor is
+  selected when the kernels are used for the first time. The kernels work with any buffer alignment and
+  length, but are fastest with buffers aligned to ALIGNMENT bytes (which all
+  buffers of MetaJackPortProcess are).
+  */
+class MixingKernels {
+public:
+    enum Implementation {
+        SCALAR,
+        SSE2,
+        AVX
+    };
+    enum {
+        ALIGNMENT = 32,
+        // the maximum number of sources sum() is usually called with:
+        MAX_SUM_SOURCES = 16
+    };
+
+    static Implementation getImplementation();
+    static bool isSupported(Implementation implementation);
+    /**
+      Selects the kernel implementation, e.g. for benchmarking.
+      This must not be called while any kernel is in use.
+
+      @return false, if the given implementation is not supported by the processor
+      */
+    static bool setImplementation(Implementation implementation);
+    static const char * getImplementationName(Implementation implementation);
+
+    // dest[i] = 0
+    static void zero(jack_default_audio_sample_t *dest, size_t nframes);
+    // dest[i] = source[i]
+    static void copy(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes);
+    // dest[i] += source[i]
+    static void add(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, size_t nframes);
+    // dest[i] += gain * source[i]
+    static void addScaled(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t *source, jack_default_audio_sample_t gain, size_t nframes);
+    // dest[i] = sources[0][i] + ... + sources[sourceCount - 1][i], reading each buffer only once
+    static void sum(jack_default_audio_sample_t *dest, const jack_default_audio_sample_t * const *sources, size_t sourceCount, size_t nframes);
+    // true, if abs(source[i]) <= threshold for all i (returns at the first louder sample)
+    static bool isSilent(const jack_default_audio_sample_t *source, jack_default_audio_sample_t threshold, size_t nframes);
+};
+
+#endif // MIXINGKERNELS_H
@@ -0,0 +1,777 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "offlinejackcontext.h"
+#include "metajackcontext.h"
+#include "mixingkernels.h"
+#include <QRegExp>
+#include <jack/thread.h>
+#include <unistd.h>
+#include <cstring>
+#include <sstream>
+
+OfflineJackContext::OfflineJackContext(const std::string &name_, jack_nframes_t sampleRate_, jack_nframes_t bufferSize_) :
+    name(name_),
+    sampleRate(sampleRate_),
+    bufferSize(bufferSize_),
+    frameTime(0),
+    freewheel(0),
+    transportState(JackTransportStopped),
+    newTransportPosition(false),
+    timebaseMaster(0),
+    timebaseCallback(0),
+    timebaseArg(0),
+    processThread(pthread_self()),
+    nextPortId(1)
+{
+    memset(&transportPosition, 0, sizeof(transportPosition));
+    transportPosition.frame_rate = sampleRate;
+}
+
+OfflineJackContext::~OfflineJackContext()
+{
+    // delete all clients which have not been closed by their owners:
+    for (; clients.size(); ) {
+        client_close((jack_client_t*)clients.front());
+    }
+}
+
+void OfflineJackContext::process()
+{
+    processThread = pthread_self();
+    updateTransport();
+    for (std::list<OfflineJackClient*>::iterator i = clients.begin(); i != clients.end(); i++) {
+        OfflineJackClient *client = *i;
+        if (client->active) {
+            // the first cycle of each client is preceded by its thread init callback, as with a real Jack server:
+            if (!client->threadInitialized) {
+                client->threadInitialized = true;
+                if (client->threadInitCallback) {
+                    client->threadInitCallback(client->threadInitArg);
+                }
+            }
+            if (client->processCallback) {
+                client->processCallback(bufferSize, client->processArg);
+            }
+        }
+    }
+    // let the timebase master fill in the position:
+    if (timebaseCallback && ((transportState == JackTransportRolling) || newTransportPosition)) {
+        timebaseCallback(transportState, bufferSize, &transportPosition, newTransportPosition, timebaseArg);
+    }
+    newTransportPosition = false;
+    // advance the clocks:
+    frameTime += bufferSize;
+    if (transportState == JackTransportRolling) {
+        transportPosition.frame += bufferSize;
+    }
+    transportPosition.usecs = frames_to_time(0, frameTime);
+}
+
+jack_client_t * OfflineJackContext::client_by_name(const char *client_name)
+{
+    return (jack_client_t*)getClientByName(client_name);
+}
+
+std::list<jack_client_t*> OfflineJackContext::get_clients()
+{
+    std::list<jack_client_t*> clientList;
+    for (std::list<OfflineJackClient*>::iterator i = clients.begin(); i != clients.end(); i++) {
+        clientList.push_back((jack_client_t*)*i);
+    }
+    return clientList;
+}
+
+const char * OfflineJackContext::get_name() const
+{
+    return name.c_str();
+}
+
+void OfflineJackContext::get_version(int *major_ptr, int *minor_ptr, int *micro_ptr, int *proto_ptr)
+{
+    *major_ptr = *minor_ptr = *micro_ptr = *proto_ptr = 0;
+}
+
+const char * OfflineJackContext::get_version_string()
+{
+    return "offline";
+}
+
+jack_client_t * OfflineJackContext::client_open (const char *client_name, jack_options_t options, jack_status_t *, ...)
+{
+    std::string requestedName = client_name;
+    // test if the name is not too long:
+    if (requestedName.length() > (size_t)client_name_size()) {
+        return 0;
+    }
+    // test if the requested name is already taken:
+    bool nameIsTaken = getClientByName(requestedName);
+    // if the name is taken but the JackUseExactName flag is given, we can't continue:
+    if (nameIsTaken && (options & JackUseExactName)) {
+        return 0;
+    }
+    std::string clientName = requestedName;
+    // if the name is taken, append a suffix:
+    for (int suffix = 2; nameIsTaken; suffix++) {
+        std::stringstream stream;
+        stream << requestedName << suffix;
+        clientName = stream.str();
+        nameIsTaken = getClientByName(clientName);
+    }
+    OfflineJackClient *client = new OfflineJackClient();
+    client->name = clientName;
+    client->active = client->threadInitialized = false;
+    client->processCallback = 0;
+    client->processArg = 0;
+    client->threadInitCallback = 0;
+    client->threadInitArg = 0;
+    client->bufferSizeCallback = 0;
+    client->bufferSizeArg = 0;
+    client->sampleRateCallback = 0;
+    client->sampleRateArg = 0;
+    client->freewheelCallback = 0;
+    client->freewheelArg = 0;
+    client->syncCallback = 0;
+    client->syncArg = 0;
+    client->shutdownCallback = 0;
+    client->shutdownArg = 0;
+    client->infoShutdownCallback = 0;
+    client->infoShutdownArg = 0;
+    clients.push_back(client);
+    return (jack_client_t*)client;
+}
+
+int OfflineJackContext::client_close (jack_client_t *client_)
+{
+    OfflineJackClient *client = (OfflineJackClient*)client_;
+    deactivate(client_);
+    release_timebase(client_);
+    // unregister all its ports:
+    for (; client->ports.size(); ) {
+        port_unregister(client_, (jack_port_t*)client->ports.front());
+    }
+    clients.remove(client);
+    delete client;
+    return 0;
+}
+
+int OfflineJackContext::client_name_size ()
+{
+    return 64;
+}
+
+char * OfflineJackContext::get_client_name (jack_client_t *client)
+{
+    return (char*)((OfflineJackClient*)client)->name.c_str();
+}
+
+int OfflineJackContext::activate (jack_client_t *client_)
+{
+    OfflineJackClient *client = (OfflineJackClient*)client_;
+    if (!client->active) {
+        // clients are processed in the order of their activation:
+        clients.remove(client);
+        clients.push_back(client);
+        client->active = true;
+    }
+    return 0;
+}
+
+int OfflineJackContext::deactivate (jack_client_t *client)
+{
+    ((OfflineJackClient*)client)->active = false;
+    return 0;
+}
+
+int OfflineJackContext::get_client_pid (const char *)
+{
+    return getpid();
+}
+
+jack_native_thread_t OfflineJackContext::client_thread_id (jack_client_t *)
+{
+    return processThread;
+}
+
+int OfflineJackContext::is_realtime (jack_client_t *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_thread_init_callback (jack_client_t *client, JackThreadInitCallback thread_init_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->threadInitCallback = thread_init_callback;
+    ((OfflineJackClient*)client)->threadInitArg = arg;
+    return 0;
+}
+
+void OfflineJackContext::on_shutdown (jack_client_t *client, JackShutdownCallback shutdown_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->shutdownCallback = shutdown_callback;
+    ((OfflineJackClient*)client)->shutdownArg = arg;
+}
+
+void OfflineJackContext::on_info_shutdown (jack_client_t *client, JackInfoShutdownCallback shutdown_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->infoShutdownCallback = shutdown_callback;
+    ((OfflineJackClient*)client)->infoShutdownArg = arg;
+}
+
+int OfflineJackContext::set_process_callback (jack_client_t *client, JackProcessCallback process_callback, void *arg)
+{
+    if (((OfflineJackClient*)client)->active) {
+        return 1;
+    }
+    ((OfflineJackClient*)client)->processCallback = process_callback;
+    ((OfflineJackClient*)client)->processArg = arg;
+    return 0;
+}
+
+int OfflineJackContext::set_freewheel_callback (jack_client_t *client, JackFreewheelCallback freewheel_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->freewheelCallback = freewheel_callback;
+    ((OfflineJackClient*)client)->freewheelArg = arg;
+    return 0;
+}
+
+int OfflineJackContext::set_buffer_size_callback (jack_client_t *client, JackBufferSizeCallback bufsize_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->bufferSizeCallback = bufsize_callback;
+    ((OfflineJackClient*)client)->bufferSizeArg = arg;
+    return 0;
+}
+
+int OfflineJackContext::set_sample_rate_callback (jack_client_t *client, JackSampleRateCallback srate_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->sampleRateCallback = srate_callback;
+    ((OfflineJackClient*)client)->sampleRateArg = arg;
+    return 0;
+}
+
+// there are no other clients, ports or connections to be notified about, so the following callbacks are never called:
+
+int OfflineJackContext::set_client_registration_callback (jack_client_t *, JackClientRegistrationCallback, void *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_port_registration_callback (jack_client_t *, JackPortRegistrationCallback, void *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_port_connect_callback (jack_client_t *, JackPortConnectCallback, void *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_port_rename_callback (jack_client_t *, JackPortRenameCallback, void *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_graph_order_callback (jack_client_t *, JackGraphOrderCallback, void *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_xrun_callback (jack_client_t *, JackXRunCallback, void *)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_freewheel(jack_client_t *, int onoff)
+{
+    if (freewheel != onoff) {
+        freewheel = onoff;
+        for (std::list<OfflineJackClient*>::iterator i = clients.begin(); i != clients.end(); i++) {
+            OfflineJackClient *client = *i;
+            if (client->freewheelCallback) {
+                client->freewheelCallback(freewheel, client->freewheelArg);
+            }
+        }
+    }
+    return 0;
+}
+
+int OfflineJackContext::set_buffer_size (jack_client_t *, jack_nframes_t nframes)
+{
+    if (nframes == 0) {
+        return 1;
+    }
+    if (bufferSize != nframes) {
+        bufferSize = nframes;
+        // reallocate all port buffers:
+        for (std::map<jack_port_id_t, OfflineJackPort*>::iterator i = portsById.begin(); i != portsById.end(); i++) {
+            allocatePortBuffer(i->second);
+        }
+        for (std::list<OfflineJackClient*>::iterator i = clients.begin(); i != clients.end(); i++) {
+            OfflineJackClient *client = *i;
+            if (client->bufferSizeCallback) {
+                client->bufferSizeCallback(bufferSize, client->bufferSizeArg);
+            }
+        }
+    }
+    return 0;
+}
+
+jack_nframes_t OfflineJackContext::get_sample_rate (jack_client_t *)
+{
+    return sampleRate;
+}
+
+jack_nframes_t OfflineJackContext::get_buffer_size (jack_client_t *)
+{
+    return bufferSize;
+}
+
+float OfflineJackContext::cpu_load (jack_client_t *)
+{
+    return 0;
+}
+
+jack_port_t * OfflineJackContext::port_register (jack_client_t *client_, const char *port_name, const char *port_type, unsigned long flags, unsigned long)
+{
+    OfflineJackClient *client = (OfflineJackClient*)client_;
+    std::string shortName = port_name;
+    std::string type = port_type;
+    std::string fullName = client->name + ":" + shortName;
+    // only the default audio and midi types are supported, and each port needs a unique name:
+    if (((type != JACK_DEFAULT_AUDIO_TYPE) && (type != JACK_DEFAULT_MIDI_TYPE)) || (fullName.length() > (size_t)port_name_size()) || portsByName.count(fullName)) {
+        return 0;
+    }
+    OfflineJackPort *port = new OfflineJackPort();
+    port->client = client;
+    port->id = nextPortId++;
+    port->shortName = shortName;
+    port->fullName = fullName;
+    port->type = type;
+    port->flags = flags;
+    allocatePortBuffer(port);
+    client->ports.push_back(port);
+    portsByName[fullName] = port;
+    portsById[port->id] = port;
+    return (jack_port_t*)port;
+}
+
+int OfflineJackContext::port_unregister (jack_client_t *client, jack_port_t *port_)
+{
+    OfflineJackPort *port = (OfflineJackPort*)port_;
+    if (port->client != (OfflineJackClient*)client) {
+        return 1;
+    }
+    port->client->ports.remove(port);
+    portsByName.erase(port->fullName);
+    portsById.erase(port->id);
+    delete port;
+    return 0;
+}
+
+void * OfflineJackContext::port_get_buffer (jack_port_t *port, jack_nframes_t)
+{
+    return ((OfflineJackPort*)port)->buffer;
+}
+
+const char * OfflineJackContext::port_name (const jack_port_t *port)
+{
+    return ((OfflineJackPort*)port)->fullName.c_str();
+}
+
+const char * OfflineJackContext::port_short_name (const jack_port_t *port)
+{
+    return ((OfflineJackPort*)port)->shortName.c_str();
+}
+
+int OfflineJackContext::port_flags (const jack_port_t *port)
+{
+    return ((OfflineJackPort*)port)->flags;
+}
+
+const char * OfflineJackContext::port_type (const jack_port_t *port)
+{
+    return ((OfflineJackPort*)port)->type.c_str();
+}
+
+int OfflineJackContext::port_is_mine (const jack_client_t *client, const jack_port_t *port)
+{
+    return ((OfflineJackPort*)port)->client == (OfflineJackClient*)client;
+}
+
+// ports are never connected:
+
+int OfflineJackContext::port_connected (const jack_port_t *)
+{
+    return 0;
+}
+
+int OfflineJackContext::port_connected_to (const jack_port_t *, const char *)
+{
+    return 0;
+}
+
+const char ** OfflineJackContext::port_get_connections (const jack_port_t *)
+{
+    return 0;
+}
+
+const char ** OfflineJackContext::port_get_all_connections (const jack_client_t *, const jack_port_t *)
+{
+    return 0;
+}
+
+jack_nframes_t OfflineJackContext::port_get_latency (jack_port_t *)
+{
+    return 0;
+}
+
+jack_nframes_t OfflineJackContext::port_get_total_latency (jack_client_t *, jack_port_t *)
+{
+    return 0;
+}
+
+void OfflineJackContext::port_set_latency (jack_port_t *, jack_nframes_t)
+{
+}
+
+int OfflineJackContext::recompute_total_latency (jack_client_t *, jack_port_t *)
+{
+    return 0;
+}
+
+int OfflineJackContext::recompute_total_latencies (jack_client_t *)
+{
+    return 0;
+}
+
+int OfflineJackContext::port_set_name (jack_port_t *port_, const char *port_name)
+{
+    OfflineJackPort *port = (OfflineJackPort*)port_;
+    std::string fullName = port->client->name + ":" + port_name;
+    if (portsByName.count(fullName)) {
+        return 1;
+    }
+    portsByName.erase(port->fullName);
+    port->shortName = port_name;
+    port->fullName = fullName;
+    portsByName[fullName] = port;
+    return 0;
+}
+
+int OfflineJackContext::port_set_alias (jack_port_t *, const char *)
+{
+    return 1;
+}
+
+int OfflineJackContext::port_unset_alias (jack_port_t *, const char *)
+{
+    return 1;
+}
+
+int OfflineJackContext::port_get_aliases (const jack_port_t *, char* const [])
+{
+    return 0;
+}
+
+int OfflineJackContext::port_request_monitor (jack_port_t *, int)
+{
+    return 1;
+}
+
+int OfflineJackContext::port_request_monitor_by_name (jack_client_t *, const char *, int)
+{
+    return 1;
+}
+
+int OfflineJackContext::port_ensure_monitor (jack_port_t *, int)
+{
+    return 1;
+}
+
+int OfflineJackContext::port_monitoring_input (jack_port_t *)
+{
+    return 0;
+}
+
+int OfflineJackContext::connect (jack_client_t *, const char *, const char *)
+{
+    return 1;
+}
+
+int OfflineJackContext::disconnect (jack_client_t *, const char *, const char *)
+{
+    return 1;
+}
+
+int OfflineJackContext::port_disconnect (jack_client_t *, jack_port_t *)
+{
+    return 0;
+}
+
+int OfflineJackContext::port_name_size()
+{
+    return 320;
+}
+
+int OfflineJackContext::port_type_size()
+{
+    return 32;
+}
+
+const char ** OfflineJackContext::get_ports (jack_client_t *, const char *port_name_pattern, const char *type_name_pattern, unsigned long flags)
+{
+    std::string port_name_pattern_string = (port_name_pattern ? port_name_pattern : "");
+    std::string type_name_pattern_string = (type_name_pattern ? type_name_pattern : "");
+    QRegExp regexPortNames(port_name_pattern_string.c_str());
+    QRegExp regexTypeNames(type_name_pattern_string.c_str());
+    std::list<OfflineJackPort*> matchingPorts;
+    for (std::map<jack_port_id_t, OfflineJackPort*>::iterator i = portsById.begin(); i != portsById.end(); i++) {
+        OfflineJackPort *port = i->second;
+        if (((port->flags & flags) == flags) && ((port_name_pattern_string.length() == 0) || regexPortNames.exactMatch(port->fullName.c_str())) && ((type_name_pattern_string.length() == 0) || regexTypeNames.exactMatch(port->type.c_str()))) {
+            matchingPorts.push_back(port);
+        }
+    }
+    if (matchingPorts.size()) {
+        char ** names = new char*[matchingPorts.size() + 1];
+        size_t index = 0;
+        for (std::list<OfflineJackPort*>::iterator i = matchingPorts.begin(); i != matchingPorts.end(); i++, index++) {
+            OfflineJackPort *port = *i;
+            names[index] = new char[port->fullName.length() + 1];
+            memcpy(names[index], port->fullName.c_str(), port->fullName.length() + 1);
+        }
+        names[index] = 0;
+        return (const char**)names;
+    } else {
+        return 0;
+    }
+}
+
+jack_port_t * OfflineJackContext::port_by_name (jack_client_t *, const char *port_name)
+{
+    std::map<std::string, OfflineJackPort*>::iterator find = portsByName.find(port_name);
+    if (find != portsByName.end()) {
+        return (jack_port_t*)find->second;
+    } else {
+        return 0;
+    }
+}
+
+jack_port_t * OfflineJackContext::port_by_id (jack_client_t *, jack_port_id_t port_id)
+{
+    std::map<jack_port_id_t, OfflineJackPort*>::iterator find = portsById.find(port_id);
+    if (find != portsById.end()) {
+        return (jack_port_t*)find->second;
+    } else {
+        return 0;
+    }
+}
+
+jack_nframes_t OfflineJackContext::frames_since_cycle_start (const jack_client_t *)
+{
+    return 0;
+}
+
+jack_nframes_t OfflineJackContext::frame_time (const jack_client_t *)
+{
+    return frameTime;
+}
+
+jack_nframes_t OfflineJackContext::last_frame_time (const jack_client_t *)
+{
+    return frameTime;
+}
+
+jack_time_t OfflineJackContext::frames_to_time(const jack_client_t *, jack_nframes_t nframes)
+{
+    return (jack_time_t)nframes * 1000000 / sampleRate;
+}
+
+jack_nframes_t OfflineJackContext::time_to_frames(const jack_client_t *, jack_time_t time)
+{
+    return (jack_nframes_t)(time * sampleRate / 1000000);
+}
+
+jack_time_t OfflineJackContext::get_time()
+{
+    // the local clock only advances with each process cycle:
+    return frames_to_time(0, frameTime);
+}
+
+void OfflineJackContext::set_error_function (void (*)(const char *))
+{
+}
+
+void OfflineJackContext::set_info_function (void (*)(const char *))
+{
+}
+
+void OfflineJackContext::free(void* ptr)
+{
+    if (ptr) {
+        char **names = (char**)ptr;
+        for (size_t index = 0; names[index]; index++) {
+            delete [] names[index];
+        }
+        delete [] names;
+    }
+}
+
+int OfflineJackContext::release_timebase (jack_client_t *client)
+{
+    if (timebaseMaster != (OfflineJackClient*)client) {
+        return 1;
+    }
+    timebaseMaster = 0;
+    timebaseCallback = 0;
+    timebaseArg = 0;
+    return 0;
+}
+
+int OfflineJackContext::set_sync_callback (jack_client_t *client, JackSyncCallback sync_callback, void *arg)
+{
+    ((OfflineJackClient*)client)->syncCallback = sync_callback;
+    ((OfflineJackClient*)client)->syncArg = arg;
+    return 0;
+}
+
+int OfflineJackContext::set_sync_timeout (jack_client_t *, jack_time_t)
+{
+    return 0;
+}
+
+int OfflineJackContext::set_timebase_callback (jack_client_t *client, int conditional, JackTimebaseCallback timebase_callback, void *arg)
+{
+    if (conditional && timebaseMaster && (timebaseMaster != (OfflineJackClient*)client)) {
+        return 1;
+    }
+    timebaseMaster = (OfflineJackClient*)client;
+    timebaseCallback = timebase_callback;
+    timebaseArg = arg;
+    // the first cycle with a new timebase master is treated as a new position:
+    newTransportPosition = true;
+    return 0;
+}
+
+int OfflineJackContext::transport_locate (jack_client_t *, jack_nframes_t frame)
+{
+    transportPosition.frame = frame;
+    newTransportPosition = true;
+    // clients get the chance to sync to the new position before the transport rolls on:
+    if (transportState == JackTransportRolling) {
+        transportState = JackTransportStarting;
+    }
+    return 0;
+}
+
+jack_transport_state_t OfflineJackContext::transport_query (const jack_client_t *, jack_position_t *pos)
+{
+    if (pos) {
+        *pos = transportPosition;
+    }
+    return transportState;
+}
+
+jack_nframes_t OfflineJackContext::get_current_transport_frame (const jack_client_t *)
+{
+    return transportPosition.frame;
+}
+
+int OfflineJackContext::transport_reposition (jack_client_t *client, jack_position_t *pos)
+{
+    return transport_locate(client, pos->frame);
+}
+
+void OfflineJackContext::transport_start (jack_client_t *)
+{
+    if (transportState == JackTransportStopped) {
+        transportState = JackTransportStarting;
+    }
+}
+
+void OfflineJackContext::transport_stop (jack_client_t *)
+{
+    transportState = JackTransportStopped;
+}
+
+void OfflineJackContext::get_transport_info (jack_client_t *, jack_transport_info_t *tinfo)
+{
+    tinfo->frame_rate = sampleRate;
+    tinfo->usecs = transportPosition.usecs;
+    tinfo->valid = (jack_transport_bits_t)(JackTransportState | JackTransportPosition);
+    tinfo->transport_state = transportState;
+    tinfo->frame = transportPosition.frame;
+}
+
+void OfflineJackContext::set_transport_info (jack_client_t *, jack_transport_info_t *)
+{
+}
+
+int OfflineJackContext::client_real_time_priority (jack_client_t *)
+{
+    return -1;
+}
+
+int OfflineJackContext::client_create_thread (jack_client_t *, jack_native_thread_t *thread, int, int, void *(*start_routine)(void*), void *arg)
+{
+    // there are no realtime deadlines when rendering offline, so all threads get default scheduling:
+    return pthread_create(thread, 0, start_routine, arg);
+}
+
+int OfflineJackContext::client_stop_thread (jack_client_t *, jack_native_thread_t thread)
+{
+    return pthread_join(thread, 0);
+}
+
+OfflineJackContext::OfflineJackClient * OfflineJackContext::getClientByName(const std::string &clientName) const
+{
+    for (std::list<OfflineJackClient*>::const_iterator i = clients.begin(); i != clients.end(); i++) {
+        if ((*i)->name == clientName) {
+            return *i;
+        }
+    }
+    return 0;
+}
+
+void OfflineJackContext::allocatePortBuffer(OfflineJackPort *port)
+{
+    size_t bufferSizeInBytes = bufferSize * sizeof(jack_default_audio_sample_t);
+    port->bufferMemory.assign(bufferSizeInBytes + MixingKernels::ALIGNMENT - 1, 0);
+    // align the buffer like the MetaJack port buffers:
+    size_t misalignment = (size_t)&port->bufferMemory[0] % MixingKernels::ALIGNMENT;
+    port->buffer = &port->bufferMemory[0] + (misalignment ? MixingKernels::ALIGNMENT - misalignment : 0);
+    if (port->type == JACK_DEFAULT_MIDI_TYPE) {
+        MetaJackContext::midi_init_buffer(port->buffer, bufferSizeInBytes);
+    }
+}
+
+void OfflineJackContext::updateTransport()
+{
+    if (transportState == JackTransportStarting) {
+        // the transport starts rolling when all active clients with a sync callback are ready:
+        bool ready = true;
+        for (std::list<OfflineJackClient*>::iterator i = clients.begin(); i != clients.end(); i++) {
+            OfflineJackClient *client = *i;
+            if (client->active && client->syncCallback && !client->syncCallback(transportState, &transportPosition, client->syncArg)) {
+                ready = false;
+            }
+        }
+        if (ready) {
+            transportState = JackTransportRolling;
+        }
+    }
+}
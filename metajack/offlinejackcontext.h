@@ -0,0 +1,211 @@
+#ifndef OFFLINEJACKCONTEXT_H
+#define OFFLINEJACKCONTEXT_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jackcontext.h"
+#include <jack/transport.h>
+#include <pthread.h>
+#include <string>
+#include <list>
+#include <map>
+#include <vector>
+
+/**
+  A JackContext which is not driven by a Jack server, but by the caller.
+
+  Each call to process() runs one process cycle of all active clients in
+  the order of their activation and then advances the local frame clock
+  (and the transport, if it is rolling) by one buffer. Time is measured in
+  frames only, i.e. this context runs as fast as the process callbacks
+  allow, which makes it suitable for rendering sessions offline.
+
+  Ports of this context are never connected to each other. The buffers of
+  input ports belong to the caller of process(), who fills them before each
+  cycle, and the buffers of output ports can be read after each cycle.
+  MIDI buffers use the same format as MetaJackContext's MIDI buffers, so they
+  can be accessed through the RecursiveJackContext midi functions.
+
+  Threads created via client_create_thread() are never realtime threads.
+  */
+class OfflineJackContext : public JackContext
+{
+public:
+    OfflineJackContext(const std::string &name = "offline", jack_nframes_t sampleRate = 44100, jack_nframes_t bufferSize = 1024);
+    virtual ~OfflineJackContext();
+
+    /**
+      Runs one process cycle of all active clients and advances the local
+      clock by one buffer.
+
+      Must not be called concurrently with itself or with any method which
+      changes the set of clients or ports.
+      */
+    void process();
+
+    // methods reimplemented from JackContext:
+    jack_client_t * client_by_name(const char *client_name);
+    std::list<jack_client_t*> get_clients();
+    const char * get_name() const;
+
+    // Jack API methods:
+    void get_version(int *major_ptr, int *minor_ptr, int *micro_ptr, int *proto_ptr);
+    const char * get_version_string();
+    jack_client_t * client_open (const char *client_name, jack_options_t options, jack_status_t *, ...);
+    int client_close (jack_client_t *client);
+    int client_name_size ();
+    char * get_client_name (jack_client_t *client);
+    int activate (jack_client_t *client);
+    int deactivate (jack_client_t *client);
+    int get_client_pid (const char *);
+    jack_native_thread_t client_thread_id (jack_client_t *client);
+    int is_realtime (jack_client_t *client);
+    int set_thread_init_callback (jack_client_t *client, JackThreadInitCallback thread_init_callback, void *arg);
+    void on_shutdown (jack_client_t *client, JackShutdownCallback shutdown_callback, void *arg);
+    void on_info_shutdown (jack_client_t *client, JackInfoShutdownCallback shutdown_callback, void *arg);
+    int set_process_callback (jack_client_t *client, JackProcessCallback process_callback, void *arg);
+    int set_freewheel_callback (jack_client_t *client, JackFreewheelCallback freewheel_callback, void *arg);
+    int set_buffer_size_callback (jack_client_t *client, JackBufferSizeCallback bufsize_callback, void *arg);
+    int set_sample_rate_callback (jack_client_t *client, JackSampleRateCallback srate_callback, void *arg);
+    int set_client_registration_callback (jack_client_t *client, JackClientRegistrationCallback registration_callback, void *arg);
+    int set_port_registration_callback (jack_client_t *client, JackPortRegistrationCallback registration_callback, void *arg);
+    int set_port_connect_callback (jack_client_t *client, JackPortConnectCallback connect_callback, void *arg);
+    int set_port_rename_callback (jack_client_t *client, JackPortRenameCallback rename_callback, void *arg);
+    int set_graph_order_callback (jack_client_t *client, JackGraphOrderCallback graph_callback, void *arg);
+    int set_xrun_callback (jack_client_t *client, JackXRunCallback xrun_callback, void *arg);
+    int set_freewheel(jack_client_t *client, int onoff);
+    int set_buffer_size (jack_client_t *client, jack_nframes_t nframes);
+    jack_nframes_t get_sample_rate (jack_client_t *client);
+    jack_nframes_t get_buffer_size (jack_client_t *client);
+    float cpu_load (jack_client_t *client);
+    jack_port_t * port_register (jack_client_t *client, const char *port_name, const char *port_type, unsigned long flags, unsigned long buffer_size);
+    int port_unregister (jack_client_t *client, jack_port_t *port);
+    void * port_get_buffer (jack_port_t *port, jack_nframes_t nframes);
+    const char * port_name (const jack_port_t *port);
+    const char * port_short_name (const jack_port_t *port);
+    int port_flags (const jack_port_t *port);
+    const char * port_type (const jack_port_t *port);
+    int port_is_mine (const jack_client_t *client, const jack_port_t *port);
+    int port_connected (const jack_port_t *port);
+    int port_connected_to (const jack_port_t *port, const char *port_name);
+    const char ** port_get_connections (const jack_port_t *port);
+    const char ** port_get_all_connections (const jack_client_t *client, const jack_port_t *port);
+    jack_nframes_t port_get_latency (jack_port_t *port);
+    jack_nframes_t port_get_total_latency (jack_client_t *client, jack_port_t *port);
+    void port_set_latency (jack_port_t *port, jack_nframes_t nframes);
+    int recompute_total_latency (jack_client_t *client, jack_port_t *port);
+    int recompute_total_latencies (jack_client_t *client);
+    int port_set_name (jack_port_t *port, const char *port_name);
+    int port_set_alias (jack_port_t *port, const char *alias);
+    int port_unset_alias (jack_port_t *port, const char *alias);
+    int port_get_aliases (const jack_port_t *port, char* const aliases[]);
+    int port_request_monitor (jack_port_t *port, int onoff);
+    int port_request_monitor_by_name (jack_client_t *client, const char *port_name, int onoff);
+    int port_ensure_monitor (jack_port_t *port, int onoff);
+    int port_monitoring_input (jack_port_t *port);
+    int connect (jack_client_t *client, const char *source_port, const char *destination_port);
+    int disconnect (jack_client_t *client, const char *source_port, const char *destination_port);
+    int port_disconnect (jack_client_t *client, jack_port_t *port);
+    int port_name_size();
+    int port_type_size();
+    const char ** get_ports (jack_client_t *client, const char *port_name_pattern, const char *type_name_pattern, unsigned long flags);
+    jack_port_t * port_by_name (jack_client_t *client, const char *port_name);
+    jack_port_t * port_by_id (jack_client_t *client, jack_port_id_t port_id);
+    jack_nframes_t frames_since_cycle_start (const jack_client_t *client);
+    jack_nframes_t frame_time (const jack_client_t *client);
+    jack_nframes_t last_frame_time (const jack_client_t *client);
+    jack_time_t frames_to_time(const jack_client_t *client, jack_nframes_t nframes);
+    jack_nframes_t time_to_frames(const jack_client_t *client, jack_time_t time);
+    jack_time_t get_time();
+    void set_error_function (void (*func)(const char *));
+    void set_info_function (void (*func)(const char *));
+    void free(void* ptr);
+    // Jack transport API methods:
+    int  release_timebase (jack_client_t *client);
+    int  set_sync_callback (jack_client_t *client, JackSyncCallback sync_callback, void *arg);
+    int  set_sync_timeout (jack_client_t *client, jack_time_t timeout);
+    int  set_timebase_callback (jack_client_t *client, int conditional, JackTimebaseCallback timebase_callback, void *arg);
+    int  transport_locate (jack_client_t *client, jack_nframes_t frame);
+    jack_transport_state_t transport_query (const jack_client_t *client, jack_position_t *pos);
+    jack_nframes_t get_current_transport_frame (const jack_client_t *client);
+    int  transport_reposition (jack_client_t *client, jack_position_t *pos);
+    void transport_start (jack_client_t *client);
+    void transport_stop (jack_client_t *client);
+    void get_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
+    void set_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
+    // Jack thread API methods:
+    int client_real_time_priority (jack_client_t *client);
+    int client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg);
+    int client_stop_thread (jack_client_t *client, jack_native_thread_t thread);
+
+private:
+    struct OfflineJackPort;
+    struct OfflineJackClient {
+        std::string name;
+        bool active, threadInitialized;
+        JackProcessCallback processCallback;
+        void *processArg;
+        JackThreadInitCallback threadInitCallback;
+        void *threadInitArg;
+        JackBufferSizeCallback bufferSizeCallback;
+        void *bufferSizeArg;
+        JackSampleRateCallback sampleRateCallback;
+        void *sampleRateArg;
+        JackFreewheelCallback freewheelCallback;
+        void *freewheelArg;
+        JackSyncCallback syncCallback;
+        void *syncArg;
+        JackShutdownCallback shutdownCallback;
+        void *shutdownArg;
+        JackInfoShutdownCallback infoShutdownCallback;
+        void *infoShutdownArg;
+        std::list<OfflineJackPort*> ports;
+    };
+    struct OfflineJackPort {
+        OfflineJackClient *client;
+        jack_port_id_t id;
+        std::string shortName, fullName, type;
+        unsigned long flags;
+        std::vector<char> bufferMemory;
+        void *buffer;
+    };
+
+    std::string name;
+    jack_nframes_t sampleRate, bufferSize, frameTime;
+    int freewheel;
+    jack_transport_state_t transportState;
+    jack_position_t transportPosition;
+    bool newTransportPosition;
+    OfflineJackClient *timebaseMaster;
+    JackTimebaseCallback timebaseCallback;
+    void *timebaseArg;
+    pthread_t processThread;
+    jack_port_id_t nextPortId;
+    // clients in the order of their activation (inactive clients are at the end):
+    std::list<OfflineJackClient*> clients;
+    std::map<std::string, OfflineJackPort*> portsByName;
+    std::map<jack_port_id_t, OfflineJackPort*> portsById;
+
+    OfflineJackClient * getClientByName(const std::string &clientName) const;
+    void allocatePortBuffer(OfflineJackPort *port);
+    void updateTransport();
+};
+
+#endif // OFFLINEJACKCONTEXT_H
@@ -0,0 +1,156 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "polyphaseresampler.h"
+#include <math.h>
+
+// zeroth order modified Bessel function of the first kind, needed for the Kaiser window:
+static double besselI0(double x)
+{
+    double sum = 1, term = 1;
+    for (int k = 1; k < 50; k++) {
+        double factor = x / (2 * k);
+        term *= factor * factor;
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+PolyphaseResampler::PolyphaseResampler(unsigned int factor_, Quality quality_) :
+    factor(factor_ ? factor_ : 1),
+    historyIndex(0),
+    quality(quality_)
+{
+    // choose the filter length (in samples at the base rate), the Kaiser window's shape
+    // and the cutoff frequency (relative to the base rate's Nyquist frequency):
+    double beta, cutoff;
+    if (quality == LOW_LATENCY) {
+        tapsPerPhase = 8;
+        beta = 5;
+        cutoff = 0.8;
+    } else if (quality == MEDIUM_QUALITY) {
+        tapsPerPhase = 16;
+        beta = 7;
+        cutoff = 0.88;
+    } else {
+        tapsPerPhase = 32;
+        beta = 9;
+        cutoff = 0.92;
+    }
+    // compute the prototype lowpass filter at the higher sample rate:
+    unsigned int size = tapsPerPhase * factor;
+    coefficients.resize(size);
+    double frequency = 0.5 * cutoff / factor;
+    double center = 0.5 * (size - 1);
+    double sum = 0;
+    for (unsigned int i = 0; i < size; i++) {
+        double x = i - center;
+        double sinc = (x == 0 ? 2 * frequency : sin(2 * M_PI * frequency * x) / (M_PI * x));
+        double windowX = x / center;
+        double window = besselI0(beta * sqrt(1 - windowX * windowX)) / besselI0(beta);
+        coefficients[i] = sinc * window;
+        sum += coefficients[i];
+    }
+    // normalize to unity gain at DC:
+    for (unsigned int i = 0; i < size; i++) {
+        coefficients[i] /= sum;
+    }
+    // split into the polyphase components for upsampling:
+    // (output phase p at base rate input m is the sum over t of coefficients[p + t * factor] * input[m - t],
+    // the factor compensates for the energy lost by inserting zeros)
+    phaseCoefficients.resize(size);
+    for (unsigned int phase = 0; phase < factor; phase++) {
+        for (unsigned int j = 0; j < tapsPerPhase; j++) {
+            // reversed, such that the taps can be applied to the history in the order of time:
+            phaseCoefficients[phase * tapsPerPhase + j] = coefficients[phase + (tapsPerPhase - 1 - j) * factor] * factor;
+        }
+    }
+    // the history has to hold the prototype filter's length of samples for downsampling:
+    historySize = size;
+    history.resize(historySize * 2);
+    reset();
+}
+
+unsigned int PolyphaseResampler::getFactor() const
+{
+    return factor;
+}
+
+PolyphaseResampler::Quality PolyphaseResampler::getQuality() const
+{
+    return quality;
+}
+
+unsigned int PolyphaseResampler::getLatency() const
+{
+    return (tapsPerPhase * factor - 1) / 2;
+}
+
+void PolyphaseResampler::reset()
+{
+    for (size_t i = 0; i < history.size(); i++) {
+        history[i] = 0;
+    }
+    historyIndex = 0;
+}
+
+void PolyphaseResampler::upsample(const jack_default_audio_sample_t *input, jack_default_audio_sample_t *output, jack_nframes_t nframes)
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    // only the last tapsPerPhase input samples are needed for upsampling:
+    float *historyData = &history[0];
+    for (jack_nframes_t i = 0; i < nframes; i++) {
+        historyData[historyIndex] = historyData[historyIndex + tapsPerPhase] = input[i];
+        historyIndex = (historyIndex + 1 == tapsPerPhase ? 0 : historyIndex + 1);
+        // the last tapsPerPhase samples, from oldest to newest:
+        const float *window = historyData + historyIndex;
+        const float *phaseData = &phaseCoefficients[0];
+        for (unsigned int phase = 0; phase < factor; phase++, phaseData += tapsPerPhase) {
+            float sum = 0;
+            for (unsigned int j = 0; j < tapsPerPhase; j++) {
+                sum += phaseData[j] * window[j];
+            }
+            *output++ = sum;
+        }
+    }
+}
+
+void PolyphaseResampler::downsample(const jack_default_audio_sample_t *input, jack_default_audio_sample_t *output, jack_nframes_t nframes)
+{
+    // this will be called from the process thread, so no memory allocation must be done here!
+    float *historyData = &history[0];
+    const float *coefficientData = &coefficients[0];
+    for (jack_nframes_t i = 0; i < nframes; i++) {
+        for (unsigned int j = 0; j < factor; j++) {
+            historyData[historyIndex] = historyData[historyIndex + historySize] = *input++;
+            historyIndex = (historyIndex + 1 == historySize ? 0 : historyIndex + 1);
+        }
+        // compute only the output sample which is kept (the prototype filter is symmetric,
+        // thus it can be applied to the history from oldest to newest sample):
+        const float *window = historyData + historyIndex;
+        float sum = 0;
+        for (unsigned int j = 0; j < historySize; j++) {
+            sum += coefficientData[j] * window[j];
+        }
+        output[i] = sum;
+    }
+}
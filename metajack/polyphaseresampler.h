@@ -0,0 +1,88 @@
+#ifndef POLYPHASERESAMPLER_H
+#define POLYPHASERESAMPLER_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <jack/types.h>
+
+/**
+  Converts audio between a base sample rate and an integer multiple of it
+  using a windowed-sinc lowpass filter in polyphase form.
+
+  Upsampling computes each output sample from one phase of the filter, i.e.
+  only from the non-zero input samples. Downsampling computes only the output
+  samples which are kept. In both cases the input history is kept in a
+  contiguous buffer (each sample is stored twice), such that the filter taps
+  can be applied without any index wrap-around.
+
+  A resampler object should only be used for one direction.
+  */
+class PolyphaseResampler {
+public:
+    /**
+      Presets trading latency and computational cost against quality
+      (i.e., stopband attenuation and transition bandwidth).
+      */
+    enum Quality {
+        LOW_LATENCY,
+        MEDIUM_QUALITY,
+        HIGH_QUALITY
+    };
+
+    /**
+      Computes the filter coefficients for the given factor. This involves
+      memory allocation, so it must not be called from the process thread.
+      */
+    PolyphaseResampler(unsigned int factor = 1, Quality quality = MEDIUM_QUALITY);
+
+    unsigned int getFactor() const;
+    Quality getQuality() const;
+    /**
+      @return the latency of the resampler in samples at the higher sample rate
+      */
+    unsigned int getLatency() const;
+    /**
+      Clears the input history.
+      */
+    void reset();
+
+    /**
+      Converts nframes input samples at the base sample rate into nframes * factor
+      output samples at the higher sample rate.
+      */
+    void upsample(const jack_default_audio_sample_t *input, jack_default_audio_sample_t *output, jack_nframes_t nframes);
+    /**
+      Converts nframes * factor input samples at the higher sample rate into nframes
+      output samples at the base sample rate.
+      */
+    void downsample(const jack_default_audio_sample_t *input, jack_default_audio_sample_t *output, jack_nframes_t nframes);
+private:
+    unsigned int factor, tapsPerPhase, historySize, historyIndex;
+    Quality quality;
+    // the prototype filter, used for downsampling:
+    std::vector<float> coefficients;
+    // the polyphase components of the prototype filter (scaled and reversed), used for upsampling:
+    std::vector<float> phaseCoefficients;
+    // twice the history size, the second half mirrors the first:
+    std::vector<float> history;
+};
+
+#endif // POLYPHASERESAMPLER_H
@@ -20,6 +20,7 @@
 #include "realjackcontext.h"
 #include <jack/jack.h>
 #include <jack/transport.h>
+#include <jack/thread.h>
 
 RealJackContext::RealJackContext() :
     name("jack")
@@ -473,6 +474,21 @@ void RealJackContext::set_transport_info (jack_client_t *client, jack_transport_
     jack_set_transport_info(client, tinfo);
 }
 
+int RealJackContext::client_real_time_priority (jack_client_t *client)
+{
+    return jack_client_real_time_priority(client);
+}
+
+int RealJackContext::client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg)
+{
+    return jack_client_create_thread(client, thread, priority, realtime, start_routine, arg);
+}
+
+int RealJackContext::client_stop_thread (jack_client_t *client, jack_native_thread_t thread)
+{
+    return jack_client_stop_thread(client, thread);
+}
+
 jack_nframes_t RealJackContext::midi_get_event_count(void* port_buffer)
 {
     return jack_midi_get_event_count(port_buffer);
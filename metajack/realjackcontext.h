@@ -122,6 +122,10 @@ public:
     void transport_stop (jack_client_t *client);
     void get_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
     void set_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
+    // Jack thread API methods:
+    int client_real_time_priority (jack_client_t *client);
+    int client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg);
+    int client_stop_thread (jack_client_t *client, jack_native_thread_t thread);
 
     static jack_nframes_t midi_get_event_count(void* port_buffer);
     static int midi_event_get(jack_midi_event_t *event, void *port_buffer, jack_nframes_t event_index);
@@ -21,6 +21,7 @@
 #include "realjackcontext.h"
 #include "metajackcontext.h"
 #include <QStringList>
+#include <cassert>
 
 RecursiveJackContext RecursiveJackContext::instance;
 
@@ -29,7 +30,8 @@ RecursiveJackContext * RecursiveJackContext::getInstance()
     return &instance;
 }
 
-RecursiveJackContext::RecursiveJackContext()
+RecursiveJackContext::RecursiveJackContext() :
+    threadCount(1)
 {
     // put the interface to the real server on the stack as the first interface to be used:
     interfaces.push(new RealJackContext());
@@ -40,6 +42,10 @@ RecursiveJackContext::RecursiveJackContext()
 
 RecursiveJackContext::~RecursiveJackContext()
 {
+    // delete all port handles:
+    for (std::map<std::pair<JackContext*, const jack_port_t*>, RecursiveJackPort*>::iterator i = portHandles.begin(); i != portHandles.end(); i++) {
+        delete i->second;
+    }
     // delete all jack interfaces:
     for (; interfaces.size(); ) {
         delete interfaces.top();
@@ -55,7 +61,7 @@ JackContext * RecursiveJackContext::getCurrentContext()
 JackContext * RecursiveJackContext::pushNewContext(const std::string &desiredWrapperClientName, unsigned int oversampling)
 {
     // create a new meta jack context:
-    MetaJackContext *context = new MetaJackContext(interfaceStack.top(), desiredWrapperClientName, oversampling);
+    MetaJackContext *context = new MetaJackContext(interfaceStack.top(), desiredWrapperClientName, oversampling, threadCount);
     interfaces.push(context);
     // get its name in the current jack context and remember it:
     std::string wrapperClientName = context->getWrapperInterface()->get_client_name(context->getWrapperClient());
@@ -90,6 +96,29 @@ JackContext * RecursiveJackContext::popContext()
     return interfaceStack.top();
 }
 
+void RecursiveJackContext::setThreadCount(unsigned int threadCount)
+{
+    this->threadCount = threadCount;
+    // apply the thread count to all existing meta jack contexts:
+    std::stack<JackContext*> temp;
+    for (; interfaces.size(); ) {
+        if (MetaJackContext *metaJackContext = dynamic_cast<MetaJackContext*>(interfaces.top())) {
+            metaJackContext->setThreadCount(threadCount);
+        }
+        temp.push(interfaces.top());
+        interfaces.pop();
+    }
+    for (; temp.size(); ) {
+        interfaces.push(temp.top());
+        temp.pop();
+    }
+}
+
+unsigned int RecursiveJackContext::getThreadCount() const
+{
+    return threadCount;
+}
+
 void RecursiveJackContext::deleteContext(JackContext *context)
 {
     // remove the context from our list and stack:
@@ -114,6 +143,7 @@ void RecursiveJackContext::deleteContext(JackContext *context)
         interfaces.push(temp.top());
         temp.pop();
     }
+    deletePortHandles(context);
     delete context;
 }
 
@@ -140,6 +170,10 @@ void RecursiveJackContext::saveCurrentContext(QDataStream &stream, MetaJackClien
         JackContext *wrapperContext = getContextByClientName(context, clientName.toAscii().data());
         stream << (wrapperContext != 0);
         if (wrapperContext) {
+            // save the oversampling and how the wrapper ports are resampled:
+            MetaJackContext *metaJackWrapperContext = dynamic_cast<MetaJackContext*>(wrapperContext);
+            assert(metaJackWrapperContext);
+            stream << metaJackWrapperContext->getOversampling() << (int)metaJackWrapperContext->getResamplingQuality();
             // save the context:
             pushExistingContext(wrapperContext);
             saveCurrentContext(stream, clientSaver);
@@ -176,6 +210,11 @@ void RecursiveJackContext::saveCurrentContext(QDataStream &stream, MetaJackClien
 
 void RecursiveJackContext::loadCurrentContext(QDataStream &stream, MetaJackClientSerializer *clientLoader)
 {
+    // send the changes of all loaded clients and connections to the process thread at once:
+    MetaJackContext *metaJackContext = dynamic_cast<MetaJackContext*>(getCurrentContext());
+    if (metaJackContext) {
+        metaJackContext->beginGraphTransaction();
+    }
     // load the client count:
     int clientCount;
     stream >> clientCount;
@@ -188,8 +227,15 @@ void RecursiveJackContext::loadCurrentContext(QDataStream &stream, MetaJackClien
         bool isWrapperClient;
         stream >> isWrapperClient;
         if (isWrapperClient) {
+            // load the oversampling and how the wrapper ports are resampled:
+            unsigned int oversampling;
+            int resamplingQuality;
+            stream >> oversampling >> resamplingQuality;
             // create a new context:
-            pushNewContext(clientName.toAscii().data());
+            MetaJackContext *wrapperContext = dynamic_cast<MetaJackContext*>(pushNewContext(clientName.toAscii().data(), oversampling));
+            assert(wrapperContext);
+            // (before the connections are loaded, as they create the resamplers)
+            wrapperContext->setResamplingQuality((PolyphaseResampler::Quality)resamplingQuality);
             // load the context:
             loadCurrentContext(stream, clientLoader);
             popContext();
@@ -208,6 +254,9 @@ void RecursiveJackContext::loadCurrentContext(QDataStream &stream, MetaJackClien
         QString destPortName = portNames[1];
         getCurrentContext()->connect(client, sourcePortName.toAscii().data(), destPortName.toAscii().data());
     }
+    if (metaJackContext) {
+        metaJackContext->commitGraphTransaction();
+    }
 }
 
 JackContext * RecursiveJackContext::getContextByClientName(const std::string &clientName)
@@ -271,6 +320,28 @@ int RecursiveJackContext::client_close (jack_client_t *client)
     return returnValue;
 }
 
+void RecursiveJackContext::setClientSilenceTail(jack_client_t *client, jack_nframes_t silenceTail)
+{
+    std::map<const jack_client_t*, JackContext*>::iterator find = mapClientToInterface.find(client);
+    if (find != mapClientToInterface.end()) {
+        MetaJackContext *metaJackContext = dynamic_cast<MetaJackContext*>(find->second);
+        if (metaJackContext) {
+            metaJackContext->setSilenceTail((MetaJackClient*)client, silenceTail);
+        }
+    }
+}
+
+void RecursiveJackContext::wakeClient(jack_client_t *client)
+{
+    std::map<const jack_client_t*, JackContext*>::iterator find = mapClientToInterface.find(client);
+    if (find != mapClientToInterface.end()) {
+        MetaJackContext *metaJackContext = dynamic_cast<MetaJackContext*>(find->second);
+        if (metaJackContext) {
+            metaJackContext->wakeClient((MetaJackClient*)client);
+        }
+    }
+}
+
 int RecursiveJackContext::client_name_size ()
 {
     return interfaceStack.top()->client_name_size();
@@ -398,93 +469,103 @@ float RecursiveJackContext::cpu_load (jack_client_t *client)
 
 jack_port_t * RecursiveJackContext::port_register (jack_client_t *client, const char *port_name, const char *port_type, unsigned long flags, unsigned long buffer_size)
 {
-    jack_port_t *port = mapClientToInterface[client]->port_register(client, port_name, port_type, flags, buffer_size);
-    if (port) {
-        mapPortToInterface[port] = mapClientToInterface[client];
-    }
-    return port;
+    JackContext *context = mapClientToInterface[client];
+    return createPortHandle(context, context->port_register(client, port_name, port_type, flags, buffer_size));
 }
 
 int RecursiveJackContext::port_unregister (jack_client_t *client, jack_port_t *port)
 {
-    int returnValue = mapClientToInterface[client]->port_unregister(client, port);
+    int returnValue = mapClientToInterface[client]->port_unregister(client, getPortHandle(port)->port);
     if (returnValue == 0) {
-        mapPortToInterface.erase(port);
+        deletePortHandle(port);
     }
     return returnValue;
 }
 
 void * RecursiveJackContext::port_get_buffer (jack_port_t *port, jack_nframes_t nframes)
 {
-    return mapPortToInterface[port]->port_get_buffer(port, nframes);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_get_buffer(handle->port, nframes);
 }
 
 const char * RecursiveJackContext::port_name (const jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_name(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_name(handle->port);
 }
 
 const char * RecursiveJackContext::port_short_name (const jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_short_name(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_short_name(handle->port);
 }
 
 int RecursiveJackContext::port_flags (const jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_flags(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_flags(handle->port);
 }
 
 const char * RecursiveJackContext::port_type (const jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_type(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_type(handle->port);
 }
 
 int RecursiveJackContext::port_is_mine (const jack_client_t *client, const jack_port_t *port)
 {
-    return mapClientToInterface[client]->port_is_mine(client, port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    JackContext *context = mapClientToInterface[client];
+    // ports of other contexts can not belong to the client:
+    return (handle->context == context ? context->port_is_mine(client, handle->port) : 0);
 }
 
 int RecursiveJackContext::port_connected (const jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_connected(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_connected(handle->port);
 }
 
 int RecursiveJackContext::port_connected_to (const jack_port_t *port, const char *port_name)
 {
-    return mapPortToInterface[port]->port_connected_to(port, port_name);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_connected_to(handle->port, port_name);
 }
 
 const char ** RecursiveJackContext::port_get_connections (const jack_port_t *port)
 {
-    const char ** returnValue = mapPortToInterface[port]->port_get_connections(port);
-    mapPointerToInterface[(void*)returnValue] = mapPortToInterface[port];
+    const RecursiveJackPort *handle = getPortHandle(port);
+    const char ** returnValue = handle->context->port_get_connections(handle->port);
+    mapPointerToInterface[(void*)returnValue] = handle->context;
     return returnValue;
 }
 
 const char ** RecursiveJackContext::port_get_all_connections (const jack_client_t *client, const jack_port_t *port)
 {
-    const char ** returnValue = mapClientToInterface[client]->port_get_all_connections(client, port);
+    const char ** returnValue = mapClientToInterface[client]->port_get_all_connections(client, getPortHandle(port)->port);
     mapPointerToInterface[(void*)returnValue] = mapClientToInterface[client];
     return returnValue;
 }
 
 jack_nframes_t RecursiveJackContext::port_get_latency (jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_get_latency(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_get_latency(handle->port);
 }
 
 jack_nframes_t RecursiveJackContext::port_get_total_latency (jack_client_t *client, jack_port_t *port)
 {
-    return mapClientToInterface[client]->port_get_total_latency(client, port);
+    return mapClientToInterface[client]->port_get_total_latency(client, getPortHandle(port)->port);
 }
 
 void RecursiveJackContext::port_set_latency (jack_port_t *port, jack_nframes_t nframes) {
-    mapPortToInterface[port]->port_set_latency(port, nframes);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    handle->context->port_set_latency(handle->port, nframes);
 }
 
 int RecursiveJackContext::recompute_total_latency (jack_client_t *client, jack_port_t *port)
 {
-    return mapClientToInterface[client]->recompute_total_latency(client, port);
+    return mapClientToInterface[client]->recompute_total_latency(client, getPortHandle(port)->port);
 }
 
 int RecursiveJackContext::recompute_total_latencies (jack_client_t *client)
@@ -494,26 +575,31 @@ int RecursiveJackContext::recompute_total_latencies (jack_client_t *client)
 
 int RecursiveJackContext::port_set_name (jack_port_t *port, const char *port_name)
 {
-    return mapPortToInterface[port]->port_set_name(port, port_name);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_set_name(handle->port, port_name);
 }
 
 int RecursiveJackContext::port_set_alias (jack_port_t *port, const char *alias) {
-    return mapPortToInterface[port]->port_set_alias(port, alias);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_set_alias(handle->port, alias);
 }
 
 int RecursiveJackContext::port_unset_alias (jack_port_t *port, const char *alias)
 {
-    return mapPortToInterface[port]->port_unset_alias(port, alias);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_unset_alias(handle->port, alias);
 }
 
 int RecursiveJackContext::port_get_aliases (const jack_port_t *port, char* const aliases[])
 {
-    return mapPortToInterface[port]->port_get_aliases(port, aliases);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_get_aliases(handle->port, aliases);
 }
 
 int RecursiveJackContext::port_request_monitor (jack_port_t *port, int onoff)
 {
-    return mapPortToInterface[port]->port_request_monitor(port, onoff);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_request_monitor(handle->port, onoff);
 }
 
 int RecursiveJackContext::port_request_monitor_by_name (jack_client_t *client, const char *port_name, int onoff)
@@ -523,12 +609,14 @@ int RecursiveJackContext::port_request_monitor_by_name (jack_client_t *client, c
 
 int RecursiveJackContext::port_ensure_monitor (jack_port_t *port, int onoff)
 {
-    return mapPortToInterface[port]->port_ensure_monitor(port, onoff);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_ensure_monitor(handle->port, onoff);
 }
 
 int RecursiveJackContext::port_monitoring_input (jack_port_t *port)
 {
-    return mapPortToInterface[port]->port_monitoring_input(port);
+    const RecursiveJackPort *handle = getPortHandle(port);
+    return handle->context->port_monitoring_input(handle->port);
 }
 
 int RecursiveJackContext::connect (jack_client_t *client, const char *source_port, const char *destination_port)
@@ -543,7 +631,7 @@ int RecursiveJackContext::disconnect (jack_client_t *client, const char *source_
 
 int RecursiveJackContext::port_disconnect (jack_client_t *client, jack_port_t *port)
 {
-    return mapClientToInterface[client]->port_disconnect(client, port);
+    return mapClientToInterface[client]->port_disconnect(client, getPortHandle(port)->port);
 }
 
 int RecursiveJackContext::port_name_size()
@@ -565,20 +653,14 @@ const char ** RecursiveJackContext::get_ports (jack_client_t *client, const char
 
 jack_port_t * RecursiveJackContext::port_by_name (jack_client_t *client, const char *port_name)
 {
-    jack_port_t *port = mapClientToInterface[client]->port_by_name(client, port_name);
-    if (port) {
-        mapPortToInterface[port] = mapClientToInterface[client];
-    }
-    return port;
+    JackContext *context = mapClientToInterface[client];
+    return createPortHandle(context, context->port_by_name(client, port_name));
 }
 
 jack_port_t * RecursiveJackContext::port_by_id (jack_client_t *client, jack_port_id_t port_id)
 {
-    jack_port_t *port = mapClientToInterface[client]->port_by_id(client, port_id);
-    if (port) {
-        mapPortToInterface[port] = mapClientToInterface[client];
-    }
-    return port;
+    JackContext *context = mapClientToInterface[client];
+    return createPortHandle(context, context->port_by_id(client, port_id));
 }
 
 jack_nframes_t RecursiveJackContext::frames_since_cycle_start (const jack_client_t *client)
@@ -687,6 +769,21 @@ void RecursiveJackContext::set_transport_info (jack_client_t *client, jack_trans
     mapClientToInterface[client]->set_transport_info(client, tinfo);
 }
 
+int RecursiveJackContext::client_real_time_priority (jack_client_t *client)
+{
+    return mapClientToInterface[client]->client_real_time_priority(client);
+}
+
+int RecursiveJackContext::client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg)
+{
+    return mapClientToInterface[client]->client_create_thread(client, thread, priority, realtime, start_routine, arg);
+}
+
+int RecursiveJackContext::client_stop_thread (jack_client_t *client, jack_native_thread_t thread)
+{
+    return mapClientToInterface[client]->client_stop_thread(client, thread);
+}
+
 jack_nframes_t RecursiveJackContext::midi_get_event_count(void* port_buffer)
 {
     MetaJackContext::MetaJackContextMidiBufferHead *head = (MetaJackContext::MetaJackContextMidiBufferHead*)port_buffer;
@@ -756,3 +853,50 @@ jack_nframes_t RecursiveJackContext::midi_get_lost_event_count(void *port_buffer
         return RealJackContext::midi_get_lost_event_count(port_buffer);
     }
 }
+
+jack_port_t * RecursiveJackContext::createPortHandle(JackContext *context, jack_port_t *port)
+{
+    if (!port) {
+        return 0;
+    }
+    // hand out the same handle each time a port is asked for, as clients may compare port handles:
+    std::pair<JackContext*, const jack_port_t*> key(context, port);
+    std::map<std::pair<JackContext*, const jack_port_t*>, RecursiveJackPort*>::iterator find = portHandles.find(key);
+    if (find != portHandles.end()) {
+        return (jack_port_t*)find->second;
+    }
+    RecursiveJackPort *handle = new RecursiveJackPort();
+    handle->context = context;
+    handle->port = port;
+    portHandles[key] = handle;
+    return (jack_port_t*)handle;
+}
+
+void RecursiveJackContext::deletePortHandle(jack_port_t *port)
+{
+    RecursiveJackPort *handle = getPortHandle(port);
+    portHandles.erase(std::make_pair(handle->context, (const jack_port_t*)handle->port));
+    delete handle;
+}
+
+void RecursiveJackContext::deletePortHandles(JackContext *context)
+{
+    for (std::map<std::pair<JackContext*, const jack_port_t*>, RecursiveJackPort*>::iterator i = portHandles.begin(); i != portHandles.end(); ) {
+        if (i->first.first == context) {
+            delete i->second;
+            portHandles.erase(i++);
+        } else {
+            i++;
+        }
+    }
+}
+
+RecursiveJackContext::RecursiveJackPort * RecursiveJackContext::getPortHandle(jack_port_t *port)
+{
+    return (RecursiveJackPort*)port;
+}
+
+const RecursiveJackContext::RecursiveJackPort * RecursiveJackContext::getPortHandle(const jack_port_t *port)
+{
+    return (const RecursiveJackPort*)port;
+}
@@ -36,6 +36,11 @@ public:
 
     // own methods controlling the Jack interface currently active:
     JackContext * getCurrentContext();
+    /**
+      Creates a new MetaJackContext within the current context and makes it
+      the current one. It processes its clients with the number of threads
+      given by setThreadCount().
+      */
     JackContext * pushNewContext(const std::string &desiredWrapperClientName, unsigned int oversampling = 1);
     JackContext * pushExistingContext(JackContext *jackInterface);
     JackContext * pushExistingContextByClient(jack_client_t *client);
@@ -43,6 +48,15 @@ public:
     void deleteContext(JackContext *context);
     size_t getContextStackSize() const;
 
+    /**
+      Sets the number of threads with which each MetaJackContext processes
+      its clients (see MetaJackContext::setThreadCount()). This applies to
+      the existing contexts as well as to the ones created afterwards.
+      The default is one thread, i.e. serial processing.
+      */
+    void setThreadCount(unsigned int threadCount);
+    unsigned int getThreadCount() const;
+
     void saveCurrentContext(QDataStream &stream, MetaJackClientSerializer *clientSaver);
     void loadCurrentContext(QDataStream &stream, MetaJackClientSerializer *clientLoader);
 
@@ -63,6 +77,18 @@ public:
       */
     JackContext * getContextByClientName(JackContext *context, const std::string &clientName);
 
+    /**
+      Lets the given client be skipped while it is idle, if it belongs to a
+      MetaJackContext (see MetaJackContext::setSilenceTail()). This has no
+      effect for clients of other contexts.
+      */
+    void setClientSilenceTail(jack_client_t *client, jack_nframes_t silenceTail);
+    /**
+      Makes sure the given client is processed in the next cycles, if it
+      belongs to a MetaJackContext (see MetaJackContext::wakeClient()).
+      */
+    void wakeClient(jack_client_t *client);
+
     // methods reimplemented from JackInterface:
     jack_client_t * client_by_name(const char *client_name);
     std::list<jack_client_t*> get_clients();
@@ -152,6 +178,10 @@ public:
     void transport_stop (jack_client_t *client);
     void get_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
     void set_transport_info (jack_client_t *client, jack_transport_info_t *tinfo);
+    // Jack thread API methods:
+    int client_real_time_priority (jack_client_t *client);
+    int client_create_thread (jack_client_t *client, jack_native_thread_t *thread, int priority, int realtime, void *(*start_routine)(void*), void *arg);
+    int client_stop_thread (jack_client_t *client, jack_native_thread_t thread);
 
     static jack_nframes_t midi_get_event_count(void* port_buffer);
     static int midi_event_get(jack_midi_event_t *event, void *port_buffer, jack_nframes_t event_index);
@@ -162,15 +192,35 @@ public:
     static jack_nframes_t midi_get_lost_event_count(void *port_buffer);
 
 private:
+    /**
+      The port handles handed out by this class. Each one carries the
+      context owning the port and that context's own handle of the port,
+      such that methods on ports (in particular port_get_buffer(), which
+      is called for every port in every process cycle) do not have to look
+      up the context.
+      */
+    struct RecursiveJackPort {
+        JackContext *context;
+        jack_port_t *port;
+    };
+
     std::stack<JackContext*> interfaces, interfaceStack;
     std::map<const jack_client_t*, JackContext*> mapClientToInterface;
-    std::map<const jack_port_t*, JackContext*> mapPortToInterface;
+    // the port handles by context and port, only used by non-realtime methods:
+    std::map<std::pair<JackContext*, const jack_port_t*>, RecursiveJackPort*> portHandles;
     std::map<void*, JackContext*> mapPointerToInterface;
     std::map<JackContext*, std::map<std::string, JackContext*> > mapClientNameToInterface;
     std::map<jack_client_t*, QVariant> clientProperties;
+    unsigned int threadCount;
 
     RecursiveJackContext();
     static RecursiveJackContext instance;
+
+    jack_port_t * createPortHandle(JackContext *context, jack_port_t *port);
+    void deletePortHandle(jack_port_t *port);
+    void deletePortHandles(JackContext *context);
+    static RecursiveJackPort * getPortHandle(jack_port_t *port);
+    static const RecursiveJackPort * getPortHandle(const jack_port_t *port);
 };
 
 #endif // RECURSIVEJACKCONTEXT_H
@@ -51,6 +51,21 @@ void MultiplyProcessor::processAudio(const double *inputs, double *outputs, jack
     outputs[0] = product;
 }
 
+void MultiplyProcessor::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    jack_default_audio_sample_t *output = outputs[0];
+    for (jack_nframes_t i = start; i < end; i++) {
+        output[i] = gain;
+    }
+    // multiply all inputs, one input at a time:
+    for (int j = 0; j < getNrOfAudioInputs(); j++) {
+        const jack_default_audio_sample_t *input = inputs[j];
+        for (jack_nframes_t i = start; i < end; i++) {
+            output[i] *= input[i];
+        }
+    }
+}
+
 MultiplyClient::MultiplyClient(const QString &clientName) :
     AudioProcessorClient(clientName, new MultiplyProcessor())
 {
@@ -32,6 +32,7 @@ public:
     double getGainFactor() const;
 
     void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
 
 private:
     double gain;
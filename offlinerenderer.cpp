@@ -0,0 +1,245 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "offlinerenderer.h"
+#include "jackclient.h"
+#include "metajack/recursivejackcontext.h"
+#include <QFile>
+#include <QMap>
+#include <QPointF>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <cstring>
+
+static void appendLittleEndian(QByteArray &data, quint32 value, int byteCount)
+{
+    for (int i = 0; i < byteCount; i++, value >>= 8) {
+        data.append((char)(value & 0xff));
+    }
+}
+
+OfflineRenderer::OfflineRenderer(jack_nframes_t sampleRate, jack_nframes_t bufferSize, unsigned int threadCount) :
+    offlineContext(new OfflineJackContext("offline", sampleRate, bufferSize)),
+    hasMidiFile(false),
+    outputChannelCount(0),
+    renderedFrameCount(0),
+    renderTime(0)
+{
+    // the session gets its own context on top of the offline context, like a macro:
+    RecursiveJackContext::getInstance()->pushExistingContext(offlineContext);
+    sessionContext = (MetaJackContext*)RecursiveJackContext::getInstance()->pushNewContext("session");
+    sessionContext->setThreadCount(threadCount);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    // nothing drives the offline context's process cycles anymore, so the session's graph changes have to be applied directly:
+    sessionContext->stopProcessing();
+    // delete all clients in the session context:
+    std::list<jack_client_t*> clients = sessionContext->get_clients();
+    for (std::list<jack_client_t*>::iterator i = clients.begin(); i != clients.end(); i++) {
+        JackClient *jackClient = JackClientSerializer::getInstance()->getClient(*i);
+        if (jackClient) {
+            delete jackClient;
+        } else if (JackContext *context = RecursiveJackContext::getInstance()->getContextByClientName(sessionContext, sessionContext->get_client_name(*i))) {
+            RecursiveJackContext::getInstance()->deleteContext(context);
+        }
+    }
+    RecursiveJackContext::getInstance()->deleteContext(sessionContext);
+    // remove the offline context from the context stack:
+    RecursiveJackContext::getInstance()->popContext();
+    delete offlineContext;
+}
+
+bool OfflineRenderer::loadSession(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = QString("Could not open session file %1").arg(fileName);
+        return false;
+    }
+    QDataStream stream(&file);
+    // the client positions are only relevant to the GUI:
+    QMap<QString, QPointF> clientItemPositionMap;
+    stream >> clientItemPositionMap;
+    // load the clients into the session context:
+    RecursiveJackContext::getInstance()->loadCurrentContext(stream, JackClientSerializer::getInstance());
+    return true;
+}
+
+bool OfflineRenderer::loadMidiFile(const QString &fileName)
+{
+    hasMidiFile = midiFile.load(fileName);
+    if (!hasMidiFile) {
+        errorString = midiFile.getErrorString();
+    }
+    return hasMidiFile;
+}
+
+bool OfflineRenderer::render(const QString &outputFileName, OutputFormat format, double length, double tail)
+{
+    QElapsedTimer timer;
+    timer.start();
+    renderedFrameCount = 0;
+    renderTime = 0;
+    jack_client_t *wrapperClient = sessionContext->getWrapperClient();
+    jack_nframes_t sampleRate = offlineContext->get_sample_rate(wrapperClient);
+    jack_nframes_t bufferSize = offlineContext->get_buffer_size(wrapperClient);
+    // the wrapper client's ports correspond to the session's connections to system_in and system_out:
+    std::list<jack_port_t*> midiInputPorts = getWrapperPorts(JACK_DEFAULT_MIDI_TYPE, JackPortIsInput);
+    // the MIDI file is only fed into the first MIDI input, writing it to all of them would duplicate
+    // the notes for clients connected to more than one:
+    jack_port_t *midiFilePort = (midiInputPorts.size() ? midiInputPorts.front() : 0);
+    std::list<jack_port_t*> audioOutputPorts = getWrapperPorts(JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput);
+    outputChannelCount = audioOutputPorts.size();
+    if (!outputChannelCount) {
+        errorString = "The session has no audio outputs connected to system_out";
+        return false;
+    }
+    if (length <= 0) {
+        length = (hasMidiFile ? midiFile.getLength() : 0);
+    }
+    quint64 frameCount = (quint64)((length + tail) * sampleRate + 0.5);
+    if (!frameCount) {
+        errorString = "Nothing to render, the length is zero";
+        return false;
+    }
+    if ((format == WAVE) && (frameCount * outputChannelCount * sizeof(float) > 0xffffffffULL - 50)) {
+        errorString = "The output is too large for a WAVE file";
+        return false;
+    }
+    QFile file(outputFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorString = QString("Could not open output file %1").arg(outputFileName);
+        return false;
+    }
+    if (format == WAVE) {
+        writeWaveHeader(&file, frameCount);
+    }
+    QVector<StandardMidiFile::Event> noEvents;
+    const QVector<StandardMidiFile::Event> &events = (hasMidiFile ? midiFile.getEvents() : noEvents);
+    int eventIndex = 0;
+    QVector<quint32> interleavedSamples(bufferSize * outputChannelCount);
+    offlineContext->transport_start(wrapperClient);
+    for (quint64 frame = 0; frame < frameCount; frame += bufferSize) {
+        // clear all MIDI inputs and write this cycle's MIDI events to the first one:
+        for (std::list<jack_port_t*>::iterator i = midiInputPorts.begin(); i != midiInputPorts.end(); i++) {
+            RecursiveJackContext::midi_clear_buffer(offlineContext->port_get_buffer(*i, bufferSize));
+        }
+        for (; eventIndex < events.size(); eventIndex++) {
+            quint64 eventFrame = (quint64)(events[eventIndex].time * sampleRate);
+            if (eventFrame >= frame + bufferSize) {
+                break;
+            }
+            if (midiFilePort) {
+                const QByteArray &data = events[eventIndex].data;
+                RecursiveJackContext::midi_event_write(offlineContext->port_get_buffer(midiFilePort, bufferSize), eventFrame - frame, (const jack_midi_data_t*)data.constData(), data.size());
+            }
+        }
+        offlineContext->process();
+        // interleave the outputs (the last cycle may be cut short):
+        jack_nframes_t nframes = (frameCount - frame < bufferSize ? frameCount - frame : bufferSize);
+        int channel = 0;
+        for (std::list<jack_port_t*>::iterator i = audioOutputPorts.begin(); i != audioOutputPorts.end(); i++, channel++) {
+            const jack_default_audio_sample_t *buffer = (const jack_default_audio_sample_t*)offlineContext->port_get_buffer(*i, bufferSize);
+            for (jack_nframes_t j = 0; j < nframes; j++) {
+                quint32 sample;
+                memcpy(&sample, buffer + j, sizeof(sample));
+                interleavedSamples[j * outputChannelCount + channel] = qToLittleEndian(sample);
+            }
+        }
+        qint64 byteCount = nframes * outputChannelCount * sizeof(quint32);
+        if (file.write((const char*)interleavedSamples.constData(), byteCount) != byteCount) {
+            errorString = QString("Could not write to output file %1").arg(outputFileName);
+            return false;
+        }
+        renderedFrameCount += nframes;
+    }
+    offlineContext->transport_stop(wrapperClient);
+    renderTime = timer.elapsed() * 0.001;
+    return true;
+}
+
+int OfflineRenderer::getOutputChannelCount() const
+{
+    return outputChannelCount;
+}
+
+quint64 OfflineRenderer::getRenderedFrameCount() const
+{
+    return renderedFrameCount;
+}
+
+double OfflineRenderer::getRenderTime() const
+{
+    return renderTime;
+}
+
+QString OfflineRenderer::getErrorString() const
+{
+    return errorString;
+}
+
+std::list<jack_port_t*> OfflineRenderer::getWrapperPorts(const char *type, unsigned long flags)
+{
+    std::list<jack_port_t*> ports;
+    jack_client_t *wrapperClient = sessionContext->getWrapperClient();
+    // the offline context returns the ports in the order of their registration:
+    const char **portNames = offlineContext->get_ports(wrapperClient, 0, type, flags);
+    if (portNames) {
+        for (int i = 0; portNames[i]; i++) {
+            jack_port_t *port = offlineContext->port_by_name(wrapperClient, portNames[i]);
+            if (offlineContext->port_is_mine(wrapperClient, port)) {
+                ports.push_back(port);
+            }
+        }
+        offlineContext->free(portNames);
+    }
+    return ports;
+}
+
+void OfflineRenderer::writeWaveHeader(QIODevice *device, quint64 frameCount)
+{
+    jack_nframes_t sampleRate = offlineContext->get_sample_rate(sessionContext->getWrapperClient());
+    quint32 bytesPerFrame = outputChannelCount * sizeof(float);
+    quint32 dataSize = frameCount * bytesPerFrame;
+    QByteArray header;
+    header.append("RIFF", 4);
+    appendLittleEndian(header, 50 + dataSize, 4);
+    header.append("WAVE", 4);
+    // format chunk (IEEE float, which needs the extension size field):
+    header.append("fmt ", 4);
+    appendLittleEndian(header, 18, 4);
+    appendLittleEndian(header, 3, 2);
+    appendLittleEndian(header, outputChannelCount, 2);
+    appendLittleEndian(header, sampleRate, 4);
+    appendLittleEndian(header, sampleRate * bytesPerFrame, 4);
+    appendLittleEndian(header, bytesPerFrame, 2);
+    appendLittleEndian(header, 32, 2);
+    appendLittleEndian(header, 0, 2);
+    // fact chunk, required for non-PCM formats:
+    header.append("fact", 4);
+    appendLittleEndian(header, 4, 4);
+    appendLittleEndian(header, frameCount, 4);
+    // data chunk header, the samples follow:
+    header.append("data", 4);
+    appendLittleEndian(header, dataSize, 4);
+    device->write(header);
+}
@@ -0,0 +1,87 @@
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metajack/offlinejackcontext.h"
+#include "metajack/metajackcontext.h"
+#include "standardmidifile.h"
+#include <QString>
+
+/**
+  Renders a session (or macro) file without a Jack server and without
+  waiting for realtime.
+
+  The session is loaded into a MetaJackContext on top of an OfflineJackContext,
+  just like a macro is loaded in the GUI. The session's connections to the
+  context's first system_in MIDI port are fed from a Standard MIDI File, and all
+  audio sent to its system_out ports is written to a file, one channel per
+  port. The process cycles run back to back, i.e. as fast as the session's
+  clients allow.
+  */
+class OfflineRenderer
+{
+public:
+    enum OutputFormat {
+        WAVE,
+        RAW_FLOAT
+    };
+
+    OfflineRenderer(jack_nframes_t sampleRate = 44100, jack_nframes_t bufferSize = 1024, unsigned int threadCount = 1);
+    ~OfflineRenderer();
+
+    bool loadSession(const QString &fileName);
+    bool loadMidiFile(const QString &fileName);
+    /**
+      Renders the loaded session to the given file. WAVE files contain 32 bit
+      float samples, raw files contain interleaved little endian 32 bit floats
+      without any header.
+
+      @param length the duration to render in seconds. If it is not positive,
+        the length of the MIDI file is used
+      @param tail the duration in seconds to render in addition to the length,
+        e.g. to include release or reverb tails
+      @return true iff rendering succeeded, otherwise the error message is
+        available from getErrorString()
+      */
+    bool render(const QString &outputFileName, OutputFormat format, double length = 0, double tail = 0);
+
+    int getOutputChannelCount() const;
+    quint64 getRenderedFrameCount() const;
+    /**
+      @return the wall clock duration of the last call to render() in seconds
+      */
+    double getRenderTime() const;
+    QString getErrorString() const;
+private:
+    OfflineJackContext *offlineContext;
+    MetaJackContext *sessionContext;
+    StandardMidiFile midiFile;
+    bool hasMidiFile;
+    int outputChannelCount;
+    quint64 renderedFrameCount;
+    double renderTime;
+    QString errorString;
+
+    std::list<jack_port_t*> getWrapperPorts(const char *type, unsigned long flags);
+    void writeWaveHeader(QIODevice *device, quint64 frameCount);
+};
+
+#endif // OFFLINERENDERER_H
@@ -73,10 +73,39 @@ void Oscillator::processAudio(const double *inputs, double *outputs, jack_nframe
         phase2 -= 1;
     }
     // compute the oscillator output:
-    outputs[0] = getParameter(1).value * valueAtPhase(phase);
+    ParameterSmoother &gainSmoother = getParameterSmoother(1);
+    double gain = (gainSmoother.isSmoothing() ? gainSmoother.next() : getParameter(1).value);
+    outputs[0] = gain * valueAtPhase(phase);
     phase = phase2;
 }
 
+void Oscillator::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    const jack_default_audio_sample_t *pitchModulationInput = inputs[0];
+    jack_default_audio_sample_t *output = outputs[0];
+    double gain = getParameter(1).value;
+    // the gain might be ramping towards a new value:
+    ParameterSmoother &gainSmoother = getParameterSmoother(1);
+    // parameters only change between blocks, so the frequency has to be recomputed here only once:
+    computeNormalizedFrequency();
+    for (jack_nframes_t i = start; i < end; i++) {
+        // consider frequency modulation input only if it changed:
+        if (pitchModulationInput[i] != pitchModulation) {
+            pitchModulation = pitchModulationInput[i];
+            computeNormalizedFrequency();
+        }
+        // compute the oscillator output:
+        if (gainSmoother.isSmoothing()) {
+            gain = gainSmoother.next();
+        }
+        output[i] = gain * valueAtPhase(phase);
+        phase += normalizedFrequency;
+        if (phase >= 1) {
+            phase -= 1;
+        }
+    }
+}
+
 double Oscillator::getNormalizedFrequency() const
 {
     return normalizedFrequency;
@@ -87,13 +116,23 @@ double Oscillator::valueAtPhase(double phase)
     return sin(phase * 2 * M_PI);
 }
 
+double Oscillator::computeExp2(double x)
+{
+    // split x into the nearest integer and a fraction in [-0.5, 0.5]:
+    double integer = floor(x + 0.5);
+    double fraction = x - integer;
+    // 2^fraction = e^(fraction * ln 2), approximated by its Taylor polynomial of degree 6:
+    double power = 1.0 + fraction * (0.6931471805599453 + fraction * (0.2402265069591007 + fraction * (0.05550410866482158 + fraction * (0.009618129107628477 + fraction * (0.0013333558146428443 + fraction * 0.00015403530393381608)))));
+    return ldexp(power, (int)integer);
+}
+
 void Oscillator::computeNormalizedFrequency()
 {
     double octave = getParameter(2).value;
     double tune = getParameter(3).value;
     double pitchModulationIntensity = getParameter(4).value;
     double pitchBendIntensity = getParameter(5).value;
-    normalizedFrequency = frequency * pow(2.0, octave + pitchModulation * pitchModulationIntensity / 12.0 + tune / 1200.0 + pitchBend * pitchBendIntensity / 12.0) / getSampleRate();
+    normalizedFrequency = frequency * computeExp2(octave + pitchModulation * pitchModulationIntensity / 12.0 + tune / 1200.0 + pitchBend * pitchBendIntensity / 12.0) / getSampleRate();
     if (normalizedFrequency < 0.0) {
         normalizedFrequency = 0;
     } else if (normalizedFrequency > 0.5) {
@@ -37,6 +37,7 @@ public:
     virtual void processPitchBend(int inputIndex, unsigned char channel, unsigned int value, jack_nframes_t time);
     // reimplemented from AudioProcessor:
     virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
 
 protected:
     /**
@@ -50,6 +51,12 @@ protected:
     double getNormalizedFrequency() const;
     virtual double valueAtPhase(double phase);
 
+    /**
+      Approximates 2 to the power of x, with a relative error below 2e-7
+      (i.e., less than 0.001 cents when used for pitch computations).
+      */
+    static double computeExp2(double x);
+
 private:
     // derived member variables:
     double phase, frequency, normalizedFrequency, pitchBend, pitchModulation;
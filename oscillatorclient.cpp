@@ -27,6 +27,8 @@ OscillatorClient::OscillatorClient(const QString &clientName, Oscillator *proces
     processOscillator(processOscillator_),
     guiOscillator(guiOscillator_)
 {
+    // avoid zipper noise when the gain is changed:
+    setParameterSmoothing(1, ParameterSmoother::LINEAR_SMOOTHING, 0.005);
 }
 
 OscillatorClient::~OscillatorClient()
@@ -0,0 +1,103 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "parameterautomation.h"
+#include <algorithm>
+
+ParameterAutomation::PlaybackEvent::PlaybackEvent(const ParameterAutomation &automation_) :
+    automation(new ParameterAutomation(automation_))
+{
+}
+
+ParameterAutomation::PlaybackEvent::~PlaybackEvent()
+{
+    delete automation;
+}
+
+void ParameterAutomation::PlaybackEvent::swap(ParameterAutomation *&automation_) const
+{
+    std::swap(automation, automation_);
+}
+
+ParameterAutomation::ParameterAutomation()
+{
+}
+
+void ParameterAutomation::clear()
+{
+    points.clear();
+}
+
+void ParameterAutomation::addPoint(jack_nframes_t time, int index, double value, double min, double max)
+{
+    Point point;
+    point.time = time;
+    point.index = index;
+    point.value = value;
+    point.min = min;
+    point.max = max;
+    // points are usually added in time order, so search for the insertion position from the end:
+    int position = points.size();
+    for (; (position > 0) && (points[position - 1].time > time); position--);
+    points.insert(position, point);
+}
+
+int ParameterAutomation::getNrOfPoints() const
+{
+    return points.size();
+}
+
+const ParameterAutomation::Point & ParameterAutomation::getPoint(int index) const
+{
+    Q_ASSERT(index < points.size());
+    return points[index];
+}
+
+jack_nframes_t ParameterAutomation::getDuration() const
+{
+    return points.isEmpty() ? 0 : points.last().time;
+}
+
+void ParameterAutomation::save(QDataStream &stream) const
+{
+    stream << points.size();
+    for (int i = 0; i < points.size(); i++) {
+        const Point &point = points[i];
+        stream << point.time;
+        stream << point.index;
+        stream << point.value;
+        stream << point.min;
+        stream << point.max;
+    }
+}
+
+void ParameterAutomation::load(QDataStream &stream)
+{
+    int size;
+    stream >> size;
+    points.resize(size);
+    for (int i = 0; i < size; i++) {
+        Point &point = points[i];
+        stream >> point.time;
+        stream >> point.index;
+        stream >> point.value;
+        stream >> point.min;
+        stream >> point.max;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef PARAMETERAUTOMATION_H
+#define PARAMETERAUTOMATION_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jackringbuffer.h"
+#include <jack/types.h>
+#include <QDataStream>
+#include <QVector>
+
+/**
+  An automation lane, i.e. a sequence of timestamped parameter changes
+  which can be recorded from a ParameterClient and played back into it.
+
+  Times are given in frames relative to the beginning of the lane. The
+  points are kept in time order, points with the same time stay in the
+  order in which they were added.
+  */
+class ParameterAutomation
+{
+public:
+    struct Point {
+        jack_nframes_t time;
+        int index;
+        double value, min, max;
+    };
+
+    /**
+      Hands a copy of an automation lane over to the process thread.
+      The process thread swaps it with the lane it played back so far,
+      which is then deleted together with the event in the GUI thread.
+      */
+    class PlaybackEvent : public RingBufferEvent
+    {
+    public:
+        PlaybackEvent(const ParameterAutomation &automation);
+        virtual ~PlaybackEvent();
+        void swap(ParameterAutomation *&automation) const;
+    private:
+        mutable ParameterAutomation *automation;
+    };
+
+    ParameterAutomation();
+
+    void clear();
+    void addPoint(jack_nframes_t time, int index, double value, double min, double max);
+    int getNrOfPoints() const;
+    const Point & getPoint(int index) const;
+    /**
+      @return the time of the last point, or zero if there are no points
+      */
+    jack_nframes_t getDuration() const;
+
+    void save(QDataStream &stream) const;
+    void load(QDataStream &stream);
+private:
+    QVector<Point> points;
+};
+
+#endif // PARAMETERAUTOMATION_H
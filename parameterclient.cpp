@@ -21,16 +21,25 @@
 #include "graphicscontinuouscontrolitem.h"
 #include <QPen>
 #include <QBrush>
+#include <QTimerEvent>
+#include <QGraphicsSceneMouseEvent>
 
 ParameterClient::ParameterClient(const QString &clientName, AudioProcessor *audioProcessor, MidiProcessor *midiProcessor, EventProcessor *eventProcessor, ParameterProcessor *processParameterProcessor_, ParameterProcessor *guiParameterProcessor_, size_t ringBufferSize) :
     EventProcessorClient(clientName, audioProcessor, midiProcessor, eventProcessor, ringBufferSize),
     processParameterProcessor(processParameterProcessor_),
     guiParameterProcessor(guiParameterProcessor_),
-    ringBufferFromProcessToGui(ringBufferSize),
-    ringBufferFromGuiToProcess(ringBufferSize),
-    thread(new ParameterThread(this, &ringBufferFromProcessToGui, &ringBufferFromGuiToProcess))
+    pollingTimerId(0),
+    recordingAutomation(false),
+    recordingStartTime(0),
+    playedAutomation(new ParameterAutomation()),
+    playedAutomationPosition(0),
+    playbackStartTime(0)
 {
-    QObject::connect(thread, SIGNAL(changedParameterValue(int,double,double,double)), this, SLOT(onChangedParameterValue(int,double,double,double)));
+}
+
+ParameterClient::~ParameterClient()
+{
+    delete playedAutomation;
 }
 
 void ParameterClient::saveState(QDataStream &stream)
@@ -44,6 +53,7 @@ void ParameterClient::saveState(QDataStream &stream)
         stream << parameter.max;
         stream << parameter.resolution;
     }
+    automation.save(stream);
 }
 
 void ParameterClient::loadState(QDataStream &stream)
@@ -58,6 +68,7 @@ void ParameterClient::loadState(QDataStream &stream)
         stream >> parameter.resolution;
     }
     *processParameterProcessor = *guiParameterProcessor;
+    automation.load(stream);
 }
 
 int ParameterClient::getNrOfParameters() const
@@ -75,20 +86,75 @@ QGraphicsItem * ParameterClient::createGraphicsItem()
     return new ParameterGraphicsItem(this);
 }
 
+void ParameterClient::setParameterSmoothing(int index, ParameterSmoother::Type type, double duration)
+{
+    Smoothing smoothing;
+    smoothing.index = index;
+    smoothing.type = type;
+    smoothing.duration = duration;
+    for (int i = 0; i < smoothings.size(); i++) {
+        if (smoothings[i].index == index) {
+            smoothings[i] = smoothing;
+            return;
+        }
+    }
+    smoothings.append(smoothing);
+}
+
+bool ParameterClient::startRecordingAutomation()
+{
+    if (!isActive()) {
+        return false;
+    }
+    automation.clear();
+    recordingAutomation = true;
+    recordingStartTime = getEstimatedCurrentTime();
+    // the lane begins with the current state of all parameters:
+    for (int i = 0; i < guiParameterProcessor->getNrOfParameters(); i++) {
+        const ParameterProcessor::Parameter &parameter = guiParameterProcessor->getParameter(i);
+        automation.addPoint(0, i, parameter.value, parameter.min, parameter.max);
+    }
+    return true;
+}
+
+void ParameterClient::stopRecordingAutomation()
+{
+    recordingAutomation = false;
+}
+
+bool ParameterClient::isRecordingAutomation() const
+{
+    return recordingAutomation;
+}
+
+const ParameterAutomation & ParameterClient::getAutomation() const
+{
+    return automation;
+}
+
+void ParameterClient::setAutomation(const ParameterAutomation &automation)
+{
+    this->automation = automation;
+}
+
+bool ParameterClient::playAutomation()
+{
+    return postEvent(new ParameterAutomation::PlaybackEvent(automation));
+}
+
+bool ParameterClient::stopAutomation()
+{
+    // an empty lane replaces the one being played back:
+    return postEvent(new ParameterAutomation::PlaybackEvent(ParameterAutomation()));
+}
+
 void ParameterClient::changeParameterValue(int index, double value)
 {
     Q_ASSERT(index < guiParameterProcessor->getNrOfParameters());
     const ParameterProcessor::Parameter &parameter = guiParameterProcessor->getParameter(index);
     if (guiParameterProcessor->setParameterValue(index, value, parameter.min, parameter.max, 0)) {
         changedParameterValue(index, parameter.value, parameter.min, parameter.max);
-        ParameterChange change;
-        change.id = index;
-        change.value = parameter.value;
-        change.min = parameter.min;
-        change.max = parameter.max;
-        change.time = getEstimatedCurrentTime();
-        // send the change to the process thread:
-        ringBufferFromGuiToProcess.write(change);
+        sendToProcess(index);
     }
 }
 
@@ -98,14 +164,7 @@ void ParameterClient::changeParameterValue(int index, double value, double min,
     if (guiParameterProcessor->setParameterValue(index, value, min, max, 0)) {
         const ParameterProcessor::Parameter &parameter = guiParameterProcessor->getParameter(index);
         changedParameterValue(index, parameter.value, parameter.min, parameter.max);
-        ParameterChange change;
-        change.id = index;
-        change.value = parameter.value;
-        change.min = parameter.min;
-        change.max = parameter.max;
-        change.time = getEstimatedCurrentTime();
-        // send the change to the process thread:
-        ringBufferFromGuiToProcess.write(change);
+        sendToProcess(index);
     }
 }
 
@@ -115,26 +174,42 @@ void ParameterClient::changeParameterBounds(int index, double min, double max)
     const ParameterProcessor::Parameter &parameter = guiParameterProcessor->getParameter(index);
     if (guiParameterProcessor->setParameterValue(index, parameter.value, min, max, 0)) {
         changedParameterValue(index, parameter.value, parameter.min, parameter.max);
-        ParameterChange change;
-        change.id = index;
-        change.value = parameter.value;
-        change.min = parameter.min;
-        change.max = parameter.max;
-        change.time = getEstimatedCurrentTime();
-        // send the change to the process thread:
-        ringBufferFromGuiToProcess.write(change);
+        sendToProcess(index);
     }
 }
 
 bool ParameterClient::init()
 {
-    thread->start();
+    int nrOfParameters = guiParameterProcessor->getNrOfParameters();
+    snapshotFromGuiToProcess.resize(nrOfParameters);
+    snapshotFromProcessToGui.resize(nrOfParameters);
+    // take over the changes done in the GUI thread while the client was not active:
+    for (int i = 0; i < nrOfParameters; i++) {
+        const ParameterProcessor::Parameter &parameter = guiParameterProcessor->getParameter(i);
+        processParameterProcessor->setParameterValue(i, parameter.value, parameter.min, parameter.max, 0);
+    }
+    processParameterProcessor->resetParameterChanged();
+    // set up the smoothing for the current sample rate, without ramping to the values just taken over:
+    for (int i = 0; i < smoothings.size(); i++) {
+        const Smoothing &smoothing = smoothings[i];
+        processParameterProcessor->setParameterSmoothing(smoothing.index, smoothing.type, smoothing.duration * getSampleRate());
+    }
+    for (int i = 0; i < nrOfParameters; i++) {
+        processParameterProcessor->getParameterSmoother(i).reset(processParameterProcessor->getParameter(i).value);
+    }
+    pollingTimerId = startTimer(POLLING_INTERVAL);
     return EventProcessorClient::init();
 }
 
 void ParameterClient::deinit()
 {
-    thread->stop();
+    if (pollingTimerId) {
+        killTimer(pollingTimerId);
+        pollingTimerId = 0;
+    }
+    // get the last changes from the process thread:
+    receiveFromProcess();
+    recordingAutomation = false;
     EventProcessorClient::deinit();
 }
 
@@ -153,38 +228,56 @@ bool ParameterClient::process(jack_nframes_t nframes)
 bool ParameterClient::processParameters(jack_nframes_t start, jack_nframes_t end, jack_nframes_t nframes)
 {
     Q_ASSERT(processParameterProcessor);
+    // take over the values changed in the GUI thread since the last process cycle:
+    if (snapshotFromGuiToProcess.read()) {
+        for (int i = snapshotFromGuiToProcess.getNextChanged(0); i >= 0; i = snapshotFromGuiToProcess.getNextChanged(i + 1)) {
+            const ParameterSnapshot::Value &value = snapshotFromGuiToProcess.getValue(i);
+            processParameterProcessor->setParameterValue(i, value.value, value.min, value.max, start);
+        }
+    }
+    // play back the automation lane, applying each point at its frame:
     jack_nframes_t lastFrameTime = getLastFrameTime();
-    for (jack_nframes_t currentFrame = start; currentFrame < end; ) {
-        // get the next parameter change from the ring buffer, if there is any:
-        if (ringBufferFromGuiToProcess.readSpace()) {
-            ParameterChange change = ringBufferFromGuiToProcess.peek();
-            Q_ASSERT(change.id < processParameterProcessor->getNrOfParameters());
-            // adjust time relative to the beginning of this frame:
-            if (change.time + nframes < lastFrameTime) {
-                // if time is too early, this is in the buffer for too long, adjust time accordingly:
-                change.time = 0;
-            } else {
-                change.time = change.time + nframes - lastFrameTime;
-            }
-            if (change.time < end) {
-                // process everything up to the event's time stamp:
-                processEvents(currentFrame, change.time, nframes);
-                currentFrame = change.time;
-                // process the parameter change:
-                ringBufferFromGuiToProcess.readAdvance(1);
-                processParameterProcessor->setParameterValue(change.id, change.value, change.min, change.max, change.time);
-            } else {
-                processEvents(currentFrame, end, nframes);
-                currentFrame = end;
+    jack_nframes_t currentFrame = start;
+    for (; playedAutomationPosition < playedAutomation->getNrOfPoints(); ) {
+        ParameterAutomation::Point point = playedAutomation->getPoint(playedAutomationPosition);
+        // the point's frame relative to this cycle (points which are due already are applied right away):
+        qint32 frame = (qint32)(playbackStartTime + point.time - lastFrameTime);
+        if (frame >= (qint32)end) {
+            break;
+        }
+        if (frame > (qint32)currentFrame) {
+            // process everything up to the point's frame:
+            ParameterAutomation *automation = playedAutomation;
+            processEvents(currentFrame, frame, nframes);
+            currentFrame = frame;
+            if (playedAutomation != automation) {
+                // another lane has been swapped in meanwhile, continue with that one:
+                continue;
             }
-        } else {
-            processEvents(currentFrame, end, nframes);
-            currentFrame = end;
         }
+        // ignore points of parameters this client does not have (e.g. from another client's lane):
+        if (point.index < processParameterProcessor->getNrOfParameters()) {
+            processParameterProcessor->setParameterValue(point.index, point.value, point.min, point.max, currentFrame);
+        }
+        playedAutomationPosition++;
     }
+    processEvents(currentFrame, end, nframes);
     return true;
 }
 
+bool ParameterClient::processEvent(const RingBufferEvent *event, jack_nframes_t time)
+{
+    if (const ParameterAutomation::PlaybackEvent *event_ = dynamic_cast<const ParameterAutomation::PlaybackEvent*>(event)) {
+        // the previous lane is deleted with the event:
+        event_->swap(playedAutomation);
+        playedAutomationPosition = 0;
+        playbackStartTime = getLastFrameTime() + time;
+        return true;
+    } else {
+        return EventProcessorClient::processEvent(event, time);
+    }
+}
+
 void ParameterClient::synchronizeChangedParametersWithGui()
 {
     /*
@@ -192,21 +285,25 @@ void ParameterClient::synchronizeChangedParametersWithGui()
       could become out of sync through parameter changes which are sent both ways
       approximately at the same time.
       */
-    for (int i = 0; i < processParameterProcessor->getNrOfParameters(); i++) {
-        if (processParameterProcessor->hasParameterChanged(i)) {
-            const ParameterProcessor::Parameter &parameter = processParameterProcessor->getParameter(i);
-            ParameterChange change;
-            change.id = i;
-            change.value = parameter.value;
-            change.min = parameter.min;
-            change.max = parameter.max;
-            change.time = 0;
-            ringBufferFromProcessToGui.write(change);
+    if (processParameterProcessor->hasAnyParameterChanged()) {
+        for (int i = 0; i < processParameterProcessor->getNrOfParameters(); i++) {
+            if (processParameterProcessor->hasParameterChanged(i)) {
+                const ParameterProcessor::Parameter &parameter = processParameterProcessor->getParameter(i);
+                snapshotFromProcessToGui.write(i, parameter.value, parameter.min, parameter.max);
+            }
         }
+        snapshotFromProcessToGui.publish();
+        processParameterProcessor->resetParameterChanged();
+    }
+}
+
+void ParameterClient::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == pollingTimerId) {
+        receiveFromProcess();
+    } else {
+        EventProcessorClient::timerEvent(event);
     }
-    processParameterProcessor->resetParameterChanged();
-    // wake the associated thread:
-    thread->wake();
 }
 
 void ParameterClient::onChangedParameterValue(int index, double value, double min, double max)
@@ -217,18 +314,28 @@ void ParameterClient::onChangedParameterValue(int index, double value, double mi
     }
 }
 
-ParameterThread::ParameterThread(ParameterClient *client, JackRingBuffer<ParameterClient::ParameterChange> *ringBufferFromProcessToGui_, JackRingBuffer<ParameterClient::ParameterChange> *ringBufferFromGuiToProcess_) :
-    JackThread(client, 0),
-    ringBufferFromProcessToGui(ringBufferFromProcessToGui_),
-    ringBufferFromGuiToProcess(ringBufferFromGuiToProcess_)
-{}
+void ParameterClient::sendToProcess(int index)
+{
+    // the snapshot only has room for the parameters while the client is active, init() takes over all other changes:
+    if (index < snapshotFromGuiToProcess.getNrOfParameters()) {
+        const ParameterProcessor::Parameter &parameter = guiParameterProcessor->getParameter(index);
+        snapshotFromGuiToProcess.write(index, parameter.value, parameter.min, parameter.max);
+        snapshotFromGuiToProcess.publish();
+        // the process thread only reads the snapshot while the client is processed:
+        wake();
+        if (recordingAutomation) {
+            automation.addPoint(getEstimatedCurrentTime() - recordingStartTime, index, parameter.value, parameter.min, parameter.max);
+        }
+    }
+}
 
-void ParameterThread::processDeferred()
+void ParameterClient::receiveFromProcess()
 {
-    // read from the ring buffer and trigger the corresponding signals:
-    for (; ringBufferFromProcessToGui->readSpace(); ) {
-        ParameterClient::ParameterChange change = ringBufferFromProcessToGui->read();
-        changedParameterValue(change.id, change.value, change.min, change.max);
+    if (snapshotFromProcessToGui.read()) {
+        for (int i = snapshotFromProcessToGui.getNextChanged(0); i >= 0; i = snapshotFromProcessToGui.getNextChanged(i + 1)) {
+            const ParameterSnapshot::Value &value = snapshotFromProcessToGui.getValue(i);
+            onChangedParameterValue(i, value.value, value.min, value.max);
+        }
     }
 }
 
@@ -259,6 +366,12 @@ ParameterGraphicsItem::ParameterGraphicsItem(ParameterClient *client_, QGraphics
         }
     }
     setRect(rectControls.adjusted(-padding, -padding, padding, padding));
+
+    // create the context menu for recording and playing back the automation lane:
+    startRecordingAction = contextMenu.addAction(tr("Record automation"), this, SLOT(onStartRecordingAutomation()));
+    stopRecordingAction = contextMenu.addAction(tr("Stop recording"), this, SLOT(onStopRecordingAutomation()));
+    playAction = contextMenu.addAction(tr("Play automation"), this, SLOT(onPlayAutomation()));
+    contextMenu.addAction(tr("Stop automation"), this, SLOT(onStopAutomation()));
 }
 
 void ParameterGraphicsItem::focusInEvent(QFocusEvent *)
@@ -271,6 +384,27 @@ void ParameterGraphicsItem::focusOutEvent(QFocusEvent *)
     setZValue(0);
 }
 
+void ParameterGraphicsItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    if (event->button() == Qt::RightButton) {
+        event->accept();
+    } else {
+        QGraphicsRectItem::mousePressEvent(event);
+    }
+}
+
+void ParameterGraphicsItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    if (event->button() == Qt::RightButton) {
+        // only offer what is possible in the client's current state:
+        startRecordingAction->setVisible(!client->isRecordingAutomation());
+        startRecordingAction->setEnabled(client->isActive());
+        stopRecordingAction->setVisible(client->isRecordingAutomation());
+        playAction->setEnabled(!client->isRecordingAutomation() && client->getAutomation().getNrOfPoints());
+        contextMenu.exec(event->screenPos());
+    }
+}
+
 void ParameterGraphicsItem::onGuiChangedParameterValue(double value)
 {
     // determine the parameter id and the corresponding control by the sender:
@@ -290,3 +424,23 @@ void ParameterGraphicsItem::onClientChangedParameterValue(int index, double valu
         controls[index]->setValue(value, false);
     }
 }
+
+void ParameterGraphicsItem::onStartRecordingAutomation()
+{
+    client->startRecordingAutomation();
+}
+
+void ParameterGraphicsItem::onStopRecordingAutomation()
+{
+    client->stopRecordingAutomation();
+}
+
+void ParameterGraphicsItem::onPlayAutomation()
+{
+    client->playAutomation();
+}
+
+void ParameterGraphicsItem::onStopAutomation()
+{
+    client->stopAutomation();
+}
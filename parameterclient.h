@@ -22,10 +22,10 @@
 
 #include "eventprocessorclient.h"
 #include "parameterprocessor.h"
-#include "jackthread.h"
+#include "parametersnapshot.h"
+#include "parameterautomation.h"
 #include <QGraphicsRectItem>
-
-class ParameterThread;
+#include <QMenu>
 
 /**
   Using this class:
@@ -41,8 +41,10 @@ class ParameterThread;
   - if you want to get the current value of a parameter from the GUI call getIntParameter() or getDoubleParameter()
 
     Internally this class keeps two sets of all registered parameters. One set is used for access from the process thread,
-    the other one is being accessed from the GUI thread. Both sets are kept in sync via lock-free ringbuffers and the
-    associated ParameterThread and its signals.
+    the other one is being accessed from the GUI thread. Both sets are kept in sync via two ParameterSnapshot objects,
+    which only carry the parameters' values (names and string values stay with the GUI thread's set).
+    Changes from the GUI thread are taken over at the beginning of the next process cycle, changes from the
+    process thread are polled by the GUI thread with a timer.
 
     Parameter changed from within the process thread are synchronized once per process cycle.
     Due to the nature of the communication between GUI and process thread there are always short phases
@@ -58,16 +60,12 @@ class ParameterClient : public EventProcessorClient
 {
     Q_OBJECT
 public:
-    struct ParameterChange {
-        int id;
-        double value, min, max;
-        jack_nframes_t time;
-    };
-
     ParameterClient(const QString &clientName, AudioProcessor *audioProcessor, MidiProcessor *midiProcessor, EventProcessor *eventProcessor, ParameterProcessor *processParameterProcessor, ParameterProcessor *guiParameterProcessor, size_t ringBufferSize = 1024);
+    virtual ~ParameterClient();
 
     /**
-      These methods save/load the current values of the parameter set.
+      These methods save/load the current values of the parameter set
+      and the automation lane.
       */
     virtual void saveState(QDataStream &stream);
     /**
@@ -82,6 +80,33 @@ public:
       */
     const ParameterProcessor::Parameter & getParameter(int parameterId) const;
 
+    /**
+      Smooths the changes of a parameter in the process thread with the
+      given kind of ramp and duration (in seconds, see ParameterSmoother).
+      This takes effect when the client is activated the next time.
+      */
+    void setParameterSmoothing(int index, ParameterSmoother::Type type, double duration);
+
+    /**
+      Starts recording the parameter changes done through the slots below
+      into the client's automation lane, replacing its previous contents.
+      The lane begins with the current values of all parameters and is
+      saved with the client's state. This only works while the client is active.
+      */
+    bool startRecordingAutomation();
+    void stopRecordingAutomation();
+    bool isRecordingAutomation() const;
+    const ParameterAutomation & getAutomation() const;
+    void setAutomation(const ParameterAutomation &automation);
+    /**
+      Plays the client's automation lane back in the process thread, starting
+      about one process cycle after this call (like any posted event).
+      Each point is applied exactly at its frame. The lane played back so
+      far (if any) is stopped.
+      */
+    bool playAutomation();
+    bool stopAutomation();
+
     /**
       Reimplemented from JackClient.
 
@@ -115,14 +140,15 @@ protected:
     /**
       Reimplemented from MidiProcessorClient.
 
-      This starts the associated thread.
+      This brings the process thread's parameters up to date and starts
+      polling for changes from the process thread.
       You must call this in your reimplementation.
       */
     virtual bool init();
     /**
       Reimplemented from JackClient.
 
-      This stops the associated thread.
+      This stops polling for changes from the process thread.
       You must call this in your reimplementation.
       */
     virtual void deinit();
@@ -140,36 +166,54 @@ protected:
       */
     virtual bool process(jack_nframes_t nframes);
 
+    /**
+      Applies the parameter changes from the GUI thread and from the
+      automation lane being played back, and calls processEvents()
+      in between.
+      */
     virtual bool processParameters(jack_nframes_t start, jack_nframes_t end, jack_nframes_t nframes);
+    /**
+      Reimplemented from EventProcessorClient to start automation playback.
+      */
+    virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
 
     void synchronizeChangedParametersWithGui();
+
+    /**
+      Reimplemented from QObject to poll the changes from the process thread.
+      */
+    virtual void timerEvent(QTimerEvent *event);
 protected slots:
     /**
-      This slot is connected to the corresponding signal of ParameterThread
+      This slot is called for each parameter changed by the process thread,
       to keep the non-process thread set of parameters in sync with the process thread's.
       */
     virtual void onChangedParameterValue(int index, double value, double min, double max);
 private:
+    enum {
+        // how often the GUI thread looks for parameter changes from the process thread, in milliseconds:
+        POLLING_INTERVAL = 40
+    };
     ParameterProcessor *processParameterProcessor, *guiParameterProcessor;
-    JackRingBuffer<ParameterChange> ringBufferFromProcessToGui, ringBufferFromGuiToProcess;
-    ParameterThread *thread;
-};
-
-class ParameterThread : public JackThread {
-    Q_OBJECT
-public:
-    ParameterThread(ParameterClient *client, JackRingBuffer<ParameterClient::ParameterChange> *ringBufferFromProcessToGui, JackRingBuffer<ParameterClient::ParameterChange> *ringBufferFromGuiToProcess);
-signals:
-    /**
-      You do not need to connect to this signal. Connect
-      to ParameterClient's signal with the same name instead.
-      It will be triggered correspondingly.
-      */
-    void changedParameterValue(int index, double value, double min, double max);
-protected:
-    void processDeferred();
-private:
-    JackRingBuffer<ParameterClient::ParameterChange> *ringBufferFromProcessToGui, *ringBufferFromGuiToProcess;
+    ParameterSnapshot snapshotFromProcessToGui, snapshotFromGuiToProcess;
+    int pollingTimerId;
+    struct Smoothing {
+        int index;
+        ParameterSmoother::Type type;
+        double duration;
+    };
+    QVector<Smoothing> smoothings;
+    // the automation lane recorded in and saved from the GUI thread:
+    ParameterAutomation automation;
+    bool recordingAutomation;
+    jack_nframes_t recordingStartTime;
+    // the automation lane being played back in the process thread:
+    ParameterAutomation *playedAutomation;
+    int playedAutomationPosition;
+    jack_nframes_t playbackStartTime;
+
+    void sendToProcess(int index);
+    void receiveFromProcess();
 };
 
 class GraphicsContinuousControlItem;
@@ -181,11 +225,19 @@ public:
 protected:
     virtual void focusInEvent(QFocusEvent * event);
     virtual void focusOutEvent(QFocusEvent * event);
+    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
+    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
 private slots:
     void onGuiChangedParameterValue(double value);
     void onClientChangedParameterValue(int index, double value, double min, double max);
+    void onStartRecordingAutomation();
+    void onStopRecordingAutomation();
+    void onPlayAutomation();
+    void onStopAutomation();
 private:
     ParameterClient *client;
+    QMenu contextMenu;
+    QAction *startRecordingAction, *stopRecordingAction, *playAction;
     QMap<QObject*, int> mapSenderToId;
     QVector<GraphicsContinuousControlItem*> controls;
 };
@@ -27,6 +27,7 @@ ParameterProcessor::ParameterProcessor() :
 ParameterProcessor::ParameterProcessor(const ParameterProcessor &tocopy) :
     parameters(tocopy.parameters),
     parametersChanged(tocopy.parametersChanged),
+    smoothers(tocopy.smoothers),
     anyParameterChanged(tocopy.anyParameterChanged)
 {
 }
@@ -35,6 +36,7 @@ ParameterProcessor & ParameterProcessor::operator=(const ParameterProcessor &par
 {
     parameters = parameterProcessor.parameters;
     parametersChanged = parameterProcessor.parametersChanged;
+    smoothers = parameterProcessor.smoothers;
     anyParameterChanged = parameterProcessor.anyParameterChanged;
     return *this;
 }
@@ -49,6 +51,7 @@ int ParameterProcessor::registerParameter(const QString &name, double value, dou
     int id = parameters.size();
     parameters.append(Parameter(name, value, min, max, resolution, stringValues));
     parametersChanged.append(false);
+    smoothers.append(ParameterSmoother(value));
     return id;
 }
 
@@ -79,6 +82,7 @@ bool ParameterProcessor::setParameterValue(int index, double value, double min,
         parameters[index].max = max;
         parametersChanged[index] = true;
         anyParameterChanged = true;
+        smoothers[index].setTarget(parameters[index].value);
         return true;
     } else {
         return false;
@@ -91,6 +95,24 @@ bool ParameterProcessor::setParameterValue(int index, double value, unsigned int
     return setParameterValue(index, value, parameter.min, parameter.max, time);
 }
 
+void ParameterProcessor::setParameterSmoothing(int index, ParameterSmoother::Type type, double frames)
+{
+    Q_ASSERT(index < smoothers.size());
+    smoothers[index].setSmoothing(type, frames);
+}
+
+ParameterSmoother & ParameterProcessor::getParameterSmoother(int index)
+{
+    Q_ASSERT(index < smoothers.size());
+    return smoothers[index];
+}
+
+const ParameterSmoother & ParameterProcessor::getParameterSmoother(int index) const
+{
+    Q_ASSERT(index < smoothers.size());
+    return smoothers[index];
+}
+
 bool ParameterProcessor::hasParameterChanged(int index) const
 {
     Q_ASSERT(index < parametersChanged.size());
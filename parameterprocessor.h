@@ -20,6 +20,7 @@
     along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "parametersmoother.h"
 #include <QMap>
 #include <QString>
 #include <QVector>
@@ -50,7 +51,8 @@ public:
     virtual const Parameter & getParameter(int index) const;
     /**
       Changes the value, minimum and maximum of a parameter with given
-      index.
+      index. If smoothing is enabled for the parameter, its smoother
+      starts a ramp towards the new value.
 
       @return true, if value, min or max of the parameter with given index
         differ from their previous values, false otherwise
@@ -61,6 +63,20 @@ public:
       */
     bool setParameterValue(int index, double value, unsigned int time);
 
+    /**
+      Enables or disables smoothing of a parameter's value changes.
+      See ParameterSmoother for a description of the arguments.
+      */
+    void setParameterSmoothing(int index, ParameterSmoother::Type type, double frames);
+    /**
+      Gives access to the smoothed value of a parameter. Processing code
+      should call ParameterSmoother::next() or ParameterSmoother::advance()
+      on it while it processes frames and use the returned values instead
+      of the parameter's value, which is the ramp's target.
+      */
+    ParameterSmoother & getParameterSmoother(int index);
+    const ParameterSmoother & getParameterSmoother(int index) const;
+
     bool hasParameterChanged(int index) const;
     bool hasAnyParameterChanged() const;
     void resetParameterChanged();
@@ -68,6 +84,7 @@ public:
 private:
     QVector<Parameter> parameters;
     QVector<bool> parametersChanged;
+    QVector<ParameterSmoother> smoothers;
     bool anyParameterChanged;
 };
 
@@ -0,0 +1,95 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "parametersmoother.h"
+#include <cmath>
+
+ParameterSmoother::ParameterSmoother(double value_) :
+    type(NO_SMOOTHING),
+    frames(0),
+    coefficient(0),
+    value(value_),
+    target(value_),
+    increment(0),
+    remaining(0)
+{
+}
+
+void ParameterSmoother::setSmoothing(Type type_, double frames_)
+{
+    finish();
+    type = (frames_ > 0 ? type_ : NO_SMOOTHING);
+    frames = frames_;
+    coefficient = (type == EXPONENTIAL_SMOOTHING ? exp(-1.0 / frames) : 0);
+}
+
+ParameterSmoother::Type ParameterSmoother::getType() const
+{
+    return type;
+}
+
+double ParameterSmoother::getFrames() const
+{
+    return frames;
+}
+
+void ParameterSmoother::setTarget(double target_)
+{
+    target = target_;
+    if (type == LINEAR_SMOOTHING) {
+        remaining = (unsigned int)ceil(frames);
+        increment = (target - value) / remaining;
+    } else if (type == EXPONENTIAL_SMOOTHING) {
+        // the distance decays by 80 dB (a factor of 1e-4) after ln(1e4) time constants:
+        remaining = (unsigned int)ceil(frames * 9.210340371976184);
+    } else {
+        value = target;
+        remaining = 0;
+    }
+    if (value == target) {
+        remaining = 0;
+    }
+}
+
+double ParameterSmoother::getTarget() const
+{
+    return target;
+}
+
+void ParameterSmoother::finish()
+{
+    reset(target);
+}
+
+void ParameterSmoother::reset(double value_)
+{
+    value = target = value_;
+    remaining = 0;
+}
+
+double ParameterSmoother::advance(unsigned int frames_)
+{
+    if (frames_ >= remaining) {
+        finish();
+    } else if (frames_) {
+        remaining -= frames_;
+        value = (type == LINEAR_SMOOTHING ? value + frames_ * increment : target + (value - target) * pow(coefficient, (double)frames_));
+    }
+    return value;
+}
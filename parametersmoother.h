@@ -0,0 +1,104 @@
+#ifndef PARAMETERSMOOTHER_H
+#define PARAMETERSMOOTHER_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+  Smooths the changes of a single parameter value, such that a new value
+  is reached through a ramp instead of a step.
+
+  A linear ramp reaches the new value after the given number of frames.
+  An exponential ramp approaches it with the given time constant (in frames)
+  and jumps to it when the remaining distance has decayed by 80 dB.
+
+  Without smoothing (the default) every new value is taken over immediately.
+  */
+class ParameterSmoother
+{
+public:
+    enum Type {
+        NO_SMOOTHING,
+        LINEAR_SMOOTHING,
+        EXPONENTIAL_SMOOTHING
+    };
+
+    ParameterSmoother(double value = 0);
+
+    /**
+      Changes the kind of smoothing and its duration (the ramp length for
+      linear smoothing, the time constant for exponential smoothing).
+      A ramp in progress jumps to its target.
+      */
+    void setSmoothing(Type type, double frames);
+    Type getType() const;
+    double getFrames() const;
+
+    /**
+      Starts a ramp from the current value to the given one.
+      */
+    void setTarget(double target);
+    double getTarget() const;
+    /**
+      Ends the current ramp by jumping to its target.
+      */
+    void finish();
+    /**
+      Jumps to the given value without a ramp.
+      */
+    void reset(double value);
+
+    bool isSmoothing() const
+    {
+        return remaining;
+    }
+    double getValue() const
+    {
+        return value;
+    }
+    /**
+      Advances the ramp by one frame.
+
+      @return the value for the next frame
+      */
+    double next()
+    {
+        if (remaining) {
+            if (--remaining) {
+                value = (type == LINEAR_SMOOTHING ? value + increment : target + (value - target) * coefficient);
+            } else {
+                value = target;
+            }
+        }
+        return value;
+    }
+    /**
+      Advances the ramp by the given number of frames at once.
+
+      @return the value after these frames
+      */
+    double advance(unsigned int frames);
+private:
+    Type type;
+    double frames, coefficient;
+    double value, target, increment;
+    unsigned int remaining;
+};
+
+#endif // PARAMETERSMOOTHER_H
@@ -0,0 +1,122 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "parametersnapshot.h"
+
+ParameterSnapshot::ParameterSnapshot() :
+    writerIndex(0),
+    readerIndex(1),
+    middleIndex(2),
+    written(false)
+{
+}
+
+void ParameterSnapshot::resize(int nrOfParameters)
+{
+    Value zero = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++) {
+        buffers[i].values.fill(zero, nrOfParameters);
+        buffers[i].generations.fill(0, nrOfParameters);
+    }
+    writerBuffer.values.fill(zero, nrOfParameters);
+    writerBuffer.generations.fill(0, nrOfParameters);
+    readerGenerations.fill(0, nrOfParameters);
+    changedBits.fill(0, (nrOfParameters + 31) / 32);
+    writerIndex = 0;
+    readerIndex = 1;
+    middleIndex.fetchAndStoreOrdered(2);
+    written = false;
+}
+
+int ParameterSnapshot::getNrOfParameters() const
+{
+    return writerBuffer.values.size();
+}
+
+void ParameterSnapshot::write(int index, double value, double min, double max)
+{
+    Q_ASSERT(index < writerBuffer.values.size());
+    Value &written_ = writerBuffer.values[index];
+    written_.value = value;
+    written_.min = min;
+    written_.max = max;
+    writerBuffer.generations[index]++;
+    written = true;
+}
+
+void ParameterSnapshot::publish()
+{
+    if (written) {
+        // copy the writer's values to the back buffer (this never allocates, as all buffers have the same size):
+        Buffer &buffer = buffers[writerIndex];
+        Value *values = buffer.values.data();
+        quint32 *generations = buffer.generations.data();
+        for (int i = 0; i < writerBuffer.values.size(); i++) {
+            values[i] = writerBuffer.values[i];
+            generations[i] = writerBuffer.generations[i];
+        }
+        // exchange it with the middle buffer, which either is the one published last time or the reader's previous one:
+        writerIndex = middleIndex.fetchAndStoreOrdered(writerIndex | PUBLISHED) & BUFFER_MASK;
+        written = false;
+    }
+}
+
+bool ParameterSnapshot::read()
+{
+    if (!(middleIndex.fetchAndAddAcquire(0) & PUBLISHED)) {
+        return false;
+    }
+    readerIndex = middleIndex.fetchAndStoreOrdered(readerIndex) & BUFFER_MASK;
+    // compare the generations to find the changed values:
+    const quint32 *generations = buffers[readerIndex].generations.constData();
+    quint32 *readerGenerations_ = readerGenerations.data();
+    quint32 *changedBits_ = changedBits.data();
+    for (int i = 0; i < changedBits.size(); i++) {
+        changedBits_[i] = 0;
+    }
+    for (int i = 0; i < readerGenerations.size(); i++) {
+        if (generations[i] != readerGenerations_[i]) {
+            readerGenerations_[i] = generations[i];
+            changedBits_[i >> 5] |= (1u << (i & 31));
+        }
+    }
+    return true;
+}
+
+const ParameterSnapshot::Value & ParameterSnapshot::getValue(int index) const
+{
+    Q_ASSERT(index < buffers[readerIndex].values.size());
+    return buffers[readerIndex].values[index];
+}
+
+int ParameterSnapshot::getNextChanged(int index) const
+{
+    for (int word = index >> 5; word < changedBits.size(); word++) {
+        // ignore the bits before the given index in its word:
+        quint32 bits = changedBits[word];
+        if (word == (index >> 5)) {
+            bits &= ~0u << (index & 31);
+        }
+        if (bits) {
+            int bit = 0;
+            for (; !(bits & 1u); bits >>= 1, bit++);
+            return (word << 5) + bit;
+        }
+    }
+    return -1;
+}
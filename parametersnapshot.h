@@ -0,0 +1,104 @@
+#ifndef PARAMETERSNAPSHOT_H
+#define PARAMETERSNAPSHOT_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QAtomicInt>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+  Passes the values of a fixed number of parameters from one thread (the
+  writer) to another (the reader) without locks and without queueing every
+  single change.
+
+  The writer changes values in its own copy and publishes them as a whole
+  through a triple buffer, so the reader always gets the most recently
+  published values with one atomic exchange. Values that are changed
+  several times before the reader gets to them arrive only once, with their
+  last value.
+
+  Each value carries a generation counter, which the writer increments on
+  every change. The reader compares them with the generations it saw last
+  time, so it knows which parameters changed without the writer having to
+  know what the reader has already seen.
+  */
+class ParameterSnapshot
+{
+public:
+    struct Value {
+        double value, min, max;
+    };
+
+    ParameterSnapshot();
+
+    /**
+      Allocates room for the given number of parameters and forgets all
+      values. Only call this while neither thread uses the snapshot.
+      */
+    void resize(int nrOfParameters);
+    int getNrOfParameters() const;
+
+    // writer side:
+    /**
+      Changes a value in the writer's copy. The change is not visible
+      to the reader until publish() is called.
+      */
+    void write(int index, double value, double min, double max);
+    /**
+      Makes all values written so far visible to the reader.
+      */
+    void publish();
+
+    // reader side:
+    /**
+      Takes the most recently published values and determines which of
+      them changed since the last call.
+
+      @return true if new values have been published since the last call
+      */
+    bool read();
+    const Value & getValue(int index) const;
+    /**
+      @return the index of the first parameter at or after the given index
+        that changed in the last call to read(), or -1 if there is none
+      */
+    int getNextChanged(int index) const;
+private:
+    enum {
+        // set in the middle buffer index when the writer published a buffer the reader has not taken yet:
+        PUBLISHED = 4,
+        BUFFER_MASK = 3
+    };
+    struct Buffer {
+        QVector<Value> values;
+        QVector<quint32> generations;
+    };
+    Buffer buffers[3];
+    // the writer's own copy:
+    Buffer writerBuffer;
+    // the generations the reader saw last time, and which values changed:
+    QVector<quint32> readerGenerations, changedBits;
+    int writerIndex, readerIndex;
+    QAtomicInt middleIndex;
+    bool written;
+};
+
+#endif // PARAMETERSNAPSHOT_H
@@ -24,6 +24,8 @@
 #include <iostream>
 #include <QString>
 #include <complex>
+#include <limits>
+#include <algorithm>
 
 template<class T> class Polynomial : public std::vector<T>
 {
@@ -174,5 +176,71 @@ template<class T> QString polynomialToString(const Polynomial<std::complex<T> >
     return string;
 }
 
+/**
+  Computes the complex roots of the given polynomial with the
+  Durand-Kerner method and returns them. Leading coefficients that are
+  zero are ignored, i.e. the number of returned roots equals the actual
+  degree of the polynomial.
+
+  Multiple roots converge only linearly and are less accurate than simple
+  roots.
+  */
+template<class T> std::vector<std::complex<T> > findRoots(const Polynomial<std::complex<T> > &polynomial, int maximumIterations = 500)
+{
+    // determine the actual degree:
+    size_t degree = polynomial.degree();
+    for (; (degree > 0) && (polynomial.at(degree) == std::complex<T>(0)); degree--);
+    std::vector<std::complex<T> > roots(degree);
+    if (degree == 0) {
+        return roots;
+    }
+    // normalize the polynomial such that its leading coefficient is one:
+    std::vector<std::complex<T> > monic(degree + 1);
+    T bound = 0;
+    for (size_t i = 0; i <= degree; i++) {
+        monic[i] = polynomial.at(i) / polynomial.at(degree);
+        if ((i < degree) && (std::abs(monic[i]) > bound)) {
+            bound = std::abs(monic[i]);
+        }
+    }
+    // distribute the initial guesses inside the Cauchy bound of the roots:
+    std::complex<T> seed(0.4, 0.9), guess(1);
+    for (size_t i = 0; i < degree; i++, guess *= seed) {
+        roots[i] = guess * (bound + 1);
+    }
+    for (int iteration = 0; iteration < maximumIterations; iteration++) {
+        T maximumChange = 0;
+        for (size_t i = 0; i < degree; i++) {
+            // evaluate the monic polynomial with Horner's scheme:
+            std::complex<T> value = monic[degree];
+            for (size_t j = degree; j > 0; j--) {
+                value = value * roots[i] + monic[j - 1];
+            }
+            std::complex<T> denominator(1);
+            for (size_t j = 0; j < degree; j++) {
+                if (j != i) {
+                    denominator *= roots[i] - roots[j];
+                }
+            }
+            if (denominator == std::complex<T>(0)) {
+                // two guesses coincide, move this one a bit:
+                roots[i] += std::complex<T>(std::numeric_limits<T>::epsilon(), std::numeric_limits<T>::epsilon()) * (bound + 1);
+                maximumChange = bound + 1;
+                continue;
+            }
+            std::complex<T> change = value / denominator;
+            roots[i] -= change;
+            T relativeChange = std::abs(change) / std::max(std::abs(roots[i]), T(1));
+            if (relativeChange > maximumChange) {
+                maximumChange = relativeChange;
+            }
+        }
+        if (maximumChange <= std::numeric_limits<T>::epsilon() * 4) {
+            break;
+        }
+    }
+    return roots;
+}
+
 
 #endif // POLYNOMIAL_H
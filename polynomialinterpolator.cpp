@@ -92,6 +92,11 @@ void PolynomialInterpolator::smoothen()
     }
 }
 
+const QVector<Polynomial<double> > & PolynomialInterpolator::getPolynomials() const
+{
+    return polynomials;
+}
+
 double PolynomialInterpolator::interpolate(int j, double x)
 {
     if (j < 0) {
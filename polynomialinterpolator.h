@@ -47,6 +47,11 @@ public:
       and the end of the last segment match.
       */
     void smoothen();
+    /**
+      @return the polynomials of all segments, where the polynomial at index
+        i is valid between the control points i and i + 1
+      */
+    const QVector<Polynomial<double> > & getPolynomials() const;
 
     // Implemented from Interpolator:
     virtual double interpolate(int jlo, double x);
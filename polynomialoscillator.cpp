@@ -18,12 +18,21 @@
  */
 
 #include "polynomialoscillator.h"
+#include <cmath>
 
 PolynomialOscillator::PolynomialOscillator(int nrOfIntegrations_, const QStringList &additionalInputPortNames) :
     Oscillator(additionalInputPortNames),
     nrOfIntegrations(nrOfIntegrations_),
     integrals(nrOfIntegrations + 1),
-    previousIntegralValues(nrOfIntegrations, 0)
+    previousIntegralValues(nrOfIntegrations, 0),
+    previousPhases(nrOfIntegrations + 1, 0),
+    previousPhaseDifferences(nrOfIntegrations + 1, 1),
+    historyIndex(0),
+    coefficientsPerSegment(0),
+    segment(0),
+    constantPhaseDifference(1),
+    inverseConstantPhaseDifference(1),
+    constantPhaseDifferences(0)
 {
     QVector<double> xx, yy;
     xx.append(0);
@@ -31,11 +40,6 @@ PolynomialOscillator::PolynomialOscillator(int nrOfIntegrations_, const QStringL
     xx.append(1);
     yy.append(1);
     integrals[0] = PolynomialInterpolator(xx, yy);
-    for (int i = 0; i < nrOfIntegrations; i++) {
-        previousPhases.enqueue(0);
-        previousPhaseDifferences.enqueue(1);
-    }
-    previousPhases.enqueue(0);
     computeIntegrals();
 }
 
@@ -61,31 +65,63 @@ bool PolynomialOscillator::processEvent(const RingBufferEvent *event, jack_nfram
     }
 }
 
+bool PolynomialOscillator::processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t)
+{
+    if (integrals.first().processInterpolatorEvent(event)) {
+        computeIntegrals();
+        return true;
+    } else {
+        return false;
+    }
+}
+
 double PolynomialOscillator::valueAtPhase(double phase)
 {
-    double phaseDifference = phase - previousPhases.back();
+    double phaseDifference = phase - previousPhases[historyIndex];
     if (phaseDifference <= 0) {
         phaseDifference += 1;
     }
-    previousPhases.enqueue(phase);
-    previousPhases.dequeue();
-    previousPhaseDifferences.enqueue(phaseDifference);
-    previousPhaseDifferences.dequeue();
-    double value = differentiate(nrOfIntegrations);
+    // overwrite the oldest entries of the ring arrays:
+    if (++historyIndex == previousPhases.size()) {
+        historyIndex = 0;
+    }
+    previousPhases[historyIndex] = phase;
+    previousPhaseDifferences[historyIndex] = phaseDifference;
+    // count for how many phases the phase difference has been constant (up to rounding errors at phase wrap-around):
+    if (std::fabs(phaseDifference - constantPhaseDifference) <= 1e-12 * constantPhaseDifference) {
+        if (constantPhaseDifferences < nrOfIntegrations) {
+            constantPhaseDifferences++;
+        }
+    } else {
+        constantPhaseDifference = phaseDifference;
+        inverseConstantPhaseDifference = 1.0 / phaseDifference;
+        constantPhaseDifferences = 1;
+    }
+    if (constantPhaseDifferences < nrOfIntegrations) {
+        return differentiate(nrOfIntegrations);
+    }
+    // all phase differences in the window are equal, so the divided differences
+    // reduce to (value - previousValue) * i / (i * phaseDifference):
+    double value = evaluateTopIntegral(phase);
+    for (int i = 0; i < nrOfIntegrations; i++) {
+        double previousValue = previousIntegralValues[i];
+        previousIntegralValues[i] = value;
+        value = (value - previousValue) * inverseConstantPhaseDifference;
+    }
     return value;
 }
 
 double PolynomialOscillator::differentiate(int order)
 {
     // evaluate the top integral at the given phase:
-    double value = integrals.back().evaluate(previousPhases[order]);
+    double value = integrals.back().evaluate(getPreviousPhase(order));
     // differentiate "order" times:
     double phaseDifferencesSum = 0;
     double factor = 0;
     for (int i = 0; i < order; i++) {
         double previousValue = previousIntegralValues[i];
         previousIntegralValues[i] = value;
-        phaseDifferencesSum += previousPhaseDifferences[order - i - 1];
+        phaseDifferencesSum += getPreviousPhaseDifference(order - i - 1);
         factor++;
         value = (value - previousValue) * factor / phaseDifferencesSum;
     }
@@ -98,6 +134,37 @@ void PolynomialOscillator::changeControlPoints(const QVector<double> &xx, const
     computeIntegrals();
 }
 
+double PolynomialOscillator::getPreviousPhase(int index) const
+{
+    // index 0 is the oldest, index nrOfIntegrations the most recent phase:
+    int position = historyIndex + 1 + index;
+    return previousPhases[position > nrOfIntegrations ? position - nrOfIntegrations - 1 : position];
+}
+
+double PolynomialOscillator::getPreviousPhaseDifference(int index) const
+{
+    // index 0 is the oldest, index nrOfIntegrations - 1 the most recent phase difference:
+    int position = historyIndex + 2 + index;
+    return previousPhaseDifferences[position > nrOfIntegrations ? position - nrOfIntegrations - 1 : position];
+}
+
+double PolynomialOscillator::evaluateTopIntegral(double phase)
+{
+    int segments = segmentBounds.size() - 1;
+    // the phase usually moves forward, so start looking from the previous segment:
+    if ((segment >= segments) || (phase < segmentBounds[segment])) {
+        segment = 0;
+    }
+    for (; (segment < segments - 1) && (phase >= segmentBounds[segment + 1]); segment++);
+    // evaluate the segment's polynomial using Horner's scheme:
+    const double *segmentCoefficients = coefficients.constData() + segment * coefficientsPerSegment;
+    double value = segmentCoefficients[coefficientsPerSegment - 1];
+    for (int i = coefficientsPerSegment - 2; i >= 0; i--) {
+        value = value * phase + segmentCoefficients[i];
+    }
+    return value;
+}
+
 void PolynomialOscillator::computeIntegrals()
 {
     for (int i = 0; i < nrOfIntegrations; i++) {
@@ -106,7 +173,26 @@ void PolynomialOscillator::computeIntegrals()
         // smoothen the result (match start and end points):
         integrals[i + 1].smoothen();
     }
+    computeCoefficients();
     for (int i = 0; i < nrOfIntegrations; i++) {
         differentiate(i + 1);
     }
 }
+
+void PolynomialOscillator::computeCoefficients()
+{
+    const QVector<Polynomial<double> > &polynomials = integrals.back().getPolynomials();
+    segmentBounds = integrals.back().getX();
+    // all segments get the same number of coefficients, padded with zeros:
+    coefficientsPerSegment = 1;
+    for (int i = 0; i < polynomials.size(); i++) {
+        coefficientsPerSegment = qMax(coefficientsPerSegment, (int)polynomials[i].size());
+    }
+    coefficients.fill(0, polynomials.size() * coefficientsPerSegment);
+    for (int i = 0; i < polynomials.size(); i++) {
+        for (size_t j = 0; j < polynomials[i].size(); j++) {
+            coefficients[i * coefficientsPerSegment + j] = polynomials[i][j];
+        }
+    }
+    segment = 0;
+}
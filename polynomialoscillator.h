@@ -22,7 +22,6 @@
 
 #include "oscillator.h"
 #include "polynomialinterpolator.h"
-#include <QQueue>
 
 class PolynomialOscillator : public Oscillator, public EventProcessor
 {
@@ -34,6 +33,7 @@ public:
 
     // Reimplemented from EventProcessor:
     virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
+    virtual bool processInlineEvent(const RingBufferInlineEvent &event, jack_nframes_t time);
 protected:
     double valueAtPhase(double normalizedPhase);
     double differentiate(int order);
@@ -42,9 +42,33 @@ private:
     int nrOfIntegrations;
     QVector<PolynomialInterpolator> integrals;
     QVector<double> previousIntegralValues;
-    QQueue<double> previousPhases, previousPhaseDifferences;
+    /**
+      The last nrOfIntegrations + 1 phases and the last nrOfIntegrations
+      phase differences, kept in ring arrays. historyIndex points to the
+      most recent entry of both.
+      */
+    QVector<double> previousPhases, previousPhaseDifferences;
+    int historyIndex;
+    /**
+      The coefficients of the top integral's segment polynomials, stored
+      contiguously with coefficientsPerSegment entries per segment, and
+      the segment bounds. Rebuilt whenever the integrals change.
+      */
+    QVector<double> coefficients, segmentBounds;
+    int coefficientsPerSegment, segment;
+    /**
+      The most recent phase difference that stayed (almost) constant, its
+      inverse and for how many consecutive phases it has been constant
+      (at most nrOfIntegrations).
+      */
+    double constantPhaseDifference, inverseConstantPhaseDifference;
+    int constantPhaseDifferences;
 
+    double getPreviousPhase(int index) const;
+    double getPreviousPhaseDifference(int index) const;
+    double evaluateTopIntegral(double phase);
     void computeIntegrals();
+    void computeCoefficients();
 };
 
 #endif // INTEGRALOSCILLATOR_H
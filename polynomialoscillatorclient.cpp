@@ -78,22 +78,22 @@ QPointF PolynomialOscillatorClient::getControlPoint(int index)
 void PolynomialOscillatorClient::changeControlPoint(int index, double x, double y)
 {
     guiOscillator->getPolynomialInterpolator()->changeControlPoint(index, x, y);
-    Interpolator::ChangeControlPointEvent *event = new Interpolator::ChangeControlPointEvent(index, x, y);
-    postEvent(event);
+    Interpolator::ChangeControlPoint change = { index, x, y };
+    postEvent(RingBufferInlineEvent(change));
 }
 
 void PolynomialOscillatorClient::addControlPoint(double x, double y)
 {
     guiOscillator->getPolynomialInterpolator()->addControlPoint(x, y);
-    Interpolator::AddControlPointEvent *event = new Interpolator::AddControlPointEvent(x, y);
-    postEvent(event);
+    Interpolator::AddControlPoint add = { x, y };
+    postEvent(RingBufferInlineEvent(add));
 }
 
 void PolynomialOscillatorClient::deleteControlPoint(int index)
 {
     guiOscillator->getPolynomialInterpolator()->deleteControlPoint(index);
-    Interpolator::DeleteControlPointEvent *event = new Interpolator::DeleteControlPointEvent(index);
-    postEvent(event);
+    Interpolator::DeleteControlPoint deletion = { index };
+    postEvent(RingBufferInlineEvent(deletion));
 }
 
 QString PolynomialOscillatorClient::getControlPointName(int index) const
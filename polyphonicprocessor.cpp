@@ -0,0 +1,458 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "polyphonicprocessor.h"
+#include "oscillator.h"
+#include "iirmoogfilter.h"
+#include "envelope.h"
+
+PolyphonicProcessor::VoiceFactory::~VoiceFactory()
+{
+}
+
+PolyphonicProcessor::PolyphonicProcessor(VoiceFactory &voiceFactory, int nrOfVoices, VoiceStealing voiceStealing_) :
+    AudioProcessor(createInputPortNames(voiceFactory), QStringList("Audio out")),
+    MidiParameterProcessor(QStringList("Midi note in"), QStringList()),
+    voiceStealing(voiceStealing_),
+    stagesPerVoice(0),
+    noteCounter(0)
+{
+    Q_ASSERT(nrOfVoices > 0);
+    Voice idleVoice;
+    idleVoice.state = IDLE;
+    idleVoice.channel = 0;
+    idleVoice.noteNumber = 0;
+    idleVoice.age = 0;
+    idleVoice.level = 0;
+    idleVoice.silentFrames = 0;
+    voices.fill(idleVoice, nrOfVoices);
+    int maxInputs = getNrOfAudioInputs(), maxOutputs = 1;
+    for (int voice = 0; voice < nrOfVoices; voice++) {
+        QVector<Stage> voiceStages = voiceFactory.createVoice();
+        Q_ASSERT(voiceStages.size() > 0);
+        stagesPerVoice = voiceStages.size();
+        stages += voiceStages;
+        for (int stage = 0; stage < voiceStages.size(); stage++) {
+            maxInputs = qMax(maxInputs, voiceStages[stage].audioProcessor->getNrOfAudioInputs());
+            maxOutputs = qMax(maxOutputs, voiceStages[stage].audioProcessor->getNrOfAudioOutputs());
+        }
+    }
+    // register the parameters of the first voice's stages as our own:
+    for (int stage = 0; stage < stagesPerVoice; stage++) {
+        const Stage &voiceStage = getStage(0, stage);
+        if (voiceStage.parameterProcessor) {
+            // skip the MIDI controller mapping of MIDI parameter processors, we have our own:
+            int firstParameter = (dynamic_cast<MidiParameterProcessor*>(voiceStage.parameterProcessor) ? 1 : 0);
+            for (int index = firstParameter; index < voiceStage.parameterProcessor->getNrOfParameters(); index++) {
+                const Parameter &parameter = voiceStage.parameterProcessor->getParameter(index);
+                registerParameter(voiceStage.name + ": " + parameter.name, parameter.value, parameter.min, parameter.max, parameter.resolution, parameter.stringValues);
+                parameterStages.append(qMakePair(stage, index));
+            }
+        }
+    }
+    // zero, discard, two signal buffers and a factor buffer:
+    chunkBuffers.fill(0, 5 * CHUNK_SIZE);
+    stageInputs.resize(maxInputs);
+    stageOutputs.resize(maxOutputs);
+    frameInputs.resize(maxInputs);
+    frameOutputs.resize(maxOutputs);
+}
+
+PolyphonicProcessor::~PolyphonicProcessor()
+{
+    for (int i = 0; i < stages.size(); i++) {
+        delete stages[i].audioProcessor;
+    }
+}
+
+int PolyphonicProcessor::getNrOfVoices() const
+{
+    return voices.size();
+}
+
+int PolyphonicProcessor::getNrOfActiveVoices() const
+{
+    int activeVoices = 0;
+    for (int voice = 0; voice < voices.size(); voice++) {
+        if (voices[voice].state != IDLE) {
+            activeVoices++;
+        }
+    }
+    return activeVoices;
+}
+
+void PolyphonicProcessor::setVoiceStealing(VoiceStealing voiceStealing)
+{
+    this->voiceStealing = voiceStealing;
+}
+
+PolyphonicProcessor::VoiceStealing PolyphonicProcessor::getVoiceStealing() const
+{
+    return voiceStealing;
+}
+
+void PolyphonicProcessor::setSampleRate(double sampleRate)
+{
+    AudioProcessor::setSampleRate(sampleRate);
+    for (int i = 0; i < stages.size(); i++) {
+        stages[i].audioProcessor->setSampleRate(sampleRate);
+    }
+    // the stages might have adapted their parameters' bounds (e.g., to the Nyquist frequency):
+    for (int index = 1; index < getNrOfParameters(); index++) {
+        const QPair<int, int> &parameterStage = parameterStages[index - 1];
+        const Parameter &parameter = getStage(0, parameterStage.first).parameterProcessor->getParameter(parameterStage.second);
+        getParameter(index).min = parameter.min;
+        getParameter(index).max = parameter.max;
+    }
+}
+
+void PolyphonicProcessor::processAudio(const double *inputs, double *outputs, jack_nframes_t time)
+{
+    outputs[0] = 0;
+    for (int voice = 0; voice < voices.size(); voice++) {
+        if (voices[voice].state == IDLE) {
+            continue;
+        }
+        double signal = 0;
+        for (int stage = 0; stage < stagesPerVoice; stage++) {
+            Stage &voiceStage = getStage(voice, stage);
+            for (int input = 0; input < voiceStage.audioProcessor->getNrOfAudioInputs(); input++) {
+                frameInputs[input] = (stage == 0 ? inputs[input] : (input == 0 && !voiceStage.multiplies ? signal : 0));
+            }
+            voiceStage.audioProcessor->processAudio(frameInputs.data(), frameOutputs.data(), time);
+            signal = (voiceStage.multiplies ? signal * frameOutputs[0] : frameOutputs[0]);
+        }
+        outputs[0] += signal;
+        updateVoiceLevel(voice, qAbs(signal), 1);
+    }
+}
+
+void PolyphonicProcessor::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    jack_default_audio_sample_t *output = outputs[0];
+    for (jack_nframes_t i = start; i < end; i++) {
+        output[i] = 0;
+    }
+    // process the voices in chunks, such that the intermediate signals fit into the scratch buffers:
+    for (jack_nframes_t chunkStart = start; chunkStart < end; chunkStart += CHUNK_SIZE) {
+        jack_nframes_t length = qMin((jack_nframes_t)CHUNK_SIZE, end - chunkStart);
+        for (int voice = 0; voice < voices.size(); voice++) {
+            if (voices[voice].state != IDLE) {
+                processVoiceChunk(voice, inputs, chunkStart, length, output + chunkStart);
+            }
+        }
+    }
+}
+
+void PolyphonicProcessor::processNoteOn(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time)
+{
+    if (inputIndex != 1) {
+        return;
+    }
+    int voice = allocateVoice(channel, noteNumber, time);
+    for (int stage = 0; stage < stagesPerVoice; stage++) {
+        Stage &voiceStage = getStage(voice, stage);
+        if (voiceStage.midiProcessor) {
+            voiceStage.midiProcessor->processNoteOn(voiceStage.midiInputIndex, channel, noteNumber, velocity, time);
+        }
+    }
+    voices[voice].state = PLAYING;
+    voices[voice].channel = channel;
+    voices[voice].noteNumber = noteNumber;
+    voices[voice].age = noteCounter++;
+    voices[voice].silentFrames = 0;
+}
+
+void PolyphonicProcessor::processNoteOff(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time)
+{
+    if (inputIndex != 1) {
+        return;
+    }
+    int voice = findVoice(channel, noteNumber);
+    if ((voice >= 0) && (voices[voice].state == PLAYING)) {
+        for (int stage = 0; stage < stagesPerVoice; stage++) {
+            Stage &voiceStage = getStage(voice, stage);
+            if (voiceStage.midiProcessor) {
+                voiceStage.midiProcessor->processNoteOff(voiceStage.midiInputIndex, channel, noteNumber, velocity, time);
+            }
+        }
+        voices[voice].state = RELEASED;
+    }
+}
+
+void PolyphonicProcessor::processAfterTouch(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char pressure, jack_nframes_t time)
+{
+    if (inputIndex != 1) {
+        return;
+    }
+    int voice = findVoice(channel, noteNumber);
+    if (voice >= 0) {
+        for (int stage = 0; stage < stagesPerVoice; stage++) {
+            Stage &voiceStage = getStage(voice, stage);
+            if (voiceStage.midiProcessor) {
+                voiceStage.midiProcessor->processAfterTouch(voiceStage.midiInputIndex, channel, noteNumber, pressure, time);
+            }
+        }
+    }
+}
+
+void PolyphonicProcessor::processController(int inputIndex, unsigned char channel, unsigned char controller, unsigned char value, jack_nframes_t time)
+{
+    if (inputIndex != 1) {
+        // controllers at the MIDI control input change our parameters:
+        MidiParameterProcessor::processController(inputIndex, channel, controller, value, time);
+        return;
+    }
+    for (int i = 0; i < stages.size(); i++) {
+        if (stages[i].midiProcessor) {
+            stages[i].midiProcessor->processController(stages[i].midiInputIndex, channel, controller, value, time);
+        }
+    }
+}
+
+void PolyphonicProcessor::processPitchBend(int inputIndex, unsigned char channel, unsigned int value, jack_nframes_t time)
+{
+    if (inputIndex != 1) {
+        return;
+    }
+    // idle voices get this as well, such that they start with the current pitch bend:
+    for (int i = 0; i < stages.size(); i++) {
+        if (stages[i].midiProcessor) {
+            stages[i].midiProcessor->processPitchBend(stages[i].midiInputIndex, channel, value, time);
+        }
+    }
+}
+
+void PolyphonicProcessor::processChannelPressure(int inputIndex, unsigned char channel, unsigned char pressure, jack_nframes_t time)
+{
+    if (inputIndex != 1) {
+        return;
+    }
+    for (int i = 0; i < stages.size(); i++) {
+        if (stages[i].midiProcessor) {
+            stages[i].midiProcessor->processChannelPressure(stages[i].midiInputIndex, channel, pressure, time);
+        }
+    }
+}
+
+bool PolyphonicProcessor::setParameterValue(int index, double value, double min, double max, unsigned int time)
+{
+    if (MidiParameterProcessor::setParameterValue(index, value, min, max, time)) {
+        if (index >= 1) {
+            // pass the change on to the corresponding stage of each voice:
+            const QPair<int, int> &parameterStage = parameterStages[index - 1];
+            for (int voice = 0; voice < voices.size(); voice++) {
+                getStage(voice, parameterStage.first).parameterProcessor->setParameterValue(parameterStage.second, value, min, max, time);
+            }
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+int PolyphonicProcessor::findVoice(unsigned char channel, unsigned char noteNumber) const
+{
+    for (int voice = 0; voice < voices.size(); voice++) {
+        const Voice &candidate = voices[voice];
+        if ((candidate.state != IDLE) && (candidate.channel == channel) && (candidate.noteNumber == noteNumber)) {
+            return voice;
+        }
+    }
+    return -1;
+}
+
+int PolyphonicProcessor::allocateVoice(unsigned char channel, unsigned char noteNumber, jack_nframes_t time)
+{
+    // retrigger the voice which is already playing this note:
+    int voice = findVoice(channel, noteNumber);
+    if (voice >= 0) {
+        return voice;
+    }
+    for (voice = 0; voice < voices.size(); voice++) {
+        if (voices[voice].state == IDLE) {
+            return voice;
+        }
+    }
+    // all voices are busy, steal one (preferably one whose note has been released already):
+    int stolen = 0;
+    for (voice = 1; voice < voices.size(); voice++) {
+        const Voice &candidate = voices[voice];
+        const Voice &best = voices[stolen];
+        if (candidate.state != best.state) {
+            if (candidate.state == RELEASED) {
+                stolen = voice;
+            }
+        } else if (voiceStealing == STEAL_OLDEST) {
+            // compare the ages relative to the note counter to handle its wrap-around:
+            if (noteCounter - candidate.age > noteCounter - best.age) {
+                stolen = voice;
+            }
+        } else if (candidate.level < best.level) {
+            stolen = voice;
+        }
+    }
+    // end the stolen voice's note at the time of the new note, such that its stages do not get stuck notes:
+    if (voices[stolen].state == PLAYING) {
+        for (int stage = 0; stage < stagesPerVoice; stage++) {
+            Stage &voiceStage = getStage(stolen, stage);
+            if (voiceStage.midiProcessor) {
+                voiceStage.midiProcessor->processNoteOff(voiceStage.midiInputIndex, voices[stolen].channel, voices[stolen].noteNumber, 0, time);
+            }
+        }
+    }
+    return stolen;
+}
+
+void PolyphonicProcessor::processVoiceChunk(int voice, const jack_default_audio_sample_t * const *inputs, jack_nframes_t start, jack_nframes_t length, jack_default_audio_sample_t *output)
+{
+    jack_default_audio_sample_t *zero = chunkBuffers.data();
+    jack_default_audio_sample_t *discard = zero + CHUNK_SIZE;
+    jack_default_audio_sample_t *signal = discard + CHUNK_SIZE;
+    jack_default_audio_sample_t *nextSignal = signal + CHUNK_SIZE;
+    jack_default_audio_sample_t *factor = nextSignal + CHUNK_SIZE;
+    for (int stage = 0; stage < stagesPerVoice; stage++) {
+        Stage &voiceStage = getStage(voice, stage);
+        for (int inputIndex = 0; inputIndex < voiceStage.audioProcessor->getNrOfAudioInputs(); inputIndex++) {
+            stageInputs[inputIndex] = (stage == 0 ? inputs[inputIndex] + start : (inputIndex == 0 && !voiceStage.multiplies ? signal : zero));
+        }
+        for (int outputIndex = 0; outputIndex < voiceStage.audioProcessor->getNrOfAudioOutputs(); outputIndex++) {
+            stageOutputs[outputIndex] = (outputIndex > 0 ? discard : (voiceStage.multiplies ? factor : nextSignal));
+        }
+        voiceStage.audioProcessor->processAudio(stageInputs.data(), stageOutputs.data(), 0, length);
+        if (voiceStage.multiplies) {
+            for (jack_nframes_t i = 0; i < length; i++) {
+                signal[i] *= factor[i];
+            }
+        } else {
+            qSwap(signal, nextSignal);
+        }
+    }
+    float level = 0;
+    for (jack_nframes_t i = 0; i < length; i++) {
+        output[i] += signal[i];
+        level = qMax(level, qAbs(signal[i]));
+    }
+    updateVoiceLevel(voice, level, length);
+}
+
+void PolyphonicProcessor::updateVoiceLevel(int voice, float level, jack_nframes_t frames)
+{
+    Voice &voiceState = voices[voice];
+    voiceState.level = level;
+    if ((voiceState.state == RELEASED) && (level * SILENCE_LEVEL_INVERSE < 1)) {
+        voiceState.silentFrames += frames;
+        if (voiceState.silentFrames >= SILENCE_FRAMES) {
+            voiceState.state = IDLE;
+        }
+    } else {
+        voiceState.silentFrames = 0;
+    }
+}
+
+PolyphonicProcessor::Stage & PolyphonicProcessor::getStage(int voice, int stage)
+{
+    return stages[voice * stagesPerVoice + stage];
+}
+
+QStringList PolyphonicProcessor::createInputPortNames(VoiceFactory &voiceFactory)
+{
+    QVector<Stage> voiceStages = voiceFactory.createVoice();
+    QStringList inputPortNames = voiceStages.first().audioProcessor->getAudioInputPortNames();
+    for (int stage = 0; stage < voiceStages.size(); stage++) {
+        delete voiceStages[stage].audioProcessor;
+    }
+    return inputPortNames;
+}
+
+PolyphonicProcessorClient::PolyphonicProcessorClient(const QString &clientName, PolyphonicProcessor *processProcessor_, PolyphonicProcessor *guiProcessor_, size_t ringBufferSize) :
+    ParameterClient(clientName, processProcessor_, processProcessor_, 0, processProcessor_, guiProcessor_, ringBufferSize),
+    processProcessor(processProcessor_),
+    guiProcessor(guiProcessor_)
+{
+}
+
+PolyphonicProcessorClient::~PolyphonicProcessorClient()
+{
+    // calling close will stop the Jack client:
+    close();
+    // deleting the processors is now safe, as they are not used anymore (the Jack process thread is stopped):
+    delete processProcessor;
+    delete guiProcessor;
+}
+
+bool PolyphonicProcessorClient::init()
+{
+    if (ParameterClient::init()) {
+        // adjust the guiProcessor's samplerate (and thus its parameters' bounds) to that of the processProcessor:
+        guiProcessor->setSampleRate(processProcessor->getSampleRate());
+        return true;
+    } else {
+        return false;
+    }
+}
+
+/**
+  Creates voices consisting of an oscillator, a low-pass filter and an envelope.
+  */
+class SynthesizerVoiceFactory : public PolyphonicProcessor::VoiceFactory
+{
+public:
+    QVector<PolyphonicProcessor::Stage> createVoice()
+    {
+        Oscillator *oscillator = new Oscillator();
+        IirMoogFilter *filter = new IirMoogFilter(1);
+        Envelope *envelope = new Envelope();
+        PolyphonicProcessor::Stage oscillatorStage = {"Oscillator", oscillator, oscillator, oscillator, 1, false};
+        PolyphonicProcessor::Stage filterStage = {"Filter", filter, filter, filter, 1, false};
+        PolyphonicProcessor::Stage envelopeStage = {"Envelope", envelope, envelope, envelope, 0, true};
+        QVector<PolyphonicProcessor::Stage> stages;
+        stages.append(oscillatorStage);
+        stages.append(filterStage);
+        stages.append(envelopeStage);
+        return stages;
+    }
+};
+
+class PolyphonicProcessorClientFactory : public JackClientFactory
+{
+public:
+    PolyphonicProcessorClientFactory()
+    {
+        JackClientSerializer::getInstance()->registerFactory(this);
+    }
+    QString getName()
+    {
+        return "Polyphonic synthesizer (16 voices)";
+    }
+    JackClient * createClient(const QString &clientName)
+    {
+        SynthesizerVoiceFactory voiceFactory;
+        // the GUI thread only needs the parameters, which are those of a single voice:
+        return new PolyphonicProcessorClient(clientName, new PolyphonicProcessor(voiceFactory, 16), new PolyphonicProcessor(voiceFactory, 1));
+    }
+    static PolyphonicProcessorClientFactory factory;
+};
+
+PolyphonicProcessorClientFactory PolyphonicProcessorClientFactory::factory;
+
+JackClientFactory * PolyphonicProcessorClient::getFactory()
+{
+    return &PolyphonicProcessorClientFactory::factory;
+}
@@ -0,0 +1,191 @@
+#ifndef POLYPHONICPROCESSOR_H
+#define POLYPHONICPROCESSOR_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audioprocessor.h"
+#include "midiparameterprocessor.h"
+#include "parameterclient.h"
+#include <QVector>
+#include <QPair>
+
+/**
+  Hosts several voices, each one consisting of its own instances of a chain
+  of processors, within a single processor (and thus within a single Jack
+  client), such that a monophonic patch can be played polyphonically.
+
+  Notes from the "Midi note in" input are assigned to the voices: a note
+  which is already playing retriggers its voice, otherwise an idle voice
+  is used. If all voices are busy, a voice is stolen, preferring voices
+  whose note has been released already, and among those the oldest or the
+  quietest one. Note on, note off and aftertouch only reach the voice
+  playing the note, controllers, pitch bend and channel pressure reach all
+  voices.
+
+  Released voices whose output stays below SILENCE_LEVEL for SILENCE_FRAMES
+  frames become idle, and idle voices are not processed at all. Thus a voice
+  should contain an envelope (or something else which makes it silent after
+  its note has been released), otherwise it is only freed by stealing.
+
+  The parameters of all stages (except the MIDI controller mapping of
+  MidiParameterProcessor stages) are registered as parameters of this
+  processor, prefixed with the stage name, and changes are passed on to
+  all voices.
+  */
+class PolyphonicProcessor : public AudioProcessor, public MidiParameterProcessor
+{
+public:
+    enum VoiceStealing {
+        STEAL_OLDEST,
+        STEAL_QUIETEST
+    };
+
+    /**
+      One processor of a voice's chain.
+
+      The first stage gets the audio inputs of this processor, every other
+      stage gets the first audio output of the previous stage at its first
+      input (and silence at all other inputs). The first audio output of the
+      last stage is the voice's output.
+
+      A stage which multiplies does not replace the chain's signal, but its
+      first audio output is multiplied with it (e.g., an envelope), its
+      inputs are silent. The first stage must not multiply.
+
+      The parameters of a stage are those of its parameter processor, except
+      for the first one if it is a MidiParameterProcessor.
+      */
+    struct Stage {
+        QString name;
+        // the audio processor is deleted with the voice, the MIDI and parameter processors
+        // have to be the same object (or parts of it), the parameter processor may be zero:
+        AudioProcessor *audioProcessor;
+        MidiProcessor *midiProcessor;
+        ParameterProcessor *parameterProcessor;
+        // the MIDI input which gets the voice's MIDI events:
+        int midiInputIndex;
+        bool multiplies;
+    };
+
+    /**
+      Creates the stages of a voice. The constructor calls this once for each voice,
+      plus once to find out the voice's audio inputs.
+      */
+    class VoiceFactory
+    {
+    public:
+        virtual ~VoiceFactory();
+        virtual QVector<Stage> createVoice() = 0;
+    };
+
+    enum {
+        // the peak level below which a released voice is considered silent (-80 dB):
+        SILENCE_LEVEL_INVERSE = 10000,
+        SILENCE_FRAMES = 1024
+    };
+
+    PolyphonicProcessor(VoiceFactory &voiceFactory, int voices, VoiceStealing voiceStealing = STEAL_OLDEST);
+    virtual ~PolyphonicProcessor();
+
+    int getNrOfVoices() const;
+    int getNrOfActiveVoices() const;
+    void setVoiceStealing(VoiceStealing voiceStealing);
+    VoiceStealing getVoiceStealing() const;
+
+    // reimplemented from AudioProcessor:
+    virtual void setSampleRate(double sampleRate);
+    virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+    // reimplemented from MidiProcessor:
+    virtual void processNoteOn(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time);
+    virtual void processNoteOff(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char velocity, jack_nframes_t time);
+    virtual void processAfterTouch(int inputIndex, unsigned char channel, unsigned char noteNumber, unsigned char pressure, jack_nframes_t time);
+    virtual void processController(int inputIndex, unsigned char channel, unsigned char controller, unsigned char value, jack_nframes_t time);
+    virtual void processPitchBend(int inputIndex, unsigned char channel, unsigned int value, jack_nframes_t time);
+    virtual void processChannelPressure(int inputIndex, unsigned char channel, unsigned char pressure, jack_nframes_t time);
+    // reimplemented from MidiParameterProcessor:
+    virtual bool setParameterValue(int index, double value, double min, double max, unsigned int time);
+private:
+    enum VoiceState {
+        IDLE,
+        PLAYING,
+        RELEASED
+    };
+    // the bookkeeping of one voice (all voices are stored contiguously):
+    struct Voice {
+        VoiceState state;
+        unsigned char channel, noteNumber;
+        // when the voice's note started, counted in notes:
+        quint32 age;
+        // the peak level of the last processed frames, and for how many frames the voice has been silent:
+        float level;
+        jack_nframes_t silentFrames;
+    };
+    enum {
+        CHUNK_SIZE = 64
+    };
+    VoiceStealing voiceStealing;
+    int stagesPerVoice;
+    quint32 noteCounter;
+    QVector<Voice> voices;
+    // the stages of all voices, voice by voice:
+    QVector<Stage> stages;
+    // for each parameter of this processor (except the first), the stage and its parameter index:
+    QVector<QPair<int, int> > parameterStages;
+    // scratch buffers for block processing, each one of CHUNK_SIZE frames:
+    QVector<jack_default_audio_sample_t> chunkBuffers;
+    QVector<const jack_default_audio_sample_t*> stageInputs;
+    QVector<jack_default_audio_sample_t*> stageOutputs;
+    // scratch buffers for frame processing:
+    QVector<double> frameInputs, frameOutputs;
+
+    // copying would require copying all voices' processors:
+    PolyphonicProcessor(const PolyphonicProcessor &tocopy);
+    PolyphonicProcessor & operator=(const PolyphonicProcessor &tocopy);
+
+    int findVoice(unsigned char channel, unsigned char noteNumber) const;
+    int allocateVoice(unsigned char channel, unsigned char noteNumber, jack_nframes_t time);
+    void processVoiceChunk(int voice, const jack_default_audio_sample_t * const *inputs, jack_nframes_t start, jack_nframes_t length, jack_default_audio_sample_t *output);
+    void updateVoiceLevel(int voice, float level, jack_nframes_t frames);
+    Stage & getStage(int voice, int stage);
+
+    static QStringList createInputPortNames(VoiceFactory &voiceFactory);
+};
+
+/**
+  A client hosting a PolyphonicProcessor.
+  */
+class PolyphonicProcessorClient : public ParameterClient
+{
+public:
+    /**
+      This object takes ownership of the given processors.
+      */
+    PolyphonicProcessorClient(const QString &clientName, PolyphonicProcessor *processProcessor, PolyphonicProcessor *guiProcessor, size_t ringBufferSize = 1024);
+    virtual ~PolyphonicProcessorClient();
+    virtual JackClientFactory * getFactory();
+protected:
+    // reimplemented from ParameterClient:
+    virtual bool init();
+private:
+    PolyphonicProcessor *processProcessor, *guiProcessor;
+};
+
+#endif // POLYPHONICPROCESSOR_H
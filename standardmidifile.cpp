@@ -0,0 +1,234 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "standardmidifile.h"
+#include <QFile>
+#include <QtAlgorithms>
+
+StandardMidiFile::StandardMidiFile() :
+    length(0)
+{
+}
+
+bool StandardMidiFile::load(const QString &fileName)
+{
+    events.clear();
+    length = 0;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = QString("Could not open MIDI file %1").arg(fileName);
+        return false;
+    }
+    QByteArray data = file.readAll();
+    // read the header chunk:
+    if ((data.size() < 14) || (data.left(4) != "MThd")) {
+        errorString = QString("%1 is not a Standard MIDI File").arg(fileName);
+        return false;
+    }
+    const unsigned char *bytes = (const unsigned char*)data.constData();
+    quint32 headerLength = (bytes[4] << 24) | (bytes[5] << 16) | (bytes[6] << 8) | bytes[7];
+    quint16 format = (bytes[8] << 8) | bytes[9];
+    quint16 division = (bytes[12] << 8) | bytes[13];
+    if ((headerLength < 6) || (format > 1) || ((division & 0x7fff) == 0)) {
+        errorString = QString("%1 has an unsupported format").arg(fileName);
+        return false;
+    }
+    // read all track chunks (other chunk types are skipped):
+    QVector<TickEvent> tickEvents;
+    QVector<TempoChange> tempoChanges;
+    quint64 lastTick = 0;
+    int trackIndex = 0;
+    for (quint64 position = 8 + headerLength; position + 8 <= (quint64)data.size(); ) {
+        quint32 chunkLength = (bytes[position + 4] << 24) | (bytes[position + 5] << 16) | (bytes[position + 6] << 8) | bytes[position + 7];
+        if (position + 8 + chunkLength > (quint64)data.size()) {
+            errorString = QString("%1 is truncated").arg(fileName);
+            return false;
+        }
+        if (data.mid(position, 4) == "MTrk") {
+            if (!readTrack(data.mid(position + 8, chunkLength), trackIndex++, tickEvents, tempoChanges, lastTick)) {
+                errorString = QString("%1 contains an invalid track").arg(fileName);
+                return false;
+            }
+        }
+        position += 8 + chunkLength;
+    }
+    // events of different tracks at the same tick keep the order of their tracks:
+    qSort(tickEvents);
+    qStableSort(tempoChanges);
+    // convert ticks to seconds:
+    if (division & 0x8000) {
+        // SMPTE time code, the upper byte holds the negative frame rate (where -29 means 29.97 frames per second):
+        int framesPerSecond = -(signed char)(division >> 8);
+        double ticksPerSecond = (framesPerSecond == 29 ? 29.97 : framesPerSecond) * (division & 0xff);
+        for (int i = 0; i < tickEvents.size(); i++) {
+            Event event;
+            event.time = tickEvents[i].tick / ticksPerSecond;
+            event.data = tickEvents[i].data;
+            events.append(event);
+        }
+        length = lastTick / ticksPerSecond;
+    } else {
+        // ticks per quarter note, the tempo map gives the duration of a quarter note:
+        double ticksPerQuarterNote = division;
+        double tempoTime = 0;
+        quint64 tempoTick = 0;
+        quint32 microsecondsPerQuarterNote = 500000;
+        int tempoIndex = 0;
+        for (int i = 0; i <= tickEvents.size(); i++) {
+            quint64 tick = (i < tickEvents.size() ? tickEvents[i].tick : lastTick);
+            // apply all tempo changes up to the current tick:
+            for (; (tempoIndex < tempoChanges.size()) && (tempoChanges[tempoIndex].tick <= tick); tempoIndex++) {
+                tempoTime += (tempoChanges[tempoIndex].tick - tempoTick) * microsecondsPerQuarterNote * 1e-6 / ticksPerQuarterNote;
+                tempoTick = tempoChanges[tempoIndex].tick;
+                microsecondsPerQuarterNote = tempoChanges[tempoIndex].microsecondsPerQuarterNote;
+            }
+            double time = tempoTime + (tick - tempoTick) * microsecondsPerQuarterNote * 1e-6 / ticksPerQuarterNote;
+            if (i < tickEvents.size()) {
+                Event event;
+                event.time = time;
+                event.data = tickEvents[i].data;
+                events.append(event);
+            } else {
+                length = time;
+            }
+        }
+    }
+    return true;
+}
+
+const QVector<StandardMidiFile::Event> & StandardMidiFile::getEvents() const
+{
+    return events;
+}
+
+double StandardMidiFile::getLength() const
+{
+    return length;
+}
+
+QString StandardMidiFile::getErrorString() const
+{
+    return errorString;
+}
+
+bool StandardMidiFile::TickEvent::operator<(const TickEvent &other) const
+{
+    if (tick != other.tick) {
+        return tick < other.tick;
+    } else if (track != other.track) {
+        return track < other.track;
+    } else {
+        return index < other.index;
+    }
+}
+
+bool StandardMidiFile::TempoChange::operator<(const TempoChange &other) const
+{
+    return tick < other.tick;
+}
+
+bool StandardMidiFile::readTrack(const QByteArray &track, int trackIndex, QVector<TickEvent> &tickEvents, QVector<TempoChange> &tempoChanges, quint64 &lastTick)
+{
+    const unsigned char *bytes = (const unsigned char*)track.constData();
+    int position = 0;
+    quint64 tick = 0;
+    unsigned char runningStatus = 0;
+    for (int index = 0; position < track.size(); index++) {
+        quint32 deltaTime;
+        if (!readVariableLengthQuantity(track, position, deltaTime) || (position >= track.size())) {
+            return false;
+        }
+        tick += deltaTime;
+        if (tick > lastTick) {
+            lastTick = tick;
+        }
+        unsigned char status = bytes[position];
+        if (status & 0x80) {
+            position++;
+        } else if (runningStatus) {
+            status = runningStatus;
+        } else {
+            return false;
+        }
+        if (status == 0xff) {
+            // meta event:
+            if (position >= track.size()) {
+                return false;
+            }
+            unsigned char type = bytes[position++];
+            quint32 dataLength;
+            if (!readVariableLengthQuantity(track, position, dataLength) || (position + dataLength > (quint32)track.size())) {
+                return false;
+            }
+            if ((type == 0x51) && (dataLength == 3)) {
+                // set tempo:
+                TempoChange tempoChange;
+                tempoChange.tick = tick;
+                tempoChange.microsecondsPerQuarterNote = (bytes[position] << 16) | (bytes[position + 1] << 8) | bytes[position + 2];
+                tempoChanges.append(tempoChange);
+            } else if (type == 0x2f) {
+                // end of track:
+                return true;
+            }
+            position += dataLength;
+            runningStatus = 0;
+        } else if ((status == 0xf0) || (status == 0xf7)) {
+            // system exclusive messages are skipped:
+            quint32 dataLength;
+            if (!readVariableLengthQuantity(track, position, dataLength) || (position + dataLength > (quint32)track.size())) {
+                return false;
+            }
+            position += dataLength;
+            runningStatus = 0;
+        } else if (status < 0xf0) {
+            // channel message, program change and channel pressure have one data byte, all others have two:
+            int dataLength = ((status & 0xe0) == 0xc0 ? 1 : 2);
+            if (position + dataLength > track.size()) {
+                return false;
+            }
+            TickEvent event;
+            event.tick = tick;
+            event.track = trackIndex;
+            event.index = index;
+            event.data.append((char)status);
+            event.data.append(track.mid(position, dataLength));
+            tickEvents.append(event);
+            position += dataLength;
+            runningStatus = status;
+        } else {
+            // other system messages are not allowed in MIDI files:
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StandardMidiFile::readVariableLengthQuantity(const QByteArray &data, int &position, quint32 &value)
+{
+    value = 0;
+    // a variable length quantity has at most four bytes:
+    for (int i = 0; (i < 4) && (position < data.size()); i++) {
+        unsigned char byte = data[position++];
+        value = (value << 7) | (byte & 0x7f);
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+#ifndef STANDARDMIDIFILE_H
+#define STANDARDMIDIFILE_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+/**
+  Reads Standard MIDI Files (format 0 and 1) into a single list of channel
+  messages, sorted by time. Event times are converted from ticks to seconds
+  by the tempo map of the file.
+
+  Meta events and system exclusive messages are not part of the event list.
+  */
+class StandardMidiFile
+{
+public:
+    struct Event {
+        double time;
+        QByteArray data;
+    };
+
+    StandardMidiFile();
+
+    /**
+      @return true iff the file could be read, otherwise the error message
+        is available from getErrorString()
+      */
+    bool load(const QString &fileName);
+    /**
+      @return all channel messages of the file in chronological order
+      */
+    const QVector<Event> & getEvents() const;
+    /**
+      @return the time of the last event (including meta events) in seconds
+      */
+    double getLength() const;
+    QString getErrorString() const;
+private:
+    struct TickEvent {
+        quint64 tick;
+        int track, index;
+        QByteArray data;
+        bool operator<(const TickEvent &other) const;
+    };
+    struct TempoChange {
+        quint64 tick;
+        quint32 microsecondsPerQuarterNote;
+        bool operator<(const TempoChange &other) const;
+    };
+
+    QVector<Event> events;
+    double length;
+    QString errorString;
+
+    bool readTrack(const QByteArray &track, int trackIndex, QVector<TickEvent> &tickEvents, QVector<TempoChange> &tempoChanges, quint64 &lastTick);
+    static bool readVariableLengthQuantity(const QByteArray &data, int &position, quint32 &value);
+};
+
+#endif // STANDARDMIDIFILE_H
@@ -0,0 +1,91 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+  Renders a small session offline and tears it down again, the way
+  elektrocillin --render does: an oscillator in the session and another one
+  in a macro inside the session, both connected to the session's system_out,
+  processed by two threads.
+
+  Exits with 0 if rendering succeeded. If tearing down the session does not
+  return within a few seconds, the test is killed by an alarm signal.
+  */
+
+#include "offlinerenderer.h"
+#include "jackclient.h"
+#include "metajack/recursivejackcontext.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <cstdio>
+#include <unistd.h>
+
+static const unsigned int TIMEOUT_SECONDS = 10;
+
+static JackClient * createOscillator(const QString &clientName, const QString &destPortName)
+{
+    JackClient *client = JackClientSerializer::getInstance()->createClient("Oscillator (sine)", clientName);
+    if (!client || !client->activate() || !client->connectPorts(client->getFullPortName(client->getClientName(), "Audio out"), destPortName)) {
+        return 0;
+    }
+    return client;
+}
+
+static bool render(const QString &outputFileName)
+{
+    OfflineRenderer renderer(44100, 256, 2);
+    JackClient *oscillator = createOscillator("oscillator", "system_out:audio in 1");
+    if (!oscillator) {
+        fprintf(stderr, "Could not create the session's oscillator\n");
+        return false;
+    }
+    // the macro's oscillator reaches the session through the macro's wrapper client:
+    MetaJackContext *macroContext = (MetaJackContext*)RecursiveJackContext::getInstance()->pushNewContext("macro", 1);
+    JackClient *macroOscillator = createOscillator("macro oscillator", "system_out:audio in 1");
+    RecursiveJackContext::getInstance()->popContext();
+    if (!macroOscillator) {
+        fprintf(stderr, "Could not create the macro's oscillator\n");
+        return false;
+    }
+    if (!oscillator->connectPorts(JackClient::getFullPortName(macroContext->getWrapperClientName(), "audio in 1"), "system_out:audio in 2")) {
+        fprintf(stderr, "Could not connect the macro to the session's output\n");
+        return false;
+    }
+    if (!renderer.render(outputFileName, OfflineRenderer::WAVE, 0.5)) {
+        fprintf(stderr, "%s\n", renderer.getErrorString().toLocal8Bit().constData());
+        return false;
+    }
+    if ((renderer.getOutputChannelCount() != 2) || (renderer.getRenderedFrameCount() < 22050)) {
+        fprintf(stderr, "Rendered %d channels and %llu frames, expected 2 channels and 22050 frames\n", renderer.getOutputChannelCount(), (unsigned long long)renderer.getRenderedFrameCount());
+        return false;
+    }
+    // the renderer deletes the session's clients, the macro and the session context when going out of scope:
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    // fail instead of hanging forever:
+    alarm(TIMEOUT_SECONDS);
+    QString outputFileName = QDir::temp().filePath("elektrocillin-rendertest.wav");
+    bool success = render(outputFileName);
+    QFile::remove(outputFileName);
+    fprintf(stderr, "%s\n", success ? "Rendering and tearing down the session succeeded" : "Rendering failed");
+    return (success ? 0 : 1);
+}
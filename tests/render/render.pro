@@ -0,0 +1,36 @@
+#-------------------------------------------------
+#
+# Smoke test of offline rendering
+#
+#-------------------------------------------------
+
+# reuse the application's sources, headers, forms and resources
+# (everything but the main window) from the main project file:
+include(../../elektrocillin.pro)
+
+APP_SOURCES = $$SOURCES
+APP_HEADERS = $$HEADERS
+SOURCES =
+HEADERS =
+FORMS =
+RESOURCES =
+EXCLUDED_FILES = main.cpp mainwindow.cpp mainwindow.h
+
+for(file, APP_SOURCES) {
+    !contains(EXCLUDED_FILES, $$file):SOURCES += ../../$$file
+}
+for(file, APP_HEADERS) {
+    !contains(EXCLUDED_FILES, $$file):HEADERS += ../../$$file
+}
+
+TARGET = rendertest
+CONFIG  += console
+CONFIG  -= app_bundle
+
+INCLUDEPATH += ../.. ../../metajack
+
+SOURCES += main.cpp
+
+FORMS += ../../zplanewidget.ui
+
+RESOURCES += ../../elektrocillin.qrc
@@ -0,0 +1,141 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wavetable.h"
+#include <cmath>
+#include <algorithm>
+#include <QtGlobal>
+
+Wavetable::ChangeEvent::ChangeEvent(const Wavetable &wavetable_) :
+    wavetable(new Wavetable(wavetable_))
+{
+}
+
+Wavetable::ChangeEvent::~ChangeEvent()
+{
+    delete wavetable;
+}
+
+void Wavetable::ChangeEvent::swap(Wavetable *&wavetable_) const
+{
+    std::swap(wavetable, wavetable_);
+}
+
+Wavetable::Wavetable(int sizeExponent) :
+    size(1 << sizeExponent),
+    levels(sizeExponent - 1),
+    levelSizes(levels),
+    levelOffsets(levels),
+    twiddles(size / 2),
+    spectrum(size),
+    buffer(size)
+{
+    int offset = 0;
+    for (int level = 0; level < levels; level++) {
+        levelSizes[level] = qBound((int)MINIMUM_LEVEL_SIZE, size >> level, size);
+        levelOffsets[level] = offset;
+        offset += levelSizes[level] + 1;
+    }
+    tables.fill(0.0f, offset);
+    for (int i = 0; i < size / 2; i++) {
+        twiddles[i] = std::polar(1.0, -2.0 * M_PI * i / size);
+    }
+}
+
+void Wavetable::create(AbstractInterpolator *curve)
+{
+    // sample one cycle of the curve and compute its spectrum:
+    for (int i = 0; i < size; i++) {
+        spectrum[i] = curve->evaluate((double)i / size);
+    }
+    transform(spectrum.data(), size, false);
+    for (int level = 0; level < levels; level++) {
+        // keep only the harmonics up to this level's limit, with as many samples as needed:
+        int harmonics = (size / 4) >> level;
+        int levelSize = levelSizes[level];
+        for (int i = 0; i < levelSize; i++) {
+            buffer[i] = 0.0;
+        }
+        buffer[0] = spectrum[0];
+        for (int i = 1; i <= harmonics; i++) {
+            buffer[i] = spectrum[i];
+            buffer[levelSize - i] = spectrum[size - i];
+        }
+        transform(buffer.data(), levelSize, true);
+        float *table = tables.data() + levelOffsets[level];
+        for (int i = 0; i < levelSize; i++) {
+            table[i] = buffer[i].real() / size;
+        }
+        table[levelSize] = table[0];
+    }
+}
+
+int Wavetable::getSize() const
+{
+    return size;
+}
+
+int Wavetable::getNrOfLevels() const
+{
+    return levels;
+}
+
+int Wavetable::getLevel(double normalizedFrequency) const
+{
+    // the highest harmonic of level 0 reaches the Nyquist frequency at this ratio:
+    double ratio = normalizedFrequency * (size / 2);
+    if (ratio <= 1.0) {
+        return 0;
+    }
+    // every octave above that needs one level more:
+    int octaves;
+    frexp(ratio, &octaves);
+    return (octaves < levels ? octaves : levels - 1);
+}
+
+void Wavetable::transform(std::complex<double> *values, int n, bool inverse) const
+{
+    // bit reversal permutation:
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(values[i], values[j]);
+        }
+    }
+    // radix-2 butterflies, with the products written out as std::complex checks for infinities otherwise:
+    const std::complex<double> *twiddle = twiddles.constData();
+    double sign = (inverse ? -1.0 : 1.0);
+    for (int length = 2; length <= n; length <<= 1) {
+        int half = length / 2, stride = size / length;
+        for (int i = 0; i < n; i += length) {
+            for (int j = 0; j < half; j++) {
+                double twiddleReal = twiddle[j * stride].real(), twiddleImaginary = sign * twiddle[j * stride].imag();
+                std::complex<double> &even = values[i + j], &odd = values[i + j + half];
+                double productReal = odd.real() * twiddleReal - odd.imag() * twiddleImaginary;
+                double productImaginary = odd.real() * twiddleImaginary + odd.imag() * twiddleReal;
+                odd = std::complex<double>(even.real() - productReal, even.imag() - productImaginary);
+                even = std::complex<double>(even.real() + productReal, even.imag() + productImaginary);
+            }
+        }
+    }
+}
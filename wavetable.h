@@ -0,0 +1,117 @@
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QVector>
+#include <complex>
+#include "interpolator.h"
+
+/**
+  A set of band-limited single-cycle tables of a periodic waveform, with
+  one table ("mip level") per octave.
+
+  The waveform is sampled from an interpolator curve over the phase
+  interval [0, 1). Level 0 keeps the first getSize() / 4 harmonics of the
+  waveform, each further level keeps half as many as the previous one,
+  down to a pure sine wave. Playing the level returned by getLevel() for a
+  given normalized frequency thus never produces harmonics above the
+  Nyquist frequency, while still oversampling the waveform by at least two.
+
+  Each level's table has four samples per harmonic (but at least
+  MINIMUM_LEVEL_SIZE samples), so the higher levels are small and cheap to
+  compute. Creating the tables does not allocate memory, but it takes about
+  three Fourier transforms of getSize() samples, which is too long to do in
+  the process thread whenever the curve is edited. Tables created in the
+  GUI thread are handed over with a ChangeEvent instead.
+  */
+class Wavetable
+{
+public:
+    /**
+      Carries a wavetable from the GUI thread to the process thread. The
+      receiver swaps it with its own one, so that the previous wavetable is
+      deleted along with the event in the GUI thread.
+      */
+    class ChangeEvent : public RingBufferEvent
+    {
+    public:
+        ChangeEvent(const Wavetable &wavetable);
+        virtual ~ChangeEvent();
+        void swap(Wavetable *&wavetable) const;
+    private:
+        mutable Wavetable *wavetable;
+    };
+
+    /**
+      @param sizeExponent the base 2 logarithm of the number of samples per table
+      */
+    Wavetable(int sizeExponent = 12);
+
+    /**
+      Samples the given curve at getSize() equidistant points in [0, 1)
+      and computes the band-limited tables of all levels from it.
+      */
+    void create(AbstractInterpolator *curve);
+
+    int getSize() const;
+    int getNrOfLevels() const;
+    /**
+      @return the lowest level whose harmonics all stay below the Nyquist
+        frequency when played at the given normalized frequency (cycles per sample)
+      */
+    int getLevel(double normalizedFrequency) const;
+
+    /**
+      @return the value of the given level's table at the given phase
+        in [0, 1), interpolated linearly between the table's samples
+      */
+    double valueAtPhase(int level, double phase) const
+    {
+        int levelSize = levelSizes[level];
+        double position = phase * levelSize;
+        int index = (int)position;
+        if (index >= levelSize) {
+            // rounding might give exactly the end of the table:
+            index = levelSize - 1;
+        }
+        const float *table = tables.constData() + levelOffsets[level];
+        return table[index] + (position - index) * (table[index + 1] - table[index]);
+    }
+private:
+    enum {
+        MINIMUM_LEVEL_SIZE = 256
+    };
+    int size, levels;
+    QVector<int> levelSizes, levelOffsets;
+    // the tables of all levels, each with a copy of its first sample appended:
+    QVector<float> tables;
+    // e^(-2 pi i k / size) for k in [0, size / 2):
+    QVector<std::complex<double> > twiddles;
+    QVector<std::complex<double> > spectrum, buffer;
+
+    /**
+      Transforms the given number of values (a power of two up to the
+      table size) in place. The inverse transform is not normalized.
+      */
+    void transform(std::complex<double> *values, int n, bool inverse) const;
+};
+
+#endif // WAVETABLE_H
@@ -0,0 +1,72 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wavetableoscillator.h"
+
+WavetableOscillator::WavetableOscillator(const QStringList &additionalInputPortNames) :
+    Oscillator(additionalInputPortNames),
+    wavetable(new Wavetable()),
+    levelFrequency(-1),
+    level(0)
+{
+    // start with a sawtooth wave:
+    QVector<double> xx, yy;
+    xx.append(0);
+    yy.append(-1);
+    xx.append(1);
+    yy.append(1);
+    setInterpolator(LinearInterpolator(xx, yy));
+}
+
+WavetableOscillator::~WavetableOscillator()
+{
+    delete wavetable;
+}
+
+LinearInterpolator * WavetableOscillator::getInterpolator()
+{
+    return &interpolator;
+}
+
+void WavetableOscillator::setInterpolator(const LinearInterpolator &interpolator)
+{
+    this->interpolator = interpolator;
+    wavetable->create(&this->interpolator);
+}
+
+bool WavetableOscillator::processEvent(const RingBufferEvent *event, jack_nframes_t)
+{
+    if (const Wavetable::ChangeEvent *event_ = dynamic_cast<const Wavetable::ChangeEvent*>(event)) {
+        // swap in the tables created in the GUI thread, the previous ones are deleted with the event:
+        event_->swap(wavetable);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+double WavetableOscillator::valueAtPhase(double phase)
+{
+    // choose the table level only when the frequency changes:
+    if (getNormalizedFrequency() != levelFrequency) {
+        levelFrequency = getNormalizedFrequency();
+        level = wavetable->getLevel(levelFrequency);
+    }
+    return wavetable->valueAtPhase(level, phase);
+}
@@ -0,0 +1,66 @@
+#ifndef WAVETABLEOSCILLATOR_H
+#define WAVETABLEOSCILLATOR_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "oscillator.h"
+#include "linearinterpolator.h"
+#include "wavetable.h"
+
+/**
+  An oscillator playing a waveform drawn as a piecewise linear curve, from
+  band-limited tables (see Wavetable) instead of evaluating the curve for
+  every sample.
+
+  Creating the tables takes too long for the process thread, so while
+  processing, the curve is changed by swapping in tables created from it
+  in the GUI thread (see Wavetable::ChangeEvent). The interpolator of the
+  oscillator in the process thread is not changed by that.
+  */
+class WavetableOscillator : public Oscillator, public EventProcessor
+{
+public:
+    WavetableOscillator(const QStringList &additionalInputPortNames = QStringList());
+    virtual ~WavetableOscillator();
+
+    LinearInterpolator * getInterpolator();
+    /**
+      Sets the curve and creates the tables from it. Do not call this
+      while the oscillator is being processed.
+      */
+    void setInterpolator(const LinearInterpolator &interpolator);
+
+    // reimplemented from EventProcessor:
+    virtual bool processEvent(const RingBufferEvent *event, jack_nframes_t time);
+protected:
+    double valueAtPhase(double phase);
+private:
+    LinearInterpolator interpolator;
+    Wavetable *wavetable;
+    // the table level for the normalized frequency it has been chosen for:
+    double levelFrequency;
+    int level;
+
+    // copying would share the wavetable:
+    WavetableOscillator(const WavetableOscillator &tocopy);
+    WavetableOscillator & operator=(const WavetableOscillator &tocopy);
+};
+
+#endif // WAVETABLEOSCILLATOR_H
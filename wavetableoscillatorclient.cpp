@@ -0,0 +1,132 @@
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wavetableoscillatorclient.h"
+
+WavetableOscillatorClient::WavetableOscillatorClient(const QString &clientName, WavetableOscillator *processOscillator_, WavetableOscillator *guiOscillator_, size_t ringBufferSize) :
+    OscillatorClient(clientName, processOscillator_, guiOscillator_, processOscillator_, ringBufferSize),
+    processOscillator(processOscillator_),
+    guiOscillator(guiOscillator_)
+{
+}
+
+WavetableOscillatorClient::~WavetableOscillatorClient()
+{
+    close();
+}
+
+void WavetableOscillatorClient::saveState(QDataStream &stream)
+{
+    OscillatorClient::saveState(stream);
+    guiOscillator->getInterpolator()->save(stream);
+}
+
+void WavetableOscillatorClient::loadState(QDataStream &stream)
+{
+    OscillatorClient::loadState(stream);
+    guiOscillator->getInterpolator()->load(stream);
+    processOscillator->setInterpolator(*guiOscillator->getInterpolator());
+}
+
+QGraphicsItem * WavetableOscillatorClient::createGraphicsItem()
+{
+    int padding = 4;
+    QGraphicsRectItem *item = new QGraphicsRectItem();
+    QGraphicsItem *oscillatorItem = OscillatorClient::createGraphicsItem();
+    QRectF rect = QRect(0, 0, 420, 420);
+    rect = rect.translated(oscillatorItem->boundingRect().width() + 2 * padding, padding);
+    oscillatorItem->setPos(padding, padding);
+    oscillatorItem->setParentItem(item);
+    new GraphicsInterpolatorEditItem(this, rect, QRectF(0, 1, 1, -2), item);
+    item->setRect((rect | oscillatorItem->boundingRect().translated(oscillatorItem->pos())).adjusted(-padding, -padding, padding, padding));
+    item->setPen(QPen(QBrush(Qt::black), 1));
+    item->setBrush(QBrush(Qt::white));
+    return item;
+}
+
+double WavetableOscillatorClient::evaluate(double x, int *index)
+{
+    return guiOscillator->getInterpolator()->evaluate(x, index);
+}
+
+int WavetableOscillatorClient::getNrOfControlPoints()
+{
+    return guiOscillator->getInterpolator()->getNrOfControlPoints();
+}
+
+QPointF WavetableOscillatorClient::getControlPoint(int index)
+{
+    return guiOscillator->getInterpolator()->getControlPoint(index);
+}
+
+void WavetableOscillatorClient::changeControlPoint(int index, double x, double y)
+{
+    guiOscillator->getInterpolator()->changeControlPoint(index, x, y);
+    postWavetable();
+}
+
+void WavetableOscillatorClient::addControlPoint(double x, double y)
+{
+    guiOscillator->getInterpolator()->addControlPoint(x, y);
+    postWavetable();
+}
+
+void WavetableOscillatorClient::deleteControlPoint(int index)
+{
+    guiOscillator->getInterpolator()->deleteControlPoint(index);
+    postWavetable();
+}
+
+QString WavetableOscillatorClient::getControlPointName(int index) const
+{
+    return guiOscillator->getInterpolator()->getControlPointName(index);
+}
+
+void WavetableOscillatorClient::postWavetable()
+{
+    // the process thread only swaps in the tables, so that it does not have to create them:
+    Wavetable wavetable;
+    wavetable.create(guiOscillator->getInterpolator());
+    postEvent(new Wavetable::ChangeEvent(wavetable));
+}
+
+class WavetableOscillatorClientFactory : public JackClientFactory
+{
+public:
+    WavetableOscillatorClientFactory()
+    {
+        JackClientSerializer::getInstance()->registerFactory(this);
+    }
+    QString getName()
+    {
+        return "Oscillator (wavetable)";
+    }
+    JackClient * createClient(const QString &clientName)
+    {
+        return new WavetableOscillatorClient(clientName, new WavetableOscillator(), new WavetableOscillator());
+    }
+    static WavetableOscillatorClientFactory factory;
+};
+
+WavetableOscillatorClientFactory WavetableOscillatorClientFactory::factory;
+
+JackClientFactory * WavetableOscillatorClient::getFactory()
+{
+    return &WavetableOscillatorClientFactory::factory;
+}
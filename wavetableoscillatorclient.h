@@ -0,0 +1,58 @@
+#ifndef WAVETABLEOSCILLATORCLIENT_H
+#define WAVETABLEOSCILLATORCLIENT_H
+
+/*
+    Copyright 2011 Arne Jacobs <jarne@jarne.de>
+
+    This file is part of elektrocillin.
+
+    Elektrocillin is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Elektrocillin is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Elektrocillin.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "oscillatorclient.h"
+#include "wavetableoscillator.h"
+#include "graphicsinterpolatoredititem.h"
+#include <QPen>
+
+class WavetableOscillatorClient : public OscillatorClient, public AbstractInterpolator
+{
+public:
+    WavetableOscillatorClient(const QString &clientName, WavetableOscillator *processOscillator, WavetableOscillator *guiOscillator, size_t ringBufferSize = 1024);
+    virtual ~WavetableOscillatorClient();
+
+    virtual JackClientFactory * getFactory();
+    virtual void saveState(QDataStream &stream);
+    /**
+      To call this method is only safe when the client is not running,
+      as it accesses the internal oscillator object used by the Jack
+      process thread in a non-threadsafe way.
+      */
+    virtual void loadState(QDataStream &stream);
+    QGraphicsItem * createGraphicsItem();
+
+    // Implemented from AbstractInterpolator:
+    virtual double evaluate(double x, int *index = 0);
+    virtual int getNrOfControlPoints();
+    virtual QPointF getControlPoint(int index);
+    virtual void changeControlPoint(int index, double x, double y);
+    virtual void addControlPoint(double x, double y);
+    virtual void deleteControlPoint(int index);
+    virtual QString getControlPointName(int index) const;
+private:
+    WavetableOscillator *processOscillator, *guiOscillator;
+
+    void postWavetable();
+};
+
+#endif // WAVETABLEOSCILLATORCLIENT_H
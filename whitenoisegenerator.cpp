@@ -31,6 +31,15 @@ void WhiteNoiseGenerator::processAudio(const double *, double *outputs, jack_nfr
     outputs[0] = (double)randomNumber / (double)RAND_MAX * 2.0 - 1.0;
 }
 
+void WhiteNoiseGenerator::processAudio(const jack_default_audio_sample_t * const *, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
+{
+    jack_default_audio_sample_t *output = outputs[0];
+    double factor = 2.0 / (double)RAND_MAX;
+    for (jack_nframes_t i = start; i < end; i++) {
+        output[i] = (double)rand() * factor - 1.0;
+    }
+}
+
 WhiteNoiseGeneratorClient::WhiteNoiseGeneratorClient(const QString &clientName) :
     AudioProcessorClient(clientName, new WhiteNoiseGenerator())
 {
@@ -28,6 +28,7 @@ public:
     WhiteNoiseGenerator();
 
     void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
 };
 
 class WhiteNoiseGeneratorClient : public AudioProcessorClient
@@ -20,43 +20,56 @@
 
 #include "zitareverbclient.h"
 
-QStringList ZitaReverbClient::audioInputPortNames = QStringList("in.L") + QStringList("in.R");
-QStringList ZitaReverbClient::audioOutputPortNames = QStringList("out.L") + QStringList("out.R");
-QStringList ZitaReverbClient::outputPortNamesAmbis = QStringList("out.W") + QStringList("out.X") + QStringList("out.X") + QStringList("out.Z");
+QStringList ZitaReverbProcessor::audioInputPortNames = QStringList("in.L") + QStringList("in.R");
+QStringList ZitaReverbProcessor::audioOutputPortNames = QStringList("out.L") + QStringList("out.R");
+QStringList ZitaReverbProcessor::outputPortNamesAmbis = QStringList("out.W") + QStringList("out.X") + QStringList("out.X") + QStringList("out.Z");
+
+ZitaReverbProcessor::ZitaReverbProcessor(bool ambis) :
+    AudioProcessor(audioInputPortNames, (ambis ? outputPortNamesAmbis : audioOutputPortNames)),
+    _fragm(1024),
+    _nsamp(0),
+    _ambis(ambis),
+    _delay(0.04f),
+    _rtlow(3.0f),
+    _rtmid(2.0f)
+{
+}
 
-ZitaReverbClient::ZitaReverbClient(const QString &clientName, bool ambis) :
-    AudioProcessorClient(clientName, audioInputPortNames, (ambis ? outputPortNamesAmbis : audioOutputPortNames)),
-    _ambis(ambis)
+void ZitaReverbProcessor::setSampleRate(double sampleRate)
 {
+    AudioProcessor::setSampleRate(sampleRate);
+    _nsamp = 0;
+    _reverb.init (sampleRate, _ambis);
+    _reverb.set_delay (_delay);
+    _reverb.set_rtlow (_rtlow);
+    _reverb.set_rtmid (_rtmid);
 }
 
-bool ZitaReverbClient::init()
+void ZitaReverbProcessor::processAudio(const double *inputs, double *outputs, jack_nframes_t)
 {
-    if (AudioProcessorClient::init()) {
-        // initialize the reverb:
-        _fragm = 1024;
-        _nsamp = 0;
-        _reverb.init (getSampleRate(), _ambis);
-        return true;
-    } else {
-        return false;
+    jack_default_audio_sample_t input[2] = { (jack_default_audio_sample_t)inputs[0], (jack_default_audio_sample_t)inputs[1] };
+    jack_default_audio_sample_t output[4];
+    const jack_default_audio_sample_t *inputBuffers[2] = { input, input + 1 };
+    jack_default_audio_sample_t *outputBuffers[4] = { output, output + 1, output + 2, output + 3 };
+    // process a single frame like a block:
+    processAudio(inputBuffers, outputBuffers, 0, 1);
+    for (int i = 0; i < getNrOfAudioOutputs(); i++) {
+        outputs[i] = output[i];
     }
 }
 
-bool ZitaReverbClient::process(jack_nframes_t frames)
+void ZitaReverbProcessor::processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end)
 {
-    getAudioPortBuffers(frames);
-
     int   i, k, n_inp, n_out;
     float *inp [2];
     float *out [4];
 
     n_inp = 2;
     n_out = _ambis ? 4 : 2;
-    for (i = 0; i < n_inp; i++) inp [i] = (float *) getInputBuffer(i);
-    for (i = 0; i < n_out; i++) out [i] = (float *) getOutputBuffer(i);
+    for (i = 0; i < n_inp; i++) inp [i] = (float *) inputs [i] + start;
+    for (i = 0; i < n_out; i++) out [i] = outputs [i] + start;
 
-    while (frames)
+    for (jack_nframes_t frames = end - start; frames; )
     {
         if (!_nsamp)
         {
@@ -70,8 +83,23 @@ bool ZitaReverbClient::process(jack_nframes_t frames)
         frames -= k;
         _nsamp -= k;
     }
+}
 
-    return true;
+jack_nframes_t ZitaReverbProcessor::getSilenceTail() const
+{
+    // the input delay plus the time the longer of the low and mid frequency reverbs takes to decay by 120 dB (twice its RT60):
+    return (jack_nframes_t)((_delay + 2 * qMax(_rtlow, _rtmid)) * getSampleRate());
+}
+
+ZitaReverbClient::ZitaReverbClient(const QString &clientName, bool ambis) :
+    AudioProcessorClient(clientName, new ZitaReverbProcessor(ambis))
+{
+}
+
+ZitaReverbClient::~ZitaReverbClient()
+{
+    close();
+    delete getAudioProcessor();
 }
 
 class ZitaReverbClientFactory : public JackClientFactory
@@ -24,24 +24,40 @@
 #include "audioprocessorclient.h"
 #include "reverb.h"
 
-class ZitaReverbClient : public AudioProcessorClient
+/**
+  Makes the Zita reverb available through the AudioProcessor interface.
+  The reverb processes fragments of a fixed size, which are split across
+  the blocks as needed.
+  */
+class ZitaReverbProcessor : public AudioProcessor
 {
 public:
-    ZitaReverbClient(const QString &clientName, bool ambis = false);
+    ZitaReverbProcessor(bool ambis = false);
 
-    // reimplemented from JackClient:
-    JackClientFactory * getFactory();
-protected:
-    // reimplemented from JackClient:
-    virtual bool init();
-    virtual bool process(jack_nframes_t nframes);
+    // reimplemented from AudioProcessor:
+    virtual void setSampleRate(double sampleRate);
+    virtual void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual void processAudio(const jack_default_audio_sample_t * const *inputs, jack_default_audio_sample_t * const *outputs, jack_nframes_t start, jack_nframes_t end);
+    virtual jack_nframes_t getSilenceTail() const;
 private:
     unsigned int _fragm;
     unsigned int _nsamp;
     bool _ambis;
+    // the input delay and the low and mid frequency RT60 in seconds, which are handed to the reverb:
+    float _delay, _rtlow, _rtmid;
     Reverb _reverb;
 
     static QStringList audioInputPortNames, audioOutputPortNames, outputPortNamesAmbis;
 };
 
+class ZitaReverbClient : public AudioProcessorClient
+{
+public:
+    ZitaReverbClient(const QString &clientName, bool ambis = false);
+    virtual ~ZitaReverbClient();
+
+    // reimplemented from JackClient:
+    JackClientFactory * getFactory();
+};
+
 #endif // ZITAREVERBCLIENT_H
@@ -48,6 +48,12 @@ void ZPlaneFilter::processAudio(const double *inputs, double *outputs, jack_nfra
     ty = (ty + y.size() - 1) % y.size();
 }
 
+jack_nframes_t ZPlaneFilter::getSilenceTail() const
+{
+    // with its poles inside the unit circle, the output decays with silent input:
+    return 0;
+}
+
 double ZPlaneFilter::getSquaredAmplitudeResponse(double hertz)
 {
     // compute the squared amplitude response (power) from the frequency response:
@@ -32,6 +32,7 @@ public:
 
     // reimplemented from AudioProcessor:
     void processAudio(const double *inputs, double *outputs, jack_nframes_t time);
+    virtual jack_nframes_t getSilenceTail() const;
     // reimplenented from FrequencyResponse:
     double getSquaredAmplitudeResponse(double hertz);
 